@@ -1,16 +1,15 @@
 #include <algorithm>
+#include <climits>
+#include <numeric>
+
+#include <QLocale>
 
 #include "Account.h"
 #include "Operation.h"
 
 Account::Account(const QString& name) :
     _name(name) {
-  connect(this, &Account::selectionChanged,
-          this, [this]() {
-            emit dataChanged(createIndex(0, 0),
-                             createIndex(rowCount() - 1, 0),
-                             { SelectedRole });
-          });
+  connect(this, &Account::openingBalanceChanged, this, &Account::recalculateBalances);
 }
 
 Operation* Account::currentOperation() const {
@@ -43,11 +42,24 @@ QVariant Account::data(const QModelIndex& index, int role) const {
     case LabelRole:
       return op->label();
     case BalanceRole:
-      return (row >= 0 && row < _balances.size()) ? _balances[row] : 0.0;
+      return (row >= 0 && row < _balances.size()) ? _balances[row].toDouble() : 0.0;
     case SelectedRole:
       return isSelectedAt(row);
     case OperationRole:
       return QVariant::fromValue(op);
+    case DateTextRole:
+      return displayTexts(op).date;
+    case CategoryDisplayRole:
+      return displayTexts(op).categories;
+    case AmountTextRole:
+      return displayTexts(op).amount;
+    case BalanceTextRole:
+      if (row >= _balanceTexts.size())
+        return QString();
+      if (_balanceTexts[row].isNull()) {
+        _balanceTexts[row] = _balances[row].toDisplayString();
+      }
+      return _balanceTexts[row];
   }
   return QVariant();
 }
@@ -77,11 +89,20 @@ QHash<int, QByteArray> Account::roleNames() const {
     { BalanceRole, "balance" },
     { SelectedRole, "selected" },
     { OperationRole, "operation" },
+    { DateTextRole, "dateText" },
+    { CategoryDisplayRole, "categoryDisplay" },
+    { AmountTextRole, "amountText" },
+    { BalanceTextRole, "balanceText" },
   };
 }
 
 void Account::refresh() {
+  if (isBatching()) {
+    _resetPending = true;
+    return;
+  }
   beginResetModel();
+  _displayTexts.clear();
   recalculateBalances();
   endResetModel();
 }
@@ -103,8 +124,7 @@ void Account::setImportSourcePrefixes(const QStringList& sources) {
 }
 
 int Account::currentOperationIndex() const {
-  if (!_currentOperation) return -1;
-  return _operations.indexOf(_currentOperation);
+  return operationIndex(_currentOperation);
 }
 
 void Account::set_currentOperationIndex(int index) {
@@ -113,7 +133,7 @@ void Account::set_currentOperationIndex(int index) {
 
 int Account::operationIndex(Operation* operation) const {
   if (!operation) return -1;
-  return _operations.indexOf(operation);
+  return _rows.value(operation, -1);
 }
 
 QList<Operation*> Account::operations() const {
@@ -127,23 +147,37 @@ Operation* Account::addOperation(Operation* operation, bool sort) {
   operation->setParent(this);
   int insertIndex = _operations.size();
   if (sort) {
-    insertIndex = 0;
     // Insert in sorted order (most recent first)
     // For same-date operations, insert at the END of the same-date group to preserve order
-    while (insertIndex < _operations.size() && _operations[insertIndex]->date() > operation->date()) {
-      insertIndex++;
-    }
-    // Skip past any operations with the same date (insert after them)
-    while (insertIndex < _operations.size() && _operations[insertIndex]->date() == operation->date()) {
-      insertIndex++;
-    }
+    const QDate date = operation->date();
+    auto it = std::partition_point(_operations.cbegin(), _operations.cend(), [&date](const Operation* op) {
+      return op->date() >= date;
+    });
+    insertIndex = it - _operations.cbegin();
   }
   beginInsertRows(QModelIndex(), insertIndex, insertIndex);
   _operations.insert(insertIndex, operation);
+  _selected.insert(insertIndex, false);
+  reindexRows(insertIndex);
+  indexAllocations(operation);
   endInsertRows();
   recalculateBalances();
   connect(operation, &Operation::amountChanged, this, &Account::recalculateBalances);
-  emit countChanged();
+  connect(operation, &Operation::allocationsChanged, this, [this, operation] {
+    unindexAllocations(operation);
+    indexAllocations(operation);
+    invalidateDisplay(operation, { CategoryDisplayRole });
+  });
+  connect(operation, &Operation::dateChanged, this, [this, operation] {
+    invalidateDisplay(operation, { DateRole, DateTextRole });
+  });
+  connect(operation, &Operation::labelChanged, this, [this, operation] {
+    invalidateDisplay(operation, { LabelRole });
+  });
+  connect(operation, &Operation::amountChanged, this, [this, operation] {
+    invalidateDisplay(operation, { AmountRole, AmountTextRole });
+  });
+  notifyCountChanged();
   return operation;
 }
 
@@ -151,11 +185,25 @@ bool Account::removeOperation(Operation* operation) {
   if (operation == nullptr) {
     return false;
   }
-  int index = _operations.indexOf(operation);
-  bool wasSelected = _selectedOperations.remove(operation);
-  beginRemoveRows(QModelIndex(), index, index);
-  _operations.removeOne(operation);
+  int index = operationIndex(operation);
+  if (index < 0) {
+    return false;
+  }
   // Clear from selection if present
+  bool wasSelected = _selected[index];
+  if (wasSelected) {
+    _selectionCount--;
+    _selectedTotal -= operation->amountMoney();
+  }
+  beginRemoveRows(QModelIndex(), index, index);
+  _operations.removeAt(index);
+  _selected.removeAt(index);
+  _rows.remove(operation);
+  reindexRows(index);
+  unindexAllocations(operation);
+  _displayTexts.remove(operation);
+  // The operation may live on in an undo command; addOperation reconnects it
+  disconnect(operation, nullptr, this, nullptr);
   // Clear currentOperation if it was the removed one
   if (_currentOperation == operation) {
     _currentOperation = nullptr;
@@ -163,48 +211,132 @@ bool Account::removeOperation(Operation* operation) {
   }
   endRemoveRows();
   recalculateBalances();
-  emit countChanged();
+  notifyCountChanged();
   if (wasSelected) {
     emit selectionChanged();
   }
   return true;
 }
 
+void Account::removeOperations(const QSet<Operation*>& operations) {
+  if (operations.isEmpty())
+    return;
+
+  bool hadSelection = false;
+  beginResetModel();
+  QList<Operation*> keptOperations;
+  QList<bool> keptSelected;
+  keptOperations.reserve(_operations.size());
+  keptSelected.reserve(_operations.size());
+  for (int row = 0; row < _operations.size(); ++row) {
+    Operation* operation = _operations[row];
+    if (!operations.contains(operation)) {
+      keptOperations.append(operation);
+      keptSelected.append(_selected[row]);
+      continue;
+    }
+    if (_selected[row]) {
+      hadSelection = true;
+      _selectionCount--;
+      _selectedTotal -= operation->amountMoney();
+    }
+    _rows.remove(operation);
+    unindexAllocations(operation);
+    _displayTexts.remove(operation);
+    disconnect(operation, nullptr, this, nullptr);
+  }
+  _operations = keptOperations;
+  _selected = keptSelected;
+  reindexRows(0);
+  const bool currentRemoved = _currentOperation && operations.contains(_currentOperation);
+  if (currentRemoved) {
+    _currentOperation = nullptr;
+  }
+  recalculateBalances();
+  endResetModel();
+
+  if (currentRemoved) {
+    emit currentOperationChanged();
+  }
+  notifyCountChanged();
+  if (hadSelection) {
+    emit selectionChanged();
+  }
+}
+
 void Account::clearOperations() {
-  bool hadSelection = !_selectedOperations.isEmpty();
+  bool hadSelection = _selectionCount > 0;
   beginResetModel();
-  _selectedOperations.clear();
+  _selected.clear();
+  _selectionCount = 0;
+  _selectedTotal = {};
   qDeleteAll(_operations);
   _operations.clear();
+  _rows.clear();
+  for (auto it = _operationsByCategory.cbegin(); it != _operationsByCategory.cend(); ++it) {
+    disconnect(it.key(), &Category::nameChanged, this, nullptr);
+  }
+  _operationsByCategory.clear();
+  _categoriesByOperation.clear();
+  _displayTexts.clear();
+  _balances.clear();
+  _balanceTexts.clear();
   if (_currentOperation) {
     _currentOperation = nullptr;
     emit currentOperationChanged();
   }
   endResetModel();
-  emit countChanged();
+  notifyCountChanged();
   if (hadSelection) {
     emit selectionChanged();
   }
 }
 
 void Account::sortOperations() {
-  std::stable_sort(_operations.begin(), _operations.end(), [](Operation* a, Operation* b) {
-    return a->date() > b->date();  // Most recent first, preserve relative order for same date
+  // Sort row indices so that selection flags can be permuted along with operations
+  QList<int> order(_operations.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return _operations[a]->date() > _operations[b]->date();  // Most recent first, preserve relative order for same date
   });
+
+  emit layoutAboutToBeChanged();
+  QList<Operation*> operations;
+  QList<bool> selected;
+  operations.reserve(order.size());
+  selected.reserve(order.size());
+  for (int row : order) {
+    operations.append(_operations[row]);
+    selected.append(_selected[row]);
+  }
+  _operations = operations;
+  _selected = selected;
+  reindexRows(0);
+
+  // Persistent indexes (such as a view's current index) follow their operation
+  QList<int> newRows(order.size());
+  for (int row = 0; row < order.size(); ++row) {
+    newRows[order[row]] = row;
+  }
+  const QModelIndexList from = persistentIndexList();
+  QModelIndexList to;
+  to.reserve(from.size());
+  for (const QModelIndex& persistent : from) {
+    to.append(index(newRows.value(persistent.row(), persistent.row()), persistent.column()));
+  }
+  changePersistentIndexList(from, to);
+  emit layoutChanged();
+  recalculateBalances();
+
   // The index of currentOperation may have changed after sorting
-  // Selection is pointer-based so no update needed, but we need to notify
-  // so that the model can update SelectedRole for affected indices
   if (_currentOperation) {
     emit currentOperationChanged();
   }
-  if (!_selectedOperations.isEmpty()) {
-    emit selectionChanged();
-  }
 }
 
-bool Account::hasOperation(const QDate& date, double amount, const QString& label) const {
+bool Account::hasOperation(const QDate& date, Money amount, const QString& label) const {
   for (Operation* op : _operations) {
-    if (op->date() == date && op->amount() == amount && op->label() == label) {
+    if (op->date() == date && op->amountMoney() == amount && op->label() == label) {
       return true;
     }
   }
@@ -221,39 +353,35 @@ Operation* Account::operationAt(int index) const {
 // Selection management
 
 bool Account::isSelected(Operation* operation) const {
-  return operation && _selectedOperations.contains(operation);
+  return isSelectedAt(operationIndex(operation));
 }
 
 bool Account::isSelectedAt(int index) const {
-  return isSelected(operationAt(index));
+  return index >= 0 && index < _selected.size() && _selected[index];
 }
 
 void Account::select(Operation* operation, bool extend) {
-  if (!operation || !_operations.contains(operation))
+  int index = operationIndex(operation);
+  if (index < 0)
     return;
 
-  if (!extend) {
-    // Clear existing selection and select only this operation
-    _selectedOperations.clear();
-    _selectedOperations.insert(operation);
-  } else {
+  int first = INT_MAX;
+  int last = -1;
+  int fromIndex = currentOperationIndex();
+  if (extend && fromIndex >= 0) {
     // Extend selection from currentOperation to this operation
-    if (_currentOperation && _operations.contains(_currentOperation)) {
-      int fromIndex = _operations.indexOf(_currentOperation);
-      int toIndex = _operations.indexOf(operation);
-      int start = qMin(fromIndex, toIndex);
-      int end = qMax(fromIndex, toIndex);
-      for (int i = start; i <= end; ++i) {
-        _selectedOperations.insert(_operations[i]);
-      }
-    } else {
-      _selectedOperations.insert(operation);
+    setRowsSelected(qMin(fromIndex, index), qMax(fromIndex, index), true, first, last);
+  } else {
+    if (!extend) {
+      // Clear existing selection and select only this operation
+      clearSelectedRows(first, last);
     }
+    setRowsSelected(index, index, true, first, last);
   }
 
   _currentOperation = operation;
   emit currentOperationChanged();
-  emit selectionChanged();
+  notifySelectionChanged(first, last);
 }
 
 void Account::previousOperation(bool extendSelection) {
@@ -269,108 +397,232 @@ void Account::selectAt(int index, bool extend) {
 }
 
 void Account::toggleSelection(Operation* operation) {
-  if (!operation || !_operations.contains(operation))
-    return;
-
-  if (_selectedOperations.contains(operation)) {
-    _selectedOperations.remove(operation);
-  } else {
-    _selectedOperations.insert(operation);
-  }
-
-  emit selectionChanged();
+  toggleSelectionAt(operationIndex(operation));
 }
 
 void Account::toggleSelectionAt(int index) {
-  toggleSelection(operationAt(index));
+  if (index < 0 || index >= _operations.size())
+    return;
+
+  int first = INT_MAX;
+  int last = -1;
+  setRowsSelected(index, index, !_selected[index], first, last);
+  notifySelectionChanged(first, last);
 }
 
 void Account::selectRange(int fromIndex, int toIndex) {
   int start = qMax(0, qMin(fromIndex, toIndex));
   int end = qMin(_operations.size() - 1, qMax(fromIndex, toIndex));
 
-  for (int i = start; i <= end; ++i) {
-    _selectedOperations.insert(_operations[i]);
-  }
-
-  emit selectionChanged();
+  int first = INT_MAX;
+  int last = -1;
+  setRowsSelected(start, end, true, first, last);
+  notifySelectionChanged(first, last);
 }
 
 void Account::selectAll() {
-  selectRange(0, _operations.size() - 1);
+  if (_selectionCount == _operations.size())
+    return;
+
+  // Only the previously unselected rows flip; the total of all rows is the current balance
+  // without the opening balance carried over from archived years
+  int first = _selected.indexOf(false);
+  int last = _selected.lastIndexOf(false);
+  std::fill(_selected.begin(), _selected.end(), true);
+  _selectionCount = _operations.size();
+  _selectedTotal = _balances.isEmpty() ? Money() : _balances.first() - _openingBalance;
+  notifySelectionChanged(first, last);
 }
 
 void Account::clearSelection() {
-  if (_selectedOperations.isEmpty())
-    return;
-
-  _selectedOperations.clear();
-  emit selectionChanged();
+  int first = INT_MAX;
+  int last = -1;
+  clearSelectedRows(first, last);
+  notifySelectionChanged(first, last);
 }
 
 int Account::selectionCount() const {
-  return _selectedOperations.size();
+  return _selectionCount;
 }
 
 double Account::selectedTotal() const {
-  double total = 0.0;
-  for (Operation* op : _selectedOperations) {
-    total += op->amount();
-  }
-  return total;
+  return _selectedTotal.toDouble();
 }
 
-QSet<Operation*> Account::selectedOperations() const {
-  return _selectedOperations;
+QList<Operation*> Account::selectedOperations() const {
+  QList<Operation*> selected;
+  selected.reserve(_selectionCount);
+  for (int row = 0; row < _operations.size(); ++row) {
+    if (_selected[row]) {
+      selected.append(_operations[row]);
+    }
+  }
+  return selected;
 }
 
-QString Account::selectedOperationsAsCsv() const {
-  if (_selectedOperations.isEmpty())
-    return QString();
-
-  // Collect selected operations in sorted order (by their index in _operations)
-  QList<Operation*> sortedSelected;
-  for (Operation* op : _operations) {
-    if (_selectedOperations.contains(op)) {
-      sortedSelected.append(op);
+void Account::setRowsSelected(int start, int end, bool selected, int& first, int& last) {
+  for (int row = start; row <= end; ++row) {
+    if (_selected[row] == selected)
+      continue;
+    _selected[row] = selected;
+    if (selected) {
+      _selectionCount++;
+      _selectedTotal += _operations[row]->amountMoney();
+    } else {
+      _selectionCount--;
+      _selectedTotal -= _operations[row]->amountMoney();
     }
+    first = qMin(first, row);
+    last = qMax(last, row);
   }
+}
 
-  QString csv;
-  csv += "Date,Label,Amount,Category\n";
+void Account::clearSelectedRows(int& first, int& last) {
+  if (_selectionCount == 0)
+    return;
 
-  for (Operation* op : sortedSelected) {
-    csv += QString("%0,\"%1\",%2,%3\n")
-               .arg(op->date().toString("yyyy-MM-dd"),
-                    op->label().replace("\"", "\"\""))
-               .arg(op->amount(), 0, 'f', 2)
-               .arg((op->categoryDisplay()));
-  }
+  first = qMin(first, int(_selected.indexOf(true)));
+  last = qMax(last, int(_selected.lastIndexOf(true)));
+  std::fill(_selected.begin(), _selected.end(), false);
+  _selectionCount = 0;
+  _selectedTotal = {};
+}
 
-  return csv;
+void Account::notifySelectionChanged(int first, int last) {
+  if (first > last)
+    return;
+
+  emit dataChanged(index(first, 0), index(last, 0), { SelectedRole });
+  emit selectionChanged();
 }
 
 int Account::countOperationsWithCategory(const Category* category) const {
+  const QSet<Operation*> operations = _operationsByCategory.value(category);
   auto hasCategory = [category](const Operation* operation) {
-    return operation->amountForCategory(category);
+    return !operation->amountMoneyForCategory(category).isZero();
   };
-  return std::count_if(_operations.begin(), _operations.end(), hasCategory);
+  return std::count_if(operations.begin(), operations.end(), hasCategory);
+}
+
+QList<Operation*> Account::operationsWithCategory(const Category* category) const {
+  const QSet<Operation*> operations = _operationsByCategory.value(category);
+  QList<Operation*> result(operations.begin(), operations.end());
+  std::sort(result.begin(), result.end(), [this](Operation* a, Operation* b) {
+    return _rows.value(a) < _rows.value(b);
+  });
+  return result;
 }
 
 double Account::currentBalance() const {
   if (_balances.isEmpty())
-    return 0.0;
-  return _balances.first();
+    return _openingBalance.toDouble();
+  return _balances.first().toDouble();
 }
 
 double Account::balanceAt(int index) const {
   if (index < 0 || index >= _balances.size())
     return 0.0;
-  return _balances[index];
+  return _balances[index].toDouble();
+}
+
+void Account::reindexRows(int from) {
+  for (int row = from; row < _operations.size(); ++row) {
+    _rows[_operations[row]] = row;
+  }
+}
+
+void Account::indexAllocations(Operation* operation) {
+  QSet<const Category*> categories;
+  for (const Allocation* allocation : operation->allocations()) {
+    const Category* category = allocation->category();
+    if (category) {
+      categories.insert(category);
+      if (!_operationsByCategory.contains(category)) {
+        // Category names are shown in the rows of its operations
+        connect(category, &Category::nameChanged, this, [this, category] {
+          for (Operation* op : _operationsByCategory.value(category)) {
+            invalidateDisplay(op, { CategoryDisplayRole });
+          }
+        });
+      }
+      _operationsByCategory[category].insert(operation);
+    }
+  }
+  if (!categories.isEmpty()) {
+    _categoriesByOperation.insert(operation, categories);
+  }
+}
+
+void Account::unindexAllocations(Operation* operation) {
+  const QSet<const Category*> categories = _categoriesByOperation.take(operation);
+  for (const Category* category : categories) {
+    auto it = _operationsByCategory.find(category);
+    if (it != _operationsByCategory.end()) {
+      it->remove(operation);
+      if (it->isEmpty()) {
+        _operationsByCategory.erase(it);
+        disconnect(category, &Category::nameChanged, this, nullptr);
+      }
+    }
+  }
+}
+
+const Account::DisplayTexts& Account::displayTexts(const Operation* operation) const {
+  auto it = _displayTexts.find(operation);
+  if (it == _displayTexts.end()) {
+    it = _displayTexts.insert(operation, { QLocale().toString(operation->date(), QLocale::ShortFormat),
+                                           operation->categoryDisplay(),
+                                           operation->amountMoney().toDisplayString() });
+  }
+  return *it;
+}
+
+void Account::invalidateDisplay(Operation* operation, const QList<int>& roles) {
+  _displayTexts.remove(operation);
+  const int row = operationIndex(operation);
+  if (row >= 0) {
+    emit dataChanged(index(row, 0), index(row, 0), roles);
+  }
+}
+
+void Account::beginBatch() {
+  _batchDepth++;
+}
+
+void Account::endBatch() {
+  if (_batchDepth == 0 || --_batchDepth > 0)
+    return;
+
+  if (_resetPending) {
+    beginResetModel();
+    recalculateBalances();
+    endResetModel();
+  } else if (_balancesDirty) {
+    recalculateBalances();
+  }
+  _resetPending = false;
+  if (_countDirty) {
+    _countDirty = false;
+    emit countChanged();
+  }
+}
+
+void Account::notifyCountChanged() {
+  if (isBatching()) {
+    _countDirty = true;
+  } else {
+    emit countChanged();
+  }
 }
 
 void Account::recalculateBalances() {
+  if (isBatching()) {
+    _balancesDirty = true;
+    return;
+  }
+  _balancesDirty = false;
   _balances.clear();
+  _balanceTexts.clear();
 
   const int count = rowCount();
 
@@ -378,17 +630,27 @@ void Account::recalculateBalances() {
     return;
 
   _balances.resize(count);
+  _balanceTexts.resize(count);
 
   // Operations are sorted most recent first
   // Calculate cumulative balance from oldest to newest
-  double balance = 0.0;
+  // The selected total is refreshed in the same pass in case a selected amount changed
+  Money balance = _openingBalance;
+  Money selectedTotal;
   for (int i = count - 1; i >= 0; --i) {
     Operation* op = operationAt(i);
     if (op) {
-      balance += op->amount();
+      balance += op->amountMoney();
+      if (_selected[i]) {
+        selectedTotal += op->amountMoney();
+      }
     }
     _balances[i] = balance;
   }
-  emit dataChanged(createIndex(0, 0), createIndex(count - 1, 0), { BalanceRole });
+  emit dataChanged(createIndex(0, 0), createIndex(count - 1, 0), { BalanceRole, BalanceTextRole });
   emit balanceChanged();
+  if (selectedTotal != _selectedTotal) {
+    _selectedTotal = selectedTotal;
+    emit selectionChanged();
+  }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QSet>
@@ -24,11 +25,14 @@ class Account : public QAbstractListModel {
   Q_PROPERTY(int currentOperationIndex READ currentOperationIndex WRITE set_currentOperationIndex
                  NOTIFY currentOperationChanged)
 
-  // Selection properties (pointer-based, survives sorting)
+  // Selection properties (row flags permuted along with rows, survives sorting)
   Q_PROPERTY(int selectionCount READ selectionCount NOTIFY selectionChanged)
   Q_PROPERTY(double selectedTotal READ selectedTotal NOTIFY selectionChanged)
   Q_PROPERTY(double currentBalance READ currentBalance NOTIFY balanceChanged)
 
+  // Balance carried over from operations moved to an archive shard
+  PROPERTY_MONEY(openingBalance, {})
+
 public:
   enum Roles {
     DateRole = Qt::UserRole + 1,
@@ -37,6 +41,11 @@ public:
     BalanceRole,
     SelectedRole,
     OperationRole,
+    // Display texts, formatted once per operation and cached until it changes
+    DateTextRole,
+    CategoryDisplayRole,
+    AmountTextRole,
+    BalanceTextRole,
   };
   Q_ENUM(Roles)
 
@@ -55,7 +64,7 @@ public:
   Q_INVOKABLE void addImportSourcePrefix(const QString& filename);
   void setImportSourcePrefixes(const QStringList& sources);
 
-  // Current operation index (computed from currentOperation pointer)
+  // Current operation index (looked up from currentOperation pointer in constant time)
   int currentOperationIndex() const;
   void set_currentOperationIndex(int index);
 
@@ -67,15 +76,17 @@ public:
 
   Operation* addOperation(Operation* operation, bool sort = true);
   bool removeOperation(Operation* operation);  // Remove by pointer, returns true if found
+  void removeOperations(const QSet<Operation*>& operations);  // In one pass, the caller keeps ownership
   void clearOperations();
   void sortOperations();  // Re-sort operations by date (most recent first)
-  bool hasOperation(const QDate& date, double amount, const QString& label) const;
+  bool hasOperation(const QDate& date, Money amount, const QString& label) const;
 
   Operation* operationAt(int index) const;
   int operationIndex(Operation* operation) const;
 
   // Selection management (Excel-like behavior)
-  // Uses currentOperation as anchor for range selection
+  // Uses currentOperation as anchor for range selection.
+  // Count and total are maintained incrementally and only flipped rows are notified.
   bool isSelected(Operation* operation) const;
   Q_INVOKABLE bool isSelectedAt(int index) const;
   void select(Operation* operation, bool extend = false);
@@ -87,12 +98,18 @@ public:
   Q_INVOKABLE void clearSelection();
   int selectionCount() const;
   double selectedTotal() const;
-  QSet<Operation*> selectedOperations() const;
-  QString selectedOperationsAsCsv() const;
+  QList<Operation*> selectedOperations() const;  // In row order
   int countOperationsWithCategory(const Category* category) const;
+  QList<Operation*> operationsWithCategory(const Category* category) const;  // In row order
 
   double currentBalance() const;
 
+  // Batching (see BatchScope): balances, resets and count notifications are deferred
+  // until the outermost endBatch()
+  void beginBatch();
+  void endBatch();
+  bool isBatching() const { return _batchDepth > 0; }
+
   Q_INVOKABLE double balanceAt(int index) const;
 
 signals:
@@ -103,10 +120,41 @@ signals:
 
 private:
   void recalculateBalances();
+  void notifyCountChanged();
+  void reindexRows(int from);  // Refresh cached row positions from a given row to the end
+  void indexAllocations(Operation* operation);
+  void unindexAllocations(Operation* operation);
+
+  // Selection helpers: update flags, count and total, and widen [first, last] to the flipped rows
+  void setRowsSelected(int start, int end, bool selected, int& first, int& last);
+  void clearSelectedRows(int& first, int& last);
+  void notifySelectionChanged(int first, int last);
+
+  // Display texts cache
+  struct DisplayTexts {
+    QString date;
+    QString categories;
+    QString amount;
+  };
+  const DisplayTexts& displayTexts(const Operation* operation) const;
+  void invalidateDisplay(Operation* operation, const QList<int>& roles);
 
   Operation* _currentOperation = nullptr;
   QList<Operation*> _operations;
-  QSet<Operation*> _selectedOperations;
+  QHash<Operation*, int> _rows;  // Row position of each operation, kept in sync with _operations
+  // Operations allocated to each category, and the categories each operation was indexed under
+  QHash<const Category*, QSet<Operation*>> _operationsByCategory;
+  QHash<Operation*, QSet<const Category*>> _categoriesByOperation;
+  QList<bool> _selected;  // Selection flag per row, parallel to _operations
+  int _selectionCount = 0;
+  Money _selectedTotal;
   QStringList _importSources;
-  QVector<double> _balances;
+  QVector<Money> _balances;
+  mutable QHash<const Operation*, DisplayTexts> _displayTexts;
+  mutable QList<QString> _balanceTexts;  // Parallel to _balances, formatted on first read
+
+  int _batchDepth = 0;
+  bool _balancesDirty = false;
+  bool _resetPending = false;
+  bool _countDirty = false;
 };
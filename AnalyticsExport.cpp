@@ -0,0 +1,150 @@
+#include <QHash>
+#include <QIODevice>
+
+#include "Account.h"
+#include "AnalyticsExport.h"
+#include "ArrowFileWriter.h"
+#include "Operation.h"
+
+namespace {
+
+enum DictionaryId : qint64 {
+  AccountDictionary,
+  LabelDictionary,
+  CategoryDictionary,
+};
+
+enum ColumnIndex {
+  AccountColumn,
+  OperationColumn,
+  DateColumn,
+  BudgetDateColumn,
+  LabelColumn,
+  CategoryColumn,
+  AmountColumn,
+  OperationAmountColumn,
+  ColumnCount,
+};
+
+// Unix epoch as a julian day, to convert dates to Arrow date32
+constexpr qint64 UnixEpochJulianDay = 2440588;
+
+// Strings of a dictionary-encoded column, in order of first appearance
+class Dictionary {
+public:
+  qint32 indexOf(const QString& value) {
+    auto it = _indexes.constFind(value);
+    if (it != _indexes.cend())
+      return *it;
+    const qint32 index = qint32(_values.size());
+    _indexes.insert(value, index);
+    _values.append(value);
+    return index;
+  }
+
+  const QStringList& values() const { return _values; }
+
+private:
+  QHash<QString, qint32> _indexes;
+  QStringList _values;
+};
+
+qint32 toDate32(const QDate& date) {
+  return qint32(date.toJulianDay() - UnixEpochJulianDay);
+}
+
+}  // namespace
+
+namespace AnalyticsExport {
+
+bool writeOperations(QIODevice& device, const QList<Account*>& accounts, QString& errorMessage) {
+  using Type = ArrowFileWriter::Type;
+  ArrowFileWriter writer(device,
+                         {
+                             { "account", Type::Dictionary, false, AccountDictionary },
+                             { "operation", Type::Int64, false, -1 },
+                             { "date", Type::Date32, false, -1 },
+                             { "budget_date", Type::Date32, false, -1 },
+                             { "label", Type::Dictionary, false, LabelDictionary },
+                             { "category", Type::Dictionary, true, CategoryDictionary },
+                             { "amount_cents", Type::Int64, false, -1 },
+                             { "operation_amount_cents", Type::Int64, false, -1 },
+                         });
+
+  // Dictionaries come first in the file, so collect every string before writing any row
+  Dictionary accountNames;
+  Dictionary labels;
+  Dictionary categoryNames;
+  for (const Account* account : accounts) {
+    accountNames.indexOf(account->name());
+    for (const Operation* operation : account->operations()) {
+      labels.indexOf(operation->label());
+      for (const Allocation* allocation : operation->allocations()) {
+        if (allocation->category()) {
+          categoryNames.indexOf(allocation->category()->name());
+        }
+      }
+    }
+  }
+
+  bool ok = writer.begin()
+            && writer.writeDictionary(AccountDictionary, accountNames.values())
+            && writer.writeDictionary(LabelDictionary, labels.values())
+            && writer.writeDictionary(CategoryDictionary, categoryNames.values());
+
+  QList<ArrowFileWriter::Column> columns(ColumnCount);
+  qint64 operationNumber = 0;
+  for (const Account* account : accounts) {
+    if (!ok)
+      break;
+    const QList<Operation*> operations = account->operations();
+    if (operations.isEmpty())
+      continue;
+
+    for (auto& column : columns) {
+      column.clear();
+    }
+    const qint32 accountIndex = accountNames.indexOf(account->name());
+    qint64 rowCount = 0;
+    for (const Operation* operation : operations) {
+      const qint32 date = toDate32(operation->date());
+      const qint32 budgetDate = toDate32(operation->budgetDate());
+      const qint32 label = labels.indexOf(operation->label());
+      const qint64 operationAmount = operation->amountMoney().cents();
+
+      auto appendRow = [&](const Category* category, qint64 amount) {
+        columns[AccountColumn].appendInt32(accountIndex);
+        columns[OperationColumn].appendInt64(operationNumber);
+        columns[DateColumn].appendInt32(date);
+        columns[BudgetDateColumn].appendInt32(budgetDate);
+        columns[LabelColumn].appendInt32(label);
+        if (category) {
+          columns[CategoryColumn].appendInt32(categoryNames.indexOf(category->name()));
+        } else {
+          columns[CategoryColumn].appendNull(Type::Dictionary);
+        }
+        columns[AmountColumn].appendInt64(amount);
+        columns[OperationAmountColumn].appendInt64(operationAmount);
+        rowCount++;
+      };
+
+      const QList<Allocation*> allocations = operation->allocations();
+      if (allocations.isEmpty()) {
+        appendRow(nullptr, operationAmount);
+      }
+      for (const Allocation* allocation : allocations) {
+        appendRow(allocation->category(), allocation->amountMoney().cents());
+      }
+      operationNumber++;
+    }
+    ok = writer.writeRecordBatch(rowCount, columns);
+  }
+
+  if (!ok || !writer.finish()) {
+    errorMessage = device.errorString();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace AnalyticsExport
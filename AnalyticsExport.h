@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+class Account;
+class QIODevice;
+
+// Columnar export of operations for external data tools, as an Arrow IPC (Feather v2) file.
+// One row per allocation (one with a null category for uncategorized operations) and one
+// record batch per account. Columns: account, operation, date, budget_date, label, category,
+// amount_cents, operation_amount_cents; account, label and category are dictionary-encoded.
+namespace AnalyticsExport {
+
+bool writeOperations(QIODevice& device, const QList<Account*>& accounts, QString& errorMessage);
+
+}  // namespace AnalyticsExport
@@ -12,6 +12,8 @@ AppSettings::AppSettings() :
   _theme = _settings.value("theme", QString()).toString();
   _checkForUpdates = _settings.value("checkForUpdates", true).toBool();
   _lastUpdateCheck = _settings.value("lastUpdateCheck", QDateTime()).toDateTime();
+  _undoLimit = _settings.value("undoLimit", DefaultUndoLimit).toInt();
+  _autosave = _settings.value("autosave", false).toBool();
   _recentFilesModel.setStringList(_settings.value("recentFiles", QStringList()).toStringList());
 }
 
@@ -120,6 +122,32 @@ void AppSettings::set_lastUpdateCheck(QDateTime value) {
   }
 }
 
+int AppSettings::undoLimit() const {
+  return _undoLimit;
+}
+
+void AppSettings::set_undoLimit(int value) {
+  if (_undoLimit != value) {
+    _undoLimit = value;
+    _settings.setValue("undoLimit", value);
+    _settings.sync();
+    emit undoLimitChanged();
+  }
+}
+
+bool AppSettings::autosave() const {
+  return _autosave;
+}
+
+void AppSettings::set_autosave(bool value) {
+  if (_autosave != value) {
+    _autosave = value;
+    _settings.setValue("autosave", value);
+    _settings.sync();
+    emit autosaveChanged();
+  }
+}
+
 QAbstractListModel* AppSettings::recentFilesModel() {
   return &_recentFilesModel;
 }
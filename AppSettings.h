@@ -29,6 +29,13 @@ class AppSettings : public QObject {
   // Last time we checked for updates
   PROPERTY_RW_CUSTOM(QDateTime, lastUpdateCheck, QDateTime())
 
+  // Maximum number of undo steps kept in memory, opt-in (0 = unlimited). QUndoStack only takes
+  // a new limit while empty, so it applies from the next opened file.
+  PROPERTY_RW_CUSTOM(int, undoLimit, DefaultUndoLimit)
+
+  // Save the current file in the background a few seconds after each edit
+  PROPERTY_RW_CUSTOM(bool, autosave, false)
+
   // Recent files model for proper QML binding
   Q_PROPERTY(QAbstractListModel* recentFilesModel READ recentFilesModel CONSTANT)
 
@@ -41,6 +48,7 @@ public:
   Q_INVOKABLE void clearRecentFiles();
 
   static constexpr int MaxRecentFiles = 10;
+  static constexpr int DefaultUndoLimit = 0;
 
 signals:
   void languageChangeRequested();
@@ -11,11 +11,16 @@ MenuBar {
     signal openFileAction
     signal saveFileDialogAction
     signal importFileDialogAction
+    signal exportOperationsDialogAction
+    signal exportBudgetReportDialogAction
+    signal exportAnalyticsDialogAction
+    signal archiveYearsDialogAction
 
     signal addAction
     signal editAction
     signal deleteAction
     signal rulesAction
+    signal transfersAction
     signal preferencesAction
 
     signal checkUpdateAction
@@ -31,6 +36,10 @@ MenuBar {
         onOpenFileAction: root.openFileAction()
         onSaveFileDialogAction: root.saveFileDialogAction()
         onImportFileDialogAction: root.importFileDialogAction()
+        onExportOperationsDialogAction: root.exportOperationsDialogAction()
+        onExportBudgetReportDialogAction: root.exportBudgetReportDialogAction()
+        onExportAnalyticsDialogAction: root.exportAnalyticsDialogAction()
+        onArchiveYearsDialogAction: root.archiveYearsDialogAction()
         onOpenRecentFileAction: filePath => root.openRecentFileAction(filePath)
         onQuitAction: root.quitAction()
     }
@@ -39,6 +48,7 @@ MenuBar {
         onEditAction: root.editAction()
         onDeleteAction: root.deleteAction()
         onRulesAction: root.rulesAction()
+        onTransfersAction: root.transfersAction()
         onPreferencesAction: root.preferencesAction()
     }
     ViewMenu {
@@ -0,0 +1,270 @@
+#include <yaml-cpp/yaml.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "Account.h"
+#include "ArchiveStore.h"
+#include "CategoryController.h"
+#include "Operation.h"
+#include "OperationYaml.h"
+
+static constexpr QFileDevice::Permissions ReadOnly = QFileDevice::ReadOwner | QFileDevice::ReadUser | QFileDevice::ReadGroup | QFileDevice::ReadOther;
+
+ArchiveStore::ArchiveStore(CategoryController& categoryController, QObject* parent) :
+    QObject(parent),
+    _categoryController(categoryController) {
+}
+
+ArchiveStore::~ArchiveStore() {
+  unload();
+}
+
+void ArchiveStore::setBudgetFile(const QString& filePath) {
+  // Shards already read stay valid as long as the budget file is the same
+  if (filePath != _budgetFile) {
+    unload();
+    _budgetFile = filePath;
+  }
+
+  // Renames not yet written to the shards follow them to a new file (Save As), not to another budget
+  if (filePath.isEmpty()) {
+    _renamedCategories.clear();
+  }
+
+  const QList<int> years = shardYears(filePath);
+  if (years != _years) {
+    _years = years;
+    emit yearsChanged();
+  }
+}
+
+QList<int> ArchiveStore::shardYears(const QString& budgetFile) {
+  QList<int> years;
+  if (budgetFile.isEmpty())
+    return years;
+
+  // Shards are named <budget>.<year>.comptinearchive
+  const QFileInfo budget(budgetFile);
+  const QString prefix = budget.completeBaseName() + '.';
+  const QStringList names = budget.dir().entryList({ prefix + "*." + FileSuffix }, QDir::Files);
+  for (const QString& name : names) {
+    bool ok = false;
+    const int year = QFileInfo(name).completeBaseName().mid(prefix.size()).toInt(&ok);
+    if (ok) {
+      years.append(year);
+    }
+  }
+  std::sort(years.begin(), years.end());
+  return years;
+}
+
+bool ArchiveStore::copyTo(const QString& budgetFile) {
+  _errorString.clear();
+  if (_budgetFile.isEmpty() || budgetFile == _budgetFile || _years.isEmpty())
+    return true;
+
+  // Shards left by another budget saved under that name would mix with ours
+  if (!shardYears(budgetFile).isEmpty()) {
+    _errorString = tr("Archived years of another budget already exist next to %1").arg(QFileInfo(budgetFile).fileName());
+    return false;
+  }
+  QStringList copied;
+  for (int year : std::as_const(_years)) {
+    const QString from = shardPath(_budgetFile, year);
+    const QString to = shardPath(budgetFile, year);
+    QFile file(from);
+    if (!file.copy(to)) {
+      qWarning() << "Failed to copy archive:" << from << "to" << to << file.errorString();
+      _errorString = file.errorString();
+      for (const QString& path : std::as_const(copied)) {
+        QFile::setPermissions(path, ReadOnly | QFileDevice::WriteOwner | QFileDevice::WriteUser);
+        QFile::remove(path);
+      }
+      return false;
+    }
+    QFile::setPermissions(to, ReadOnly);
+    copied.append(to);
+  }
+  return true;
+}
+
+QString ArchiveStore::shardPath(const QString& budgetFile, int year) {
+  const QFileInfo budget(budgetFile);
+  return budget.dir().filePath(QStringLiteral("%1.%2.%3").arg(budget.completeBaseName()).arg(year).arg(FileSuffix));
+}
+
+QList<const Account*> ArchiveStore::accounts(int year) {
+  if (!_shards.contains(year) && (!contains(year) || !read(year)))
+    return {};
+
+  const QList<Account*>& shard = _shards[year];
+  return QList<const Account*>(shard.cbegin(), shard.cend());
+}
+
+bool ArchiveStore::write(int year, const QHash<QString, QList<const Operation*>>& operationsByAccount) {
+  _errorString.clear();
+  if (_budgetFile.isEmpty()) {
+    _errorString = tr("The budget has no file");
+    return false;
+  }
+
+  // Shards are rewritten whole: keep what an earlier archiving already moved there
+  QHash<QString, QList<const Operation*>> content;
+  QStringList accountNames;
+  if (!loadedContent(year, accountNames, content))
+    return false;
+  for (auto it = operationsByAccount.cbegin(); it != operationsByAccount.cend(); ++it) {
+    if (!accountNames.contains(it.key())) {
+      accountNames.append(it.key());
+    }
+    content[it.key()].append(it.value());
+  }
+  if (!writeShard(year, accountNames, content))
+    return false;
+
+  // Read again on next access, with the new operations
+  qDeleteAll(_shards.take(year));
+  if (!contains(year)) {
+    _years.insert(std::lower_bound(_years.begin(), _years.end(), year), year);
+    emit yearsChanged();
+  }
+  qDebug() << "Archived year" << year << "to:" << shardPath(_budgetFile, year);
+  return true;
+}
+
+void ArchiveStore::categoryRenamed(Category* category, const QString& previousName) {
+  if (_years.isEmpty())
+    return;
+
+  // Only the name written in the shards matters, not the ones the category had since
+  for (auto it = _renamedCategories.cbegin(); it != _renamedCategories.cend(); ++it) {
+    if (it.value() == category)
+      return;
+  }
+  if (!_renamedCategories.contains(previousName)) {
+    _renamedCategories.insert(previousName, category);
+  }
+}
+
+bool ArchiveStore::applyRenames() {
+  _errorString.clear();
+  if (_renamedCategories.isEmpty())
+    return true;
+
+  // Operations of loaded shards point to their categories: written back, they carry the new names
+  for (int year : std::as_const(_years)) {
+    QHash<QString, QList<const Operation*>> content;
+    QStringList accountNames;
+    if (!loadedContent(year, accountNames, content) || !writeShard(year, accountNames, content))
+      return false;
+  }
+  _renamedCategories.clear();
+  return true;
+}
+
+bool ArchiveStore::loadedContent(int year, QStringList& accountNames, QHash<QString, QList<const Operation*>>& content) {
+  if (contains(year) && !_shards.contains(year) && !read(year))
+    return false;
+  for (const Account* account : _shards.value(year)) {
+    accountNames.append(account->name());
+    for (const Operation* op : account->operations()) {
+      content[account->name()].append(op);
+    }
+  }
+  return true;
+}
+
+bool ArchiveStore::writeShard(int year, const QStringList& accountNames, const QHash<QString, QList<const Operation*>>& content) {
+  YAML::Emitter out;
+  out << YAML::BeginMap;
+  out << YAML::Key << "archive" << YAML::Value << YAML::BeginMap;
+  out << YAML::Key << "year" << YAML::Value << year;
+  out << YAML::EndMap;
+  out << YAML::Key << "accounts" << YAML::Value << YAML::BeginSeq;
+  for (const QString& name : accountNames) {
+    QList<const Operation*> operations = content.value(name);
+    std::stable_sort(operations.begin(), operations.end(), [](const Operation* a, const Operation* b) {
+      return a->date() > b->date();  // Most recent first, like accounts
+    });
+    out << YAML::BeginMap;
+    out << YAML::Key << "name" << YAML::Value << name.toStdString();
+    out << YAML::Key << "operations" << YAML::Value << YAML::BeginSeq;
+    for (const Operation* op : std::as_const(operations)) {
+      OperationYaml::write(out, *op);
+    }
+    out << YAML::EndSeq;
+    out << YAML::EndMap;
+  }
+  out << YAML::EndSeq;
+  out << YAML::EndMap;
+
+  // The shard is the only copy of its operations: the previous one stays in place until the
+  // new one is complete. QSaveFile does not replace a read-only file, so lift the flag meanwhile.
+  const QString filePath = shardPath(_budgetFile, year);
+  if (QFile::exists(filePath)) {
+    QFile::setPermissions(filePath, ReadOnly | QFileDevice::WriteOwner | QFileDevice::WriteUser);
+  }
+  QSaveFile file(filePath);
+  bool saved = file.open(QIODevice::WriteOnly | QIODevice::Text);
+  if (saved) {
+    file.write(out.c_str(), qint64(out.size()));
+    file.write("\n");
+    saved = file.commit();
+  }
+  QFile::setPermissions(filePath, ReadOnly);  // The new shard, or the previous one left in place
+  if (!saved) {
+    qWarning() << "Failed to write archive:" << filePath << file.errorString();
+    _errorString = file.errorString();
+    return false;
+  }
+  return true;
+}
+
+bool ArchiveStore::read(int year) {
+  const QString filePath = shardPath(_budgetFile, year);
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Failed to open archive:" << filePath << file.errorString();
+    _errorString = file.errorString();
+    return false;
+  }
+  const QByteArray data = file.readAll();
+
+  QList<Account*> shard;
+  try {
+    const YAML::Node root = YAML::Load(std::string(data.constData(), data.size()));
+    auto categoryByName = [this](const QString& name) {
+      if (Category* category = _renamedCategories.value(name))
+        return category;
+      return _categoryController.getCategoryByName(name);
+    };
+    for (const auto& accountNode : root["accounts"]) {
+      auto account = new Account(QString::fromStdString(accountNode["name"].as<std::string>()));
+      account->setParent(this);
+      shard.append(account);
+      for (const auto& opNode : accountNode["operations"]) {
+        account->addOperation(OperationYaml::read(opNode, account, categoryByName), false);
+      }
+    }
+  } catch (const std::exception& e) {
+    qWarning() << "Archive parsing error:" << filePath << e.what();
+    _errorString = QString::fromUtf8(e.what());
+    qDeleteAll(shard);
+    return false;
+  }
+
+  _shards.insert(year, shard);
+  return true;
+}
+
+void ArchiveStore::unload() {
+  for (const QList<Account*>& shard : std::as_const(_shards)) {
+    qDeleteAll(shard);
+  }
+  _shards.clear();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QQmlEngine>
+#include <QString>
+#include <QStringList>
+
+class Account;
+class Category;
+class CategoryController;
+class Operation;
+
+// Read-only archive shards next to a budget file.
+// Each shard holds the operations of one budget year moved out of the live budget by
+// FileController::archiveYearsBefore(). A shard is only read when one of its months is
+// browsed, and stays loaded until another budget file is opened.
+class ArchiveStore : public QObject {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by CategoryController")
+
+  Q_PROPERTY(QList<int> years READ years NOTIFY yearsChanged)
+
+public:
+  static constexpr const char* FileSuffix = "comptinearchive";
+
+  explicit ArchiveStore(CategoryController& categoryController, QObject* parent = nullptr);
+  ~ArchiveStore() override;
+
+  // Budget file the shards belong to (an empty path forgets them), looks for its shards again
+  void setBudgetFile(const QString& filePath);
+  static QString shardPath(const QString& budgetFile, int year);
+  static QList<int> shardYears(const QString& budgetFile);  // Years with a shard next to a budget file, ascending
+
+  // Copy the shards next to another budget file, before the budget is saved there.
+  // Fails if that file already has shards, which belong to another budget.
+  bool copyTo(const QString& budgetFile);
+
+  QList<int> years() const { return _years; }
+  bool contains(int year) const { return _years.contains(year); }
+
+  // Read-only accounts holding the archived operations of a budget year
+  QList<const Account*> accounts(int year);
+
+  // Add operations, grouped by account name, to the shard of a budget year
+  bool write(int year, const QHash<QString, QList<const Operation*>>& operationsByAccount);
+
+  // Shards name the categories of their operations. A renamed category keeps being found under
+  // its previous name until applyRenames() rewrites the shards, once the budget is saved.
+  void categoryRenamed(Category* category, const QString& previousName);
+  bool applyRenames();
+
+  QString errorString() const { return _errorString; }
+
+signals:
+  void yearsChanged();
+
+private:
+  bool read(int year);
+  bool loadedContent(int year, QStringList& accountNames, QHash<QString, QList<const Operation*>>& content);
+  bool writeShard(int year, const QStringList& accountNames, const QHash<QString, QList<const Operation*>>& content);
+  void unload();
+
+  CategoryController& _categoryController;
+  QString _budgetFile;
+  QList<int> _years;                             // Years with a shard, ascending
+  QHash<int, QList<Account*>> _shards;           // Shards read so far, owned
+  QHash<QString, Category*> _renamedCategories;  // Name in the shards -> category renamed since
+  QString _errorString;
+};
@@ -0,0 +1,411 @@
+#include <QIODevice>
+#include <QtEndian>
+#include <algorithm>
+
+#include "ArrowFileWriter.h"
+
+namespace {
+
+// Arrow format constants (Schema.fbs, Message.fbs)
+constexpr qint16 MetadataVersionV5 = 4;
+constexpr quint8 MessageHeaderSchema = 1;
+constexpr quint8 MessageHeaderDictionaryBatch = 2;
+constexpr quint8 MessageHeaderRecordBatch = 3;
+constexpr quint8 TypeInt = 2;
+constexpr quint8 TypeUtf8 = 5;
+constexpr quint8 TypeDate = 8;
+constexpr qint16 DateUnitDay = 0;
+
+const QByteArray Magic("ARROW1");
+
+qint64 padding(qint64 size) {
+  return (8 - size % 8) % 8;
+}
+
+// Minimal FlatBuffers builder for the Arrow metadata, filled back to front like the reference
+// implementation: children are created first and referred to by their distance from the end.
+class FlatBuilder {
+public:
+  using Offset = quint32;
+
+  Offset size() const { return Offset(_buffer.size()); }
+
+  template <typename T>
+  void push(T value) {
+    prep(sizeof(T), 0);
+    prependScalar(value);
+  }
+
+  Offset createString(const QByteArray& string) {
+    prep(sizeof(quint32), string.size() + 1);
+    _buffer.prepend('\0');
+    _buffer.prepend(string);
+    prependScalar(quint32(string.size()));
+    return size();
+  }
+
+  Offset createOffsetVector(const QList<Offset>& offsets) {
+    prep(sizeof(quint32), sizeof(Offset) * offsets.size());
+    for (auto it = offsets.crbegin(); it != offsets.crend(); ++it) {
+      pushOffset(*it);
+    }
+    prependScalar(quint32(offsets.size()));
+    return size();
+  }
+
+  // Vector of structs aligned on 8 bytes, given as their raw bytes
+  Offset createStructVector(const QByteArray& elements, int count) {
+    prep(sizeof(quint32), elements.size());
+    prep(8, elements.size());
+    _buffer.prepend(elements);
+    prependScalar(quint32(count));
+    return size();
+  }
+
+  void startTable() {
+    _fields.clear();
+    _tableEnd = size();
+  }
+
+  template <typename T>
+  void addScalar(int id, T value) {
+    push(value);
+    _fields.append({ id, size() });
+  }
+
+  void addOffset(int id, Offset offset) {
+    pushOffset(offset);
+    _fields.append({ id, size() });
+  }
+
+  Offset endTable() {
+    push(qint32(0));  // Offset to the vtable, patched below
+    const Offset table = size();
+
+    int fieldCount = 0;
+    for (const auto& field : std::as_const(_fields)) {
+      fieldCount = std::max(fieldCount, field.id + 1);
+    }
+    QList<quint16> fieldOffsets(fieldCount, 0);
+    for (const auto& field : std::as_const(_fields)) {
+      fieldOffsets[field.id] = quint16(table - field.offset);
+    }
+    for (auto it = fieldOffsets.crbegin(); it != fieldOffsets.crend(); ++it) {
+      push(*it);
+    }
+    push(quint16(table - _tableEnd));
+    push(quint16(sizeof(quint16) * (2 + fieldCount)));
+    const Offset vtable = size();
+
+    const qint32 vtableOffset = qToLittleEndian(qint32(vtable - table));
+    memcpy(_buffer.data() + (_buffer.size() - table), &vtableOffset, sizeof(vtableOffset));
+    return table;
+  }
+
+  QByteArray finish(Offset root) {
+    prep(_minAlign, sizeof(Offset));
+    pushOffset(root);
+    return _buffer;
+  }
+
+private:
+  struct FieldLocation {
+    int id;
+    Offset offset;
+  };
+
+  // Pad so that `size` bytes can be written aligned after `additional` bytes
+  void prep(int size, qsizetype additional) {
+    _minAlign = std::max(_minAlign, size);
+    const qsizetype pad = (size - (_buffer.size() + additional) % size) % size;
+    _buffer.prepend(QByteArray(pad, '\0'));
+  }
+
+  void pushOffset(Offset offset) {
+    prep(sizeof(Offset), 0);
+    prependScalar(quint32(size() + sizeof(Offset) - offset));
+  }
+
+  template <typename T>
+  void prependScalar(T value) {
+    const T littleEndian = qToLittleEndian(value);
+    _buffer.prepend(reinterpret_cast<const char*>(&littleEndian), sizeof(T));
+  }
+
+  QByteArray _buffer;
+  QList<FieldLocation> _fields;
+  Offset _tableEnd = 0;
+  int _minAlign = 1;
+};
+
+template <typename T>
+void appendScalar(QByteArray& data, T value) {
+  const T littleEndian = qToLittleEndian(value);
+  data.append(reinterpret_cast<const char*>(&littleEndian), sizeof(T));
+}
+
+// Int table of Schema.fbs
+FlatBuilder::Offset createIntType(FlatBuilder& builder, qint32 bitWidth) {
+  builder.startTable();
+  builder.addScalar(0, bitWidth);
+  builder.addScalar(1, quint8(true));  // is_signed
+  return builder.endTable();
+}
+
+// Body of a record batch: buffers padded to 8 bytes, with their FieldNode and Buffer structs
+struct Body {
+  QByteArray data;
+  QByteArray nodes;
+  QByteArray buffers;
+  int nodeCount = 0;
+  int bufferCount = 0;
+
+  void addNode(qint64 length, qint64 nullCount) {
+    appendScalar(nodes, length);
+    appendScalar(nodes, nullCount);
+    nodeCount++;
+  }
+
+  void addBuffer(const QByteArray& buffer) {
+    appendScalar(buffers, qint64(data.size()));
+    appendScalar(buffers, qint64(buffer.size()));
+    bufferCount++;
+    data.append(buffer);
+    data.append(QByteArray(padding(buffer.size()), '\0'));
+  }
+};
+
+// RecordBatch table of Message.fbs
+FlatBuilder::Offset createRecordBatch(FlatBuilder& builder, qint64 length, const Body& body) {
+  const auto nodes = builder.createStructVector(body.nodes, body.nodeCount);
+  const auto buffers = builder.createStructVector(body.buffers, body.bufferCount);
+  builder.startTable();
+  builder.addScalar(0, length);
+  builder.addOffset(1, nodes);
+  builder.addOffset(2, buffers);
+  return builder.endTable();
+}
+
+QByteArray createMessage(FlatBuilder& builder, quint8 headerType, FlatBuilder::Offset header, qint64 bodyLength) {
+  builder.startTable();
+  builder.addScalar(3, bodyLength);
+  builder.addOffset(2, header);
+  builder.addScalar(0, MetadataVersionV5);
+  builder.addScalar(1, headerType);
+  return builder.finish(builder.endTable());
+}
+
+// Schema table of Schema.fbs
+FlatBuilder::Offset createSchema(FlatBuilder& builder, const QList<ArrowFileWriter::Field>& fields) {
+  QList<FlatBuilder::Offset> fieldOffsets;
+  for (const auto& field : fields) {
+    const auto name = builder.createString(field.name.toUtf8());
+    const auto children = builder.createOffsetVector({});
+
+    quint8 typeType = TypeInt;
+    FlatBuilder::Offset type = 0;
+    FlatBuilder::Offset dictionary = 0;
+    switch (field.type) {
+      case ArrowFileWriter::Type::Int32:
+        type = createIntType(builder, 32);
+        break;
+      case ArrowFileWriter::Type::Int64:
+        type = createIntType(builder, 64);
+        break;
+      case ArrowFileWriter::Type::Date32:
+        typeType = TypeDate;
+        builder.startTable();
+        builder.addScalar(0, DateUnitDay);
+        type = builder.endTable();
+        break;
+      case ArrowFileWriter::Type::Dictionary: {
+        typeType = TypeUtf8;  // The type of the dictionary values
+        builder.startTable();
+        type = builder.endTable();
+        const auto indexType = createIntType(builder, 32);
+        builder.startTable();
+        builder.addScalar(0, field.dictionaryId);
+        builder.addOffset(1, indexType);
+        dictionary = builder.endTable();
+        break;
+      }
+    }
+
+    builder.startTable();
+    builder.addOffset(0, name);
+    builder.addOffset(3, type);
+    if (dictionary) {
+      builder.addOffset(4, dictionary);
+    }
+    builder.addOffset(5, children);
+    builder.addScalar(1, quint8(field.nullable));
+    builder.addScalar(2, typeType);
+    fieldOffsets.append(builder.endTable());
+  }
+
+  const auto fieldVector = builder.createOffsetVector(fieldOffsets);
+  builder.startTable();
+  builder.addOffset(1, fieldVector);
+  builder.addScalar(0, qint16(0));  // Little endian
+  return builder.endTable();
+}
+
+}  // namespace
+
+void ArrowFileWriter::Column::appendInt32(qint32 value) {
+  appendScalar(values, value);
+  markValidity(true);
+}
+
+void ArrowFileWriter::Column::appendInt64(qint64 value) {
+  appendScalar(values, value);
+  markValidity(true);
+}
+
+void ArrowFileWriter::Column::appendNull(Type type) {
+  values.append(QByteArray(type == Type::Int64 ? 8 : 4, '\0'));
+  markValidity(false);
+}
+
+void ArrowFileWriter::Column::clear() {
+  values.resize(0);  // Keeps the capacity for the next batch
+  validity.resize(0);
+  length = 0;
+  nullCount = 0;
+}
+
+void ArrowFileWriter::Column::markValidity(bool valid) {
+  if (valid && nullCount == 0) {
+    length++;  // No bitmap until the first null
+    return;
+  }
+  if (nullCount == 0) {
+    // First null: every value so far was valid
+    validity = QByteArray((length + 7) / 8, '\0');
+    for (qint64 i = 0; i < length; ++i) {
+      validity[i / 8] = char(validity[i / 8] | (1 << (i % 8)));
+    }
+  }
+  if (validity.size() <= length / 8) {
+    validity.append('\0');
+  }
+  if (valid) {
+    validity[length / 8] = char(validity[length / 8] | (1 << (length % 8)));
+  } else {
+    nullCount++;
+  }
+  length++;
+}
+
+ArrowFileWriter::ArrowFileWriter(QIODevice& device, const QList<Field>& fields) :
+    _device(device),
+    _fields(fields) {
+}
+
+bool ArrowFileWriter::begin() {
+  write(Magic + QByteArray(2, '\0'));
+  return writeMessage(schemaMessage(), {}, nullptr);
+}
+
+bool ArrowFileWriter::writeDictionary(qint64 id, const QStringList& values) {
+  QByteArray offsets;
+  QByteArray data;
+  appendScalar(offsets, qint32(0));
+  for (const QString& value : values) {
+    data.append(value.toUtf8());
+    appendScalar(offsets, qint32(data.size()));
+  }
+
+  Body body;
+  body.addNode(values.size(), 0);
+  body.addBuffer({});  // Validity, all valid
+  body.addBuffer(offsets);
+  body.addBuffer(data);
+
+  FlatBuilder builder;
+  const auto recordBatch = createRecordBatch(builder, values.size(), body);
+  builder.startTable();
+  builder.addScalar(0, id);
+  builder.addOffset(1, recordBatch);
+  const auto dictionaryBatch = builder.endTable();
+  return writeMessage(createMessage(builder, MessageHeaderDictionaryBatch, dictionaryBatch, body.data.size()),
+                      body.data,
+                      &_dictionaryBlocks);
+}
+
+bool ArrowFileWriter::writeRecordBatch(qint64 length, const QList<Column>& columns) {
+  Body body;
+  for (const Column& column : columns) {
+    body.addNode(column.length, column.nullCount);
+    body.addBuffer(column.validity);
+    body.addBuffer(column.values);
+  }
+
+  FlatBuilder builder;
+  const auto recordBatch = createRecordBatch(builder, length, body);
+  return writeMessage(createMessage(builder, MessageHeaderRecordBatch, recordBatch, body.data.size()),
+                      body.data,
+                      &_recordBatchBlocks);
+}
+
+bool ArrowFileWriter::finish() {
+  auto blockVector = [](const QList<Block>& blocks) {
+    QByteArray data;
+    for (const Block& block : blocks) {
+      appendScalar(data, block.offset);
+      appendScalar(data, block.metadataLength);
+      appendScalar(data, qint32(0));  // Padding
+      appendScalar(data, block.bodyLength);
+    }
+    return data;
+  };
+
+  // Footer table of File.fbs
+  FlatBuilder builder;
+  const auto schema = createSchema(builder, _fields);
+  const auto dictionaries = builder.createStructVector(blockVector(_dictionaryBlocks), _dictionaryBlocks.size());
+  const auto recordBatches = builder.createStructVector(blockVector(_recordBatchBlocks), _recordBatchBlocks.size());
+  builder.startTable();
+  builder.addOffset(1, schema);
+  builder.addOffset(2, dictionaries);
+  builder.addOffset(3, recordBatches);
+  builder.addScalar(0, MetadataVersionV5);
+  const QByteArray footer = builder.finish(builder.endTable());
+
+  QByteArray footerLength;
+  appendScalar(footerLength, qint32(footer.size()));
+  return write(footer) && write(footerLength) && write(Magic);
+}
+
+QByteArray ArrowFileWriter::schemaMessage() const {
+  FlatBuilder builder;
+  const auto schema = createSchema(builder, _fields);
+  return createMessage(builder, MessageHeaderSchema, schema, 0);
+}
+
+bool ArrowFileWriter::writeMessage(const QByteArray& metadata, const QByteArray& body, QList<Block>* blocks) {
+  // Encapsulated message: continuation marker, metadata size, metadata padded to 8 bytes, body
+  const qint64 offset = _position;
+  const qint32 paddedSize = qint32(metadata.size() + padding(metadata.size()));
+  QByteArray prefix;
+  appendScalar(prefix, quint32(0xFFFFFFFF));
+  appendScalar(prefix, paddedSize);
+  if (!write(prefix) || !write(metadata) || !write(QByteArray(paddedSize - metadata.size(), '\0')) || !write(body))
+    return false;
+
+  if (blocks) {
+    blocks->append({ offset, qint32(prefix.size()) + paddedSize, body.size() });
+  }
+  return true;
+}
+
+bool ArrowFileWriter::write(const QByteArray& data) {
+  if (_failed)
+    return false;
+  if (_device.write(data) != data.size()) {
+    _failed = true;
+    return false;
+  }
+  _position += data.size();
+  return true;
+}
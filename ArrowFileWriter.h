@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+
+// Writes tables in the Arrow IPC file format (also known as Feather v2), which most data
+// tools read directly. Only covers what the analytics export needs: flat int32, int64,
+// date32 and dictionary-encoded string columns, dictionaries written before the batches.
+class ArrowFileWriter {
+public:
+  enum class Type {
+    Int32,
+    Int64,
+    Date32,      // Days since 1970-01-01, as int32
+    Dictionary,  // Int32 indices into a dictionary of strings
+  };
+
+  struct Field {
+    QString name;
+    Type type = Type::Int32;
+    bool nullable = false;
+    qint64 dictionaryId = -1;  // For Type::Dictionary
+  };
+
+  // Values of one column of a record batch, little-endian, with a validity bitmap
+  // allocated on the first null only
+  struct Column {
+    QByteArray values;
+    QByteArray validity;
+    qint64 length = 0;
+    qint64 nullCount = 0;
+
+    void appendInt32(qint32 value);
+    void appendInt64(qint64 value);
+    void appendNull(Type type);
+    void clear();
+
+  private:
+    void markValidity(bool valid);
+  };
+
+  ArrowFileWriter(QIODevice& device, const QList<Field>& fields);
+
+  bool begin();  // File header and schema
+  bool writeDictionary(qint64 id, const QStringList& values);
+  bool writeRecordBatch(qint64 length, const QList<Column>& columns);
+  bool finish();  // Footer
+
+private:
+  struct Block {
+    qint64 offset = 0;
+    qint32 metadataLength = 0;
+    qint64 bodyLength = 0;
+  };
+
+  QByteArray schemaMessage() const;
+  bool writeMessage(const QByteArray& metadata, const QByteArray& body, QList<Block>* blocks);
+  bool write(const QByteArray& data);
+
+  QIODevice& _device;
+  QList<Field> _fields;
+  QList<Block> _dictionaryBlocks;
+  QList<Block> _recordBatchBlocks;
+  qint64 _position = 0;
+  bool _failed = false;
+};
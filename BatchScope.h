@@ -0,0 +1,20 @@
+#pragma once
+
+// Scoped batch on a BudgetData, Account or CategoryController.
+// Change notifications and derived data (balances, category totals) are deferred and
+// coalesced until the outermost scope on the target closes.
+template <typename T>
+class BatchScope {
+public:
+  explicit BatchScope(T& target) :
+      _target(target) {
+    _target.beginBatch();
+  }
+  ~BatchScope() { _target.endBatch(); }
+
+  BatchScope(const BatchScope&) = delete;
+  BatchScope& operator=(const BatchScope&) = delete;
+
+private:
+  T& _target;
+};
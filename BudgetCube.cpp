@@ -0,0 +1,382 @@
+#include <QSet>
+#include <utility>
+
+#include "Account.h"
+#include "BudgetCube.h"
+#include "BudgetData.h"
+#include "CategoryController.h"
+#include "Operation.h"
+
+BudgetCube::BudgetCube(BudgetData& budgetData, CategoryController& categoryController, QObject* parent) :
+    QAbstractTableModel(parent),
+    _firstMonth(QDate::currentDate().year(), 1, 1),
+    _lastMonth(QDate::currentDate().year(), 12, 1),
+    _budgetData(budgetData),
+    _categoryController(categoryController) {
+  connect(&_budgetData, &BudgetData::accountCountChanged, this, &BudgetCube::syncAccounts);
+  connect(&_budgetData, &BudgetData::modelReset, this, &BudgetCube::syncAccounts);
+
+  // Rows follow the categories, a row follows the history of its category. The row count is
+  // kept apart from the controller so it only changes between the matching begin/end calls.
+  _rowCount = _categoryController.rowCount();
+  connect(&_categoryController, &CategoryController::rowsAboutToBeInserted, this, [this](const QModelIndex&, int first, int last) {
+    beginInsertRows(QModelIndex(), first, last);
+  });
+  connect(&_categoryController, &CategoryController::rowsInserted, this, [this](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      attachCategory(_categoryController.at(row));
+    }
+    _rowCount += last - first + 1;
+    endInsertRows();
+  });
+  connect(&_categoryController, &CategoryController::rowsAboutToBeRemoved, this, [this](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      disconnect(_categoryController.at(row), nullptr, this, nullptr);
+    }
+    beginRemoveRows(QModelIndex(), first, last);
+  });
+  connect(&_categoryController, &CategoryController::rowsRemoved, this, [this](const QModelIndex&, int first, int last) {
+    _rowCount -= last - first + 1;
+    endRemoveRows();
+  });
+
+  syncAccounts();
+}
+
+QDate BudgetCube::firstMonth() const {
+  return _firstMonth;
+}
+
+void BudgetCube::set_firstMonth(QDate value) {
+  value = QDate(value.year(), value.month(), 1);
+  if (_firstMonth != value) {
+    beginResetModel();
+    _firstMonth = value;
+    endResetModel();
+    emit firstMonthChanged();
+  }
+}
+
+QDate BudgetCube::lastMonth() const {
+  return _lastMonth;
+}
+
+void BudgetCube::set_lastMonth(QDate value) {
+  value = QDate(value.year(), value.month(), 1);
+  if (_lastMonth != value) {
+    beginResetModel();
+    _lastMonth = value;
+    endResetModel();
+    emit lastMonthChanged();
+  }
+}
+
+int BudgetCube::rowCount(const QModelIndex& parent) const {
+  if (parent.isValid())
+    return 0;
+  return _rowCount;
+}
+
+int BudgetCube::columnCount(const QModelIndex& parent) const {
+  if (parent.isValid() || !_firstMonth.isValid() || !_lastMonth.isValid())
+    return 0;
+  int months = (_lastMonth.year() - _firstMonth.year()) * 12 + _lastMonth.month() - _firstMonth.month() + 1;
+  return qMax(0, months);
+}
+
+QVariant BudgetCube::data(const QModelIndex& index, int role) const {
+  if (!index.isValid())
+    return QVariant();
+
+  const Category* category = index.row() < _rowCount ? _categoryController.at(index.row()) : nullptr;
+  if (!category || index.column() >= columnCount())
+    return QVariant();
+
+  const QDate month = monthAt(index.column());
+  if (role == Qt::DisplayRole) {
+    role = SpentRole;
+  }
+
+  switch (static_cast<Roles>(role)) {
+    case CategoryRole:
+      return QVariant::fromValue(category);
+    case MonthRole:
+      return month;
+    case SpentRole:
+      return spent(category, month);
+    case BudgetLimitRole:
+      return category->budgetLimitForMonth(month);
+    case SaveAmountRole:
+      return category->monthRecord(month.year(), month.month()).saveAmount.toDouble();
+    case ReportAmountRole:
+      return category->monthRecord(month.year(), month.month()).reportAmount.toDouble();
+    case AccumulatedRole:
+      return category->accumulatedLeftoverBefore(month).toDouble();
+  }
+  return QVariant();
+}
+
+QVariant BudgetCube::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (role != Qt::DisplayRole)
+    return QVariant();
+
+  if (orientation == Qt::Horizontal) {
+    return monthAt(section);
+  }
+  if (const Category* category = section < _rowCount ? _categoryController.at(section) : nullptr) {
+    return category->name();
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> BudgetCube::roleNames() const {
+  return {
+    { CategoryRole, "category" },
+    { MonthRole, "month" },
+    { SpentRole, "spent" },
+    { BudgetLimitRole, "budgetLimit" },
+    { SaveAmountRole, "saveAmount" },
+    { ReportAmountRole, "reportAmount" },
+    { AccumulatedRole, "accumulated" },
+  };
+}
+
+double BudgetCube::spent(const Category* category, const QDate& month) const {
+  return spentMoney(category, month).toDouble();
+}
+
+Money BudgetCube::spentMoney(const Category* category, const QDate& month) const {
+  if (!category)
+    return {};
+  const Money archived = category->monthRecord(month.year(), month.month()).archivedSpent;
+  auto it = _spent.constFind(category);
+  if (it == _spent.cend())
+    return archived;
+  return it->value(YearMonth::fromDate(month)) + archived;
+}
+
+QList<double> BudgetCube::trend(const Category* category, const QDate& from, const QDate& to) const {
+  QList<double> result;
+  const QDate last(to.year(), to.month(), 1);
+  for (QDate month(from.year(), from.month(), 1); month <= last; month = month.addMonths(1)) {
+    result.append(spent(category, month));
+  }
+  return result;
+}
+
+double BudgetCube::yearToDate(const Category* category, const QDate& month) const {
+  return yearToDateMoney(category, month).toDouble();
+}
+
+Money BudgetCube::yearToDateMoney(const Category* category, const QDate& month) const {
+  return spentBetween(category, { month.year(), 1 }, YearMonth::fromDate(month));
+}
+
+double BudgetCube::rollingAverage(const Category* category, const QDate& month, int months) const {
+  return rollingAverageMoney(category, month, months).toDouble();
+}
+
+Money BudgetCube::rollingAverageMoney(const Category* category, const QDate& month, int months) const {
+  if (months <= 0)
+    return {};
+  const YearMonth from = YearMonth::fromDate(month.addMonths(1 - months));
+  const Money total = spentBetween(category, from, YearMonth::fromDate(month));
+  return Money::fromCents(qRound64(double(total.cents()) / months));
+}
+
+void BudgetCube::syncAccounts() {
+  const QList<Account*> accounts = _budgetData.accounts();
+  const QSet<const Account*> present(accounts.cbegin(), accounts.cend());
+
+  // Accounts taken out of the budget (deleted ones are detached on destruction)
+  QList<const Account*> removed;
+  for (auto it = _contributions.cbegin(); it != _contributions.cend(); ++it) {
+    if (!present.contains(it.key())) {
+      removed.append(it.key());
+    }
+  }
+  for (const Account* account : removed) {
+    disconnect(account, nullptr, this, nullptr);
+    for (Operation* operation : _contributions.value(account).keys()) {
+      disconnect(operation, nullptr, this, nullptr);
+    }
+    detachAccount(account);
+  }
+
+  for (Account* account : accounts) {
+    if (!_contributions.contains(account)) {
+      attachAccount(account);
+    }
+  }
+
+  emit spentChanged();
+}
+
+void BudgetCube::attachAccount(Account* account) {
+  _contributions.insert(account, {});
+
+  connect(account, &Account::rowsInserted, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      contribute(account, account->operationAt(row));
+    }
+    emit spentChanged();
+  });
+  // Emitted before the operation leaves the account, so it can still be looked up
+  connect(account, &Account::rowsAboutToBeRemoved, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      Operation* operation = account->operationAt(row);
+      disconnect(operation, nullptr, this, nullptr);
+      withdraw(account, operation);
+    }
+    emit spentChanged();
+  });
+  connect(account, &Account::modelReset, this, [this, account] {
+    syncOperations(account);
+  });
+  connect(account, &QObject::destroyed, this, [this, account] {
+    detachAccount(account);
+    emit spentChanged();
+  });
+
+  for (Operation* operation : account->operations()) {
+    contribute(account, operation);
+  }
+}
+
+void BudgetCube::attachCategory(const Category* category) {
+  if (!category)
+    return;
+
+  // Limits, leftover decisions and archived amounts may change any month of the row
+  auto notifyRow = [this, category] {
+    const int row = _categoryController.categoryIndex(category);
+    if (row >= 0 && row < _rowCount && columnCount() > 0) {
+      emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
+  };
+  connect(category, &Category::budgetLimitChanged, this, notifyRow);
+  connect(category, &Category::monthHistoryChanged, this, notifyRow);
+  connect(category, &Category::nameChanged, this, [this, category] {
+    const int row = _categoryController.categoryIndex(category);
+    if (row >= 0) {
+      emit headerDataChanged(Qt::Vertical, row, row);
+    }
+  });
+}
+
+void BudgetCube::detachAccount(const Account* account) {
+  auto it = _contributions.find(account);
+  if (it == _contributions.end())
+    return;
+
+  for (const QList<Cell>& cells : std::as_const(*it)) {
+    applyCells(cells, -1);
+  }
+  _contributions.erase(it);
+}
+
+void BudgetCube::syncOperations(Account* account) {
+  auto accountIt = _contributions.find(account);
+  if (accountIt == _contributions.end())
+    return;
+
+  // After a reset, drop operations that were deleted with it and pick up new ones
+  const QList<Operation*> operations = account->operations();
+  const QSet<Operation*> present(operations.cbegin(), operations.cend());
+  for (auto it = accountIt->begin(); it != accountIt->end();) {
+    if (present.contains(it.key())) {
+      ++it;
+    } else {
+      applyCells(it.value(), -1);
+      it = accountIt->erase(it);
+    }
+  }
+  for (Operation* operation : operations) {
+    if (!accountIt->contains(operation)) {
+      contribute(account, operation);
+    }
+  }
+  emit spentChanged();
+}
+
+void BudgetCube::contribute(Account* account, Operation* operation) {
+  if (!operation)
+    return;
+
+  const QList<Cell> cells = cellsFor(operation);
+  _contributions[account].insert(operation, cells);
+  applyCells(cells, 1);
+
+  auto update = [this, account, operation] { recontribute(account, operation); };
+  connect(operation, &Operation::allocationsChanged, this, update);
+  connect(operation, &Operation::budgetDateChanged, this, update);
+  connect(operation, &Operation::dateChanged, this, update);  // The budget date defaults to the date
+}
+
+void BudgetCube::withdraw(const Account* account, Operation* operation) {
+  auto accountIt = _contributions.find(account);
+  if (accountIt != _contributions.end()) {
+    applyCells(accountIt->take(operation), -1);
+  }
+}
+
+void BudgetCube::recontribute(Account* account, Operation* operation) {
+  auto accountIt = _contributions.find(account);
+  if (accountIt == _contributions.end() || !accountIt->contains(operation))
+    return;
+
+  QList<Cell>& cells = (*accountIt)[operation];
+  applyCells(cells, -1);
+  cells = cellsFor(operation);
+  applyCells(cells, 1);
+  emit spentChanged();
+}
+
+QList<BudgetCube::Cell> BudgetCube::cellsFor(const Operation* operation) {
+  QList<Cell> cells;
+  const YearMonth month = YearMonth::fromDate(operation->budgetDate());
+  for (const Allocation* allocation : operation->allocations()) {
+    if (allocation->category()) {
+      cells.append({ allocation->category(), month, allocation->amountMoney() });
+    }
+  }
+  return cells;
+}
+
+void BudgetCube::applyCells(const QList<Cell>& cells, int sign) {
+  for (const Cell& cell : cells) {
+    Money& amount = _spent[cell.category][cell.month];
+    amount += sign > 0 ? cell.amount : -cell.amount;
+    emit cellChanged(cell.category, cell.month.year, cell.month.month);
+    notifyCell(cell.category, cell.month);
+  }
+}
+
+void BudgetCube::notifyCell(const Category* category, const YearMonth& month) {
+  const int column = (month.year - _firstMonth.year()) * 12 + month.month - _firstMonth.month();
+  if (column < 0 || column >= columnCount())
+    return;
+  const int row = _categoryController.categoryIndex(category);
+  if (row >= 0 && row < _rowCount) {
+    const QModelIndex cell = index(row, column);
+    emit dataChanged(cell, cell, { Qt::DisplayRole, SpentRole });
+  }
+}
+
+Money BudgetCube::spentBetween(const Category* category, const YearMonth& from, const YearMonth& to) const {
+  if (!category)
+    return {};
+  Money total = category->archivedSpentBetween(from, to);
+  auto it = _spent.constFind(category);
+  if (it == _spent.cend())
+    return total;
+
+  for (auto month = it->lowerBound(from); month != it->cend() && month.key() <= to; ++month) {
+    total += month.value();
+  }
+  return total;
+}
+
+QDate BudgetCube::monthAt(int column) const {
+  return _firstMonth.addMonths(column);
+}
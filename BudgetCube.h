@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QQmlEngine>
+
+#include "Category.h"
+#include "PropertyMacros.h"
+
+class Account;
+class BudgetData;
+class CategoryController;
+class Operation;
+
+// Category x month budget cube.
+// Spent amounts are materialized per (category, month) and kept in sync incrementally
+// from account row changes and operation allocation/date changes, so that per-month
+// queries, trends and yearly sums never rescan operations. Limits, leftover decisions,
+// accumulated reports and the spent amounts of archived operations come from the
+// category month history.
+// As a table model, rows are the categories and columns the months from firstMonth to lastMonth.
+class BudgetCube : public QAbstractTableModel {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by CategoryController")
+
+  PROPERTY_RW_CUSTOM(QDate, firstMonth, {})
+  PROPERTY_RW_CUSTOM(QDate, lastMonth, {})
+
+public:
+  enum Roles {
+    CategoryRole = Qt::UserRole + 1,
+    MonthRole,
+    SpentRole,
+    BudgetLimitRole,
+    SaveAmountRole,
+    ReportAmountRole,
+    AccumulatedRole,
+  };
+  Q_ENUM(Roles)
+
+  BudgetCube(BudgetData& budgetData, CategoryController& categoryController, QObject* parent = nullptr);
+
+  // QAbstractTableModel interface
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+  // Amount allocated to a category during a budget month
+  Q_INVOKABLE double spent(const Category* category, const QDate& month) const;
+  Money spentMoney(const Category* category, const QDate& month) const;
+
+  // Spent amount of each month from `from` to `to` (inclusive)
+  Q_INVOKABLE QList<double> trend(const Category* category, const QDate& from, const QDate& to) const;
+
+  // Spent from January to the given month (inclusive)
+  Q_INVOKABLE double yearToDate(const Category* category, const QDate& month) const;
+  Money yearToDateMoney(const Category* category, const QDate& month) const;
+
+  // Average monthly spent over the `months` months ending with the given month
+  Q_INVOKABLE double rollingAverage(const Category* category, const QDate& month, int months = 12) const;
+  Money rollingAverageMoney(const Category* category, const QDate& month, int months = 12) const;
+
+signals:
+  void spentChanged();  // Emitted whenever an operation moves money between cells
+  void cellChanged(const Category* category, int year, int month);
+
+private:
+  struct Cell {
+    const Category* category = nullptr;
+    YearMonth month;
+    Money amount;
+  };
+
+  void syncAccounts();
+  void attachCategory(const Category* category);
+  void attachAccount(Account* account);
+  void detachAccount(const Account* account);
+  void syncOperations(Account* account);
+  void contribute(Account* account, Operation* operation);
+  void withdraw(const Account* account, Operation* operation);
+  void recontribute(Account* account, Operation* operation);
+  static QList<Cell> cellsFor(const Operation* operation);
+  void applyCells(const QList<Cell>& cells, int sign);
+  void notifyCell(const Category* category, const YearMonth& month);  // Only if the month is shown
+  Money spentBetween(const Category* category, const YearMonth& from, const YearMonth& to) const;
+  QDate monthAt(int column) const;
+
+  BudgetData& _budgetData;
+  CategoryController& _categoryController;
+  int _rowCount = 0;  // Follows the controller rows through its insert/remove signals
+  QHash<const Category*, QMap<YearMonth, Money>> _spent;
+  QHash<const Account*, QHash<Operation*, QList<Cell>>> _contributions;  // What each operation added to _spent
+};
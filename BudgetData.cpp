@@ -6,11 +6,13 @@
 
 #include "Account.h"
 #include "BudgetData.h"
+#include "CsvExporter.h"
 #include "UndoCommands.h"
 
 BudgetData::BudgetData(QUndoStack& undoStack) :
     _budgetDate(QDate::currentDate()),
-    _undoStack(undoStack) {
+    _undoStack(undoStack),
+    _transferMatches(new TransferMatchModel(*this, undoStack, this)) {
 }
 
 BudgetData::~BudgetData() {
@@ -92,12 +94,7 @@ Account* BudgetData::accountAt(int index) const {
 }
 
 Account* BudgetData::accountByName(const QString& name) const {
-  for (Account* account : _accounts) {
-    if (account->name() == name) {
-      return account;
-    }
-  }
-  return nullptr;
+  return _accountsByName.value(name, nullptr);
 }
 
 QString BudgetData::suggestedAccountForUrl(const QUrl& url) const {
@@ -132,12 +129,19 @@ Account* BudgetData::addAccount(Account* account) {
     return nullptr;
   }
   connect(account, &Account::nameChanged, this, [this, account] {
+    rebuildAccountIndex();
     auto index = createIndex(this->accountIndex(account), 0);
     emit dataChanged(index, index);
   });
   beginInsertRows(QModelIndex(), _accounts.size(), _accounts.size());
   account->setParent(this);
+  if (isBatching()) {
+    account->beginBatch();
+  }
   _accounts.append(account);
+  if (!_accountsByName.contains(account->name())) {
+    _accountsByName.insert(account->name(), account);
+  }
   endInsertRows();
   emit accountCountChanged();
   return account;
@@ -146,6 +150,7 @@ Account* BudgetData::addAccount(Account* account) {
 void BudgetData::removeAccount(int index) {
   if (index >= 0 && index < _accounts.size()) {
     delete _accounts.takeAt(index);
+    rebuildAccountIndex();
     emit accountCountChanged();
   }
 }
@@ -164,6 +169,10 @@ Account* BudgetData::takeAccount(Account* account) {
 
     Account* acc = _accounts.takeAt(index);
     acc->setParent(nullptr);  // Release Qt ownership
+    if (isBatching()) {
+      acc->endBatch();  // Flush what was deferred while it was part of the batch
+    }
+    rebuildAccountIndex();
     emit accountCountChanged();
     return acc;
   }
@@ -174,6 +183,7 @@ void BudgetData::clearAccounts() {
   beginResetModel();
   qDeleteAll(_accounts);
   _accounts.clear();
+  _accountsByName.clear();
   endResetModel();
   emit accountCountChanged();
 }
@@ -199,8 +209,8 @@ void BudgetData::setOperationBudgetDate(Operation* operation, const QDate& newBu
 void BudgetData::setOperationAmount(Operation* operation, double newAmount) {
   if (!operation) return;
 
-  double oldAmount = operation->amount();
-  if (!qFuzzyCompare(oldAmount, newAmount)) {
+  Money oldAmount = operation->amountMoney();
+  if (oldAmount != Money(newAmount)) {
     _undoStack.push(new SetOperationAmountCommand(*operation,
                                                   oldAmount, newAmount));
   }
@@ -252,11 +262,11 @@ Operation* BudgetData::createCounterPart(Operation* operation, Account* targetAc
   if (!operation || !targetAccount) return nullptr;
 
   QList<Allocation*> newAllocations;
-  double amount = 0;
+  Money amount;
   for (auto allocation : operation->allocations()) {
     if (categoryName.isEmpty() || (allocation->category() && allocation->category()->name() == categoryName)) {
-      amount -= allocation->amount();
-      newAllocations.append(new Allocation(allocation->category(), -allocation->amount()));
+      amount -= allocation->amountMoney();
+      newAllocations.append(new Allocation(allocation->category(), -allocation->amountMoney()));
     }
   }
 
@@ -271,7 +281,7 @@ void BudgetData::deleteSelectedOperations() {
   Account* account = currentAccount();
   if (!account) return;
 
-  QUndoCommand* macroCommand = new QUndoCommand();
+  QUndoCommand* macroCommand = new BatchCommand(*this);
 
   for (Operation* op : account->selectedOperations()) {
     new DeleteOperationCommand(op, *account, macroCommand);
@@ -279,7 +289,8 @@ void BudgetData::deleteSelectedOperations() {
   _undoStack.push(macroCommand);
 }
 
-int BudgetData::countOperationsWithCategory(const Category* category) const {
+int BudgetData::countOperationsWithCategory(const Category* category) {
+  requireAllAccounts();
   int count = 0;
   for (auto account : _accounts) {
     count += account->countOperationsWithCategory(category);
@@ -287,7 +298,42 @@ int BudgetData::countOperationsWithCategory(const Category* category) const {
   return count;
 }
 
+void BudgetData::requireAllAccounts() {
+  emit allAccountsRequired();
+}
+
+void BudgetData::beginBatch() {
+  if (_batchDepth++ > 0)
+    return;
+
+  for (Account* account : _accounts) {
+    account->beginBatch();
+  }
+  emit batchBegan();
+}
+
+void BudgetData::endBatch() {
+  if (_batchDepth == 0 || --_batchDepth > 0)
+    return;
+
+  for (Account* account : _accounts) {
+    account->endBatch();
+  }
+  emit batchEnded();
+}
+
+void BudgetData::rebuildAccountIndex() {
+  // Accounts are few and renamed or removed rarely, a full rebuild keeps duplicate names right
+  _accountsByName.clear();
+  for (Account* account : _accounts) {
+    if (!_accountsByName.contains(account->name())) {
+      _accountsByName.insert(account->name(), account);
+    }
+  }
+}
+
 void BudgetData::clear() {
+  _transferMatches->clear();
   clearAccounts();
   _undoStack.clear();
   _undoStack.setClean();
@@ -297,7 +343,7 @@ void BudgetData::copySelectedOperations() const {
   Account* account = currentAccount();
   if (!account) return;
 
-  QString csv = account->selectedOperationsAsCsv();
+  QString csv = CsvExporter::operationsText(*account, account->selectedOperations());
   if (!csv.isEmpty()) {
     QGuiApplication::clipboard()->setText(csv);
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QString>
@@ -7,6 +8,7 @@
 #include "Account.h"
 #include "Category.h"
 #include "PropertyMacros.h"
+#include "TransferMatchModel.h"
 
 class BudgetData : public QAbstractListModel {
   Q_OBJECT
@@ -18,6 +20,7 @@ class BudgetData : public QAbstractListModel {
 
   Q_PROPERTY(int accountCount READ rowCount NOTIFY accountCountChanged)
   Q_PROPERTY(int currentAccountIndex READ currentAccountIndex WRITE set_currentAccountIndex NOTIFY currentAccountChanged)
+  Q_PROPERTY(TransferMatchModel* transferMatches READ transferMatches CONSTANT)
 
 public:
   enum Roles {
@@ -64,19 +67,40 @@ public:
   Q_INVOKABLE void setOperationAllocations(Operation* operation, const QList<Allocation*>& allocations);
   Q_INVOKABLE Operation* createCounterPart(Operation* operation, Account* targetAccount, const QString& categoryName);
   Q_INVOKABLE void deleteSelectedOperations();
-  Q_INVOKABLE int countOperationsWithCategory(const Category* category) const;
+  Q_INVOKABLE int countOperationsWithCategory(const Category* category);
+
+  // Transfers between accounts proposed for review
+  TransferMatchModel* transferMatches() { return _transferMatches; }
 
   // Clear all data (called by FileController)
   void clear();
 
+  // Called before scanning the operations of every account: a storage that loads accounts
+  // lazily (see SqliteStorage) reads the ones still on disk
+  void requireAllAccounts();
+
+  // Batching (see BatchScope): every account and the category controller defer and
+  // coalesce their notifications until the outermost endBatch()
+  void beginBatch();
+  void endBatch();
+  bool isBatching() const { return _batchDepth > 0; }
+
   // Copy selected operations to system clipboard as CSV
   Q_INVOKABLE void copySelectedOperations() const;
 
 signals:
   void accountCountChanged();
   void operationDataChanged();  // Emitted when operation data changes (e.g., category edit)
+  void allAccountsRequired();
+  void batchBegan();
+  void batchEnded();
 
 private:
+  void rebuildAccountIndex();
+
   QUndoStack& _undoStack;
   QList<Account*> _accounts;
+  QHash<QString, Account*> _accountsByName;  // First account with each name
+  TransferMatchModel* _transferMatches = nullptr;
+  int _batchDepth = 0;
 };
@@ -0,0 +1,202 @@
+#include <yaml-cpp/yaml.h>
+
+#include <QCryptographicHash>
+#include <QSaveFile>
+
+#include "Account.h"
+#include "BudgetData.h"
+#include "BudgetSnapshot.h"
+#include "CategoryController.h"
+#include "Operation.h"
+#include "OperationYaml.h"
+#include "Rule.h"
+#include "RuleController.h"
+
+// Helper to convert QString to std::string for yaml-cpp
+static std::string toStdString(const QString& s) {
+  return s.toStdString();
+}
+
+OperationSnapshot OperationSnapshot::capture(const Operation& operation) {
+  OperationSnapshot snapshot{ operation.date(), operation.budgetDate(), operation.amountMoney(), operation.label(), {} };
+  snapshot.allocations.reserve(operation.allocations().size());
+  for (const Allocation* allocation : operation.allocations()) {
+    snapshot.allocations.append({ allocation->category() ? allocation->category()->name() : QString(),
+                                  allocation->amountMoney() });
+  }
+  return snapshot;
+}
+
+BudgetSnapshot BudgetSnapshot::capture(const BudgetData& budgetData,
+                                       const CategoryController& categoryController,
+                                       const RuleController& ruleController) {
+  BudgetSnapshot snapshot;
+  snapshot.currentTab = budgetData.currentTabIndex();
+  snapshot.budgetDate = budgetData.budgetDate();
+
+  const Category* currentCategory = categoryController.current();
+  for (const Category* category : categoryController.categories()) {
+    snapshot.categories.append({ category->name(),
+                                 category->budgetLimitMoney(),
+                                 category == currentCategory,
+                                 category->allMonthHistory() });
+  }
+
+  const Account* currentAccount = budgetData.currentAccount();
+  for (const Account* account : budgetData.accounts()) {
+    AccountSnapshot accountSnapshot;
+    accountSnapshot.name = account->name();
+    accountSnapshot.current = account == currentAccount;
+    accountSnapshot.importSourcePrefixes = account->importSourcePrefixes();
+    accountSnapshot.openingBalance = account->openingBalanceMoney();
+    const QList<Operation*> operations = account->operations();
+    accountSnapshot.operations.reserve(operations.size());
+    for (const Operation* op : operations) {
+      if (op == account->currentOperation()) {
+        accountSnapshot.currentOperation = accountSnapshot.operations.size();
+      }
+      accountSnapshot.operations.append(OperationSnapshot::capture(*op));
+    }
+    snapshot.accounts.append(std::move(accountSnapshot));
+  }
+
+  for (const Rule* rule : ruleController.rules()) {
+    snapshot.rules.append({ rule->category() ? rule->category()->name() : QString(),
+                            rule->labelMatch(),
+                            rule->amountFilterMoney(),
+                            rule->matchMode() });
+  }
+  return snapshot;
+}
+
+std::string BudgetSnapshot::toYaml() const {
+  YAML::Emitter out;
+  out << YAML::BeginMap;
+
+  // Write state section
+  out << YAML::Key << "state" << YAML::Value << YAML::BeginMap;
+  out << YAML::Key << "currentTab" << YAML::Value << currentTab;
+  out << YAML::Key << "budgetDate" << YAML::Value << toStdString(budgetDate.toString("MMMM yyyy"));
+  out << YAML::EndMap;
+
+  // Write categories
+  out << YAML::Key << "categories" << YAML::Value << YAML::BeginSeq;
+  for (const CategorySnapshot& category : categories) {
+    out << YAML::BeginMap;
+    out << YAML::Key << "name" << YAML::Value << toStdString(category.name);
+    out << YAML::Key << "budget_limit" << YAML::Value << toStdString(category.budgetLimit.toString());
+    if (category.current) {
+      out << YAML::Key << "current" << YAML::Value << "true";
+    }
+
+    // Write month history (leftover decisions + budget limit overrides)
+    if (!category.monthHistory.isEmpty()) {
+      out << YAML::Key << "month_history" << YAML::Value << YAML::BeginSeq;
+      for (auto it = category.monthHistory.constBegin(); it != category.monthHistory.constEnd(); ++it) {
+        const YearMonth& ym = it.key();
+        const MonthRecord& record = it.value();
+        if (!record.isEmpty()) {
+          out << YAML::BeginMap;
+          out << YAML::Key << "year" << YAML::Value << ym.year;
+          out << YAML::Key << "month" << YAML::Value << ym.month;
+          if (record.budgetLimit.has_value()) {
+            out << YAML::Key << "budget_limit" << YAML::Value << toStdString(record.budgetLimit.value().toString());
+          }
+          if (!record.saveAmount.isZero()) {
+            out << YAML::Key << "save_amount" << YAML::Value << toStdString(record.saveAmount.toString());
+          }
+          if (!record.reportAmount.isZero()) {
+            out << YAML::Key << "report_amount" << YAML::Value << toStdString(record.reportAmount.toString());
+          }
+          if (!record.archivedSpent.isZero()) {
+            out << YAML::Key << "archived_spent" << YAML::Value << toStdString(record.archivedSpent.toString());
+          }
+          out << YAML::EndMap;
+        }
+      }
+      out << YAML::EndSeq;
+    }
+
+    out << YAML::EndMap;
+  }
+  out << YAML::EndSeq;
+
+  // Write accounts
+  out << YAML::Key << "accounts" << YAML::Value << YAML::BeginSeq;
+  for (const AccountSnapshot& account : accounts) {
+    out << YAML::BeginMap;
+    out << YAML::Key << "name" << YAML::Value << toStdString(account.name);
+    if (account.current) {
+      out << YAML::Key << "current" << YAML::Value << "true";
+    }
+
+    // Save import sources (filenames previously imported into this account)
+    if (!account.importSourcePrefixes.isEmpty()) {
+      out << YAML::Key << "import_source_prefixes" << YAML::Value << YAML::BeginSeq;
+      for (const QString& source : account.importSourcePrefixes) {
+        out << toStdString(source);
+      }
+      out << YAML::EndSeq;
+    }
+
+    if (!account.openingBalance.isZero()) {
+      out << YAML::Key << "opening_balance" << YAML::Value << toStdString(account.openingBalance.toString());
+    }
+
+    out << YAML::Key << "operations" << YAML::Value << YAML::BeginSeq;
+    for (int i = 0; i < account.operations.size(); ++i) {
+      OperationYaml::write(out, account.operations[i], i == account.currentOperation);
+    }
+    out << YAML::EndSeq;
+
+    out << YAML::EndMap;
+  }
+  out << YAML::EndSeq;
+
+  // Write categorization rules
+  if (!rules.isEmpty()) {
+    out << YAML::Key << "rules" << YAML::Value << YAML::BeginSeq;
+    for (const RuleSnapshot& rule : rules) {
+      out << YAML::BeginMap;
+      if (!rule.category.isEmpty()) {
+        out << YAML::Key << "category" << YAML::Value << toStdString(rule.category);
+        out << YAML::Key << "label_match" << YAML::Value << toStdString(rule.labelMatch);
+        if (!rule.amountFilter.isZero()) {
+          out << YAML::Key << "amount" << YAML::Value << toStdString(rule.amountFilter.toString());
+        }
+        if (rule.matchMode != Rule::MatchMode::Contains) {
+          out << YAML::Key << "match_mode" << YAML::Value << toStdString(Rule::matchModeName(rule.matchMode));
+        }
+      }
+      out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+  }
+
+  out << YAML::EndMap;
+  return std::string(out.c_str()) + "\n";
+}
+
+bool BudgetSnapshot::save(const QString& filePath, QString& errorMessage, QByteArray* contentHash) const {
+  const std::string content = toYaml();
+
+  // The previous file stays in place until the new one is complete
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    errorMessage = file.errorString();
+    return false;
+  }
+  file.write(content.data(), qint64(content.size()));
+  if (!file.commit()) {
+    errorMessage = file.errorString();
+    return false;
+  }
+  if (contentHash) {
+    *contentHash = hash(QByteArrayView(content.data(), qsizetype(content.size())));
+  }
+  return true;
+}
+
+QByteArray BudgetSnapshot::hash(QByteArrayView content) {
+  return QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <string>
+
+#include "Category.h"
+#include "Money.h"
+#include "Rule.h"
+
+class BudgetData;
+class CategoryController;
+class Operation;
+class RuleController;
+
+struct AllocationSnapshot {
+  QString category;  // Empty when uncategorized
+  Money amount;
+};
+
+struct OperationSnapshot {
+  QDate date;
+  QDate budgetDate;
+  Money amount;
+  QString label;
+  QList<AllocationSnapshot> allocations;
+
+  static OperationSnapshot capture(const Operation& operation);
+};
+
+struct AccountSnapshot {
+  QString name;
+  bool current = false;
+  QStringList importSourcePrefixes;
+  Money openingBalance;
+  QList<OperationSnapshot> operations;
+  int currentOperation = -1;  // Index in operations
+};
+
+struct CategorySnapshot {
+  QString name;
+  Money budgetLimit;
+  bool current = false;
+  QMap<YearMonth, MonthRecord> monthHistory;
+};
+
+struct RuleSnapshot {
+  QString category;  // Empty when the rule has no category
+  QString labelMatch;
+  Money amountFilter;
+  Rule::MatchMode matchMode = Rule::MatchMode::Contains;
+};
+
+// Plain value copy of a budget, which can be serialized away from the GUI thread.
+// Strings and month histories are implicitly shared with the live objects, so taking one
+// costs little more than walking the operations.
+struct BudgetSnapshot {
+  int currentTab = 0;
+  QDate budgetDate;
+  QList<CategorySnapshot> categories;
+  QList<AccountSnapshot> accounts;
+  QList<RuleSnapshot> rules;
+
+  static BudgetSnapshot capture(const BudgetData& budgetData,
+                                const CategoryController& categoryController,
+                                const RuleController& ruleController);
+
+  // Budget file content
+  std::string toYaml() const;
+
+  // Replace the file atomically with the budget file content, whose hash is stored in
+  // contentHash when given
+  bool save(const QString& filePath, QString& errorMessage, QByteArray* contentHash = nullptr) const;
+
+  // Hash telling whether a budget file changed, see FileController
+  static QByteArray hash(QByteArrayView content);
+};
@@ -3,7 +3,7 @@
 Category::Category(QObject* parent) :
     QObject(parent) {}
 
-Category::Category(const QString& name, double budgetLimit, QObject* parent) :
+Category::Category(const QString& name, Money budgetLimit, QObject* parent) :
     QObject(parent), _name(name), _budgetLimit(budgetLimit) {}
 
 // Month history management
@@ -59,8 +59,8 @@ void Category::clearLeftoverDecision(int year, int month) {
   auto it = _monthHistory.find(key);
   if (it != _monthHistory.end()) {
     // Only clear leftover data, preserve budget limit if set
-    it->saveAmount = 0.0;
-    it->reportAmount = 0.0;
+    it->saveAmount = {};
+    it->reportAmount = {};
     if (it->isEmpty()) {
       _monthHistory.erase(it);
     }
@@ -74,6 +74,10 @@ void Category::clearLeftoverDecision(int year, int month) {
 // If found at or after the requested month, return that limit.
 // If no entry found, return the current Category::budgetLimit().
 double Category::budgetLimitForMonth(const QDate& date) const {
+  return budgetLimitMoneyForMonth(date).toDouble();
+}
+
+Money Category::budgetLimitMoneyForMonth(const QDate& date) const {
   YearMonth target = YearMonth::fromDate(date);
 
   // Walk from the requested month forward through month_history
@@ -87,7 +91,7 @@ double Category::budgetLimitForMonth(const QDate& date) const {
   return _budgetLimit;
 }
 
-void Category::setBudgetLimitForMonth(int year, int month, double limit) {
+void Category::setBudgetLimitForMonth(int year, int month, Money limit) {
   YearMonth key{ year, month };
   MonthRecord record = _monthHistory.value(key, MonthRecord{});
   record.budgetLimit = limit;
@@ -107,8 +111,23 @@ void Category::clearBudgetLimitForMonth(int year, int month) {
   }
 }
 
-double Category::accumulatedLeftoverBefore(const QDate& date) const {
-  double total = 0.0;
+void Category::addArchivedSpent(int year, int month, Money amount) {
+  if (amount.isZero())
+    return;
+  _monthHistory[{ year, month }].archivedSpent += amount;
+  emit monthHistoryChanged(year, month);
+}
+
+Money Category::archivedSpentBetween(const YearMonth& from, const YearMonth& to) const {
+  Money total;
+  for (auto it = _monthHistory.lowerBound(from); it != _monthHistory.cend() && it.key() <= to; ++it) {
+    total += it->archivedSpent;
+  }
+  return total;
+}
+
+Money Category::accumulatedLeftoverBefore(const QDate& date) const {
+  Money total;
   for (auto it = _monthHistory.constBegin(); it != _monthHistory.constEnd(); ++it) {
     const YearMonth& ym = it.key();
     // Only count decisions before the specified month
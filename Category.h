@@ -8,6 +8,7 @@
 
 #include <optional>
 
+#include "Money.h"
 #include "PropertyMacros.h"
 
 // Key for storing per-month data by year-month
@@ -24,6 +25,10 @@ struct YearMonth {
     return year == other.year && month == other.month;
   }
 
+  bool operator!=(const YearMonth& other) const {
+    return !(*this == other);
+  }
+
   bool operator<=(const YearMonth& other) const {
     return *this < other || *this == other;
   }
@@ -35,19 +40,20 @@ struct YearMonth {
 
 // Per-month record for a category: leftover decisions and optional budget limit override
 struct MonthRecord {
-  double saveAmount = 0.0;            // Amount transferred to personal savings
-  double reportAmount = 0.0;          // Amount carried forward to next month
-  std::optional<double> budgetLimit;  // Budget limit effective during this month (if changed)
+  Money saveAmount;                  // Amount transferred to personal savings
+  Money reportAmount;                // Amount carried forward to next month
+  std::optional<Money> budgetLimit;  // Budget limit effective during this month (if changed)
+  Money archivedSpent;               // Spent by operations moved to an archive shard
 
   bool isEmpty() const {
-    return saveAmount == 0.0 && reportAmount == 0.0 && !budgetLimit.has_value();
+    return saveAmount.isZero() && reportAmount.isZero() && !budgetLimit.has_value() && archivedSpent.isZero();
   }
 
   bool hasLeftoverData() const {
-    return saveAmount != 0.0 || reportAmount != 0.0;
+    return !saveAmount.isZero() || !reportAmount.isZero();
   }
 
-  double leftoverTotal() const { return saveAmount + reportAmount; }
+  Money leftoverTotal() const { return saveAmount + reportAmount; }
 };
 
 // Legacy alias for backward compatibility in code that only deals with leftover data
@@ -57,11 +63,11 @@ class Category : public QObject {
   Q_OBJECT
   QML_ELEMENT
   PROPERTY_RW(QString, name, QString())
-  PROPERTY_RW(double, budgetLimit, 0.0)
+  PROPERTY_MONEY(budgetLimit, {})
 
 public:
   explicit Category(QObject* parent = nullptr);
-  Category(const QString& name, double budgetLimit = 0.0, QObject* parent = nullptr);
+  Category(const QString& name, Money budgetLimit = {}, QObject* parent = nullptr);
 
   // Month history management (leftover decisions + budget limit overrides)
   MonthRecord monthRecord(int year, int month) const;
@@ -78,16 +84,21 @@ public:
   // Looks up month_history for the effective budget limit at that date.
   // If no historical entry is found, returns the current budgetLimit().
   Q_INVOKABLE double budgetLimitForMonth(const QDate& date) const;
+  Money budgetLimitMoneyForMonth(const QDate& date) const;
 
   // Set a historical budget limit for a specific month
-  void setBudgetLimitForMonth(int year, int month, double limit);
+  void setBudgetLimitForMonth(int year, int month, Money limit);
 
   // Clear a historical budget limit for a specific month (revert to current)
   void clearBudgetLimitForMonth(int year, int month);
 
+  // Spent amounts carried over from archived operations
+  void addArchivedSpent(int year, int month, Money amount);
+  Money archivedSpentBetween(const YearMonth& from, const YearMonth& to) const;
+
   // Calculate accumulated leftover up to (but not including) a specific month
   // This sums all "Report" decisions from previous months
-  double accumulatedLeftoverBefore(const QDate& date) const;
+  Money accumulatedLeftoverBefore(const QDate& date) const;
 
 signals:
   void monthHistoryChanged(int year, int month);
@@ -1,5 +1,6 @@
 #include <QCollator>
 #include <QDate>
+#include <QTimer>
 #include <QtMath>
 #include <algorithm>
 
@@ -10,18 +11,25 @@
 #include "Operation.h"
 #include "UndoCommands.h"
 
-bool isSameMonth(const QDate& d1, const QDate& d2) {
-  return (d1.year() == d2.year()) && (d1.month() == d2.month());
-}
-
 CategoryController::CategoryController(BudgetData& budgetData,
                                        QUndoStack& undoStack) :
     _budgetData(budgetData),
-    _undoStack(undoStack) {
+    _undoStack(undoStack),
+    _archive(new ArchiveStore(*this, this)),
+    _detailModel(new CategoryDetailModel(budgetData, *_archive, this)),
+    _cube(new BudgetCube(budgetData, *this, this)) {
+  connect(_cube, &BudgetCube::cellChanged, this, [this](const Category* category, int year, int month) {
+    _figureCache.invalidate(category, year, month);
+    invalidateSummary();
+  });
+  connect(_cube, &BudgetCube::spentChanged, this, &CategoryController::notifyBudgetDataChanged);
+  connect(&_budgetData, &BudgetData::budgetDateChanged, this, &CategoryController::schedulePrefetch);
   connect(&_budgetData, &BudgetData::operationDataChanged, this, &CategoryController::refresh);
-  connect(&_budgetData, &BudgetData::operationDataChanged, this, &CategoryController::budgetDataChanged);
+  connect(&_budgetData, &BudgetData::operationDataChanged, this, &CategoryController::notifyBudgetDataChanged);
   connect(&_budgetData, &BudgetData::budgetDateChanged, this, &CategoryController::refresh);
-  connect(&_budgetData, &BudgetData::budgetDateChanged, this, &CategoryController::budgetDataChanged);
+  connect(&_budgetData, &BudgetData::budgetDateChanged, this, &CategoryController::notifyBudgetDataChanged);
+  connect(&_budgetData, &BudgetData::batchBegan, this, &CategoryController::beginBatch);
+  connect(&_budgetData, &BudgetData::batchEnded, this, &CategoryController::endBatch);
   connect(this, &CategoryController::budgetDataChanged, this, &CategoryController::refresh);
   connect(this, &CategoryController::monthHistoryChanged, this, &CategoryController::refresh);
 }
@@ -42,16 +50,7 @@ int CategoryController::rowCount(const QModelIndex& parent) const {
 }
 
 int CategoryController::balancedCount() const {
-  int result = 0;
-  int year = _budgetData.budgetDate().year();
-  int month = _budgetData.budgetDate().month();
-  for (const Category* category : _categories) {
-    if (qAbs(category->budgetLimitForMonth(_budgetData.budgetDate()) - spentInCategory(category, _budgetData.budgetDate()) + category->leftoverDecision(year, month).leftoverTotal()) < 0.01) {
-      result++;
-    }
-  }
-
-  return result;
+  return summary().balancedCount();
 }
 
 QVariant CategoryController::data(const QModelIndex& index, int role) const {
@@ -61,25 +60,25 @@ QVariant CategoryController::data(const QModelIndex& index, int role) const {
   const int row = index.row();
 
   if (auto category = at(row)) {
+    if (role == CategoryRole) {
+      return QVariant::fromValue(category);
+    }
+    const CategoryFigures f = figures(category, _budgetData.budgetDate());
     switch (static_cast<Roles>(role)) {
       case CategoryRole:
         return QVariant::fromValue(category);
       case AmountRole:
-        return spentInCategory(category, _budgetData.budgetDate());
+        return f.spent.toDouble();
       case AccumulatedRole:
-        return category->accumulatedLeftoverBefore(_budgetData.budgetDate());
+        return f.accumulated.toDouble();
       case LeftoverRole:
-        return leftoverForCategory(category, _budgetData.budgetDate());
-      case SaveAmountRole: {
-        MonthRecord record = category->monthRecord(_budgetData.budgetDate().year(), _budgetData.budgetDate().month());
-        return record.saveAmount;
-      }
-      case ReportAmountRole: {
-        MonthRecord record = category->monthRecord(_budgetData.budgetDate().year(), _budgetData.budgetDate().month());
-        return record.reportAmount;
-      }
+        return f.leftover.toDouble();
+      case SaveAmountRole:
+        return f.saveAmount.toDouble();
+      case ReportAmountRole:
+        return f.reportAmount.toDouble();
       case BudgetLimitRole:
-        return category->budgetLimitForMonth(_budgetData.budgetDate());
+        return f.budgetLimit.toDouble();
     }
   }
   return QVariant();
@@ -97,61 +96,60 @@ QHash<int, QByteArray> CategoryController::roleNames() const {
   };
 }
 
-double CategoryController::totalIncome() const {
-  double total = 0.0;
-  for (const Category* category : _categories) {
-    double budgetLimit = category->budgetLimitForMonth(_budgetData.budgetDate());
-    if (budgetLimit > 0) {
-      total += budgetLimit;
-    }
+MonthSummary CategoryController::summary() const {
+  const QDate month = _budgetData.budgetDate();
+  if (!_summaryValid || _summaryMonth != YearMonth::fromDate(month)) {
+    _summary = computeSummary(month);
+    _summaryMonth = YearMonth::fromDate(month);
+    _summaryValid = true;
   }
-  return total;
+  return _summary;
 }
 
-double CategoryController::totalExpense() const {
-  double total = 0.0;
+MonthSummary CategoryController::computeSummary(const QDate& month) const {
+  MonthSummary result;
   for (const Category* category : _categories) {
-    double budgetLimit = category->budgetLimitForMonth(_budgetData.budgetDate());
-    if (budgetLimit < 0) {
-      total += -budgetLimit;  // Show expenses as positive
+    const CategoryFigures f = figures(category, month);
+    if (f.budgetLimit > 0) {
+      result.income += f.budgetLimit;
+    } else if (f.budgetLimit < 0) {
+      result.expense -= f.budgetLimit;  // Show expenses as positive
+    }
+    result.toSave += f.saveAmount;
+    if (f.reportAmount > 0) {
+      result.toReport += f.reportAmount;
+    } else if (f.reportAmount < 0) {
+      result.fromReport -= f.reportAmount;
+    }
+    if (f.budgetLimit - f.spent + f.saveAmount + f.reportAmount == Money()) {
+      result.balanced++;
     }
   }
-  return total;
+  return result;
+}
+
+double CategoryController::totalIncome() const {
+  return summary().totalIncome();
+}
+
+double CategoryController::totalExpense() const {
+  return summary().totalExpense();
 }
 
 double CategoryController::totalToSave() const {
-  double total = 0.0;
-  for (const Category* category : _categories) {
-    MonthRecord record = category->monthRecord(_budgetData.budgetDate().year(), _budgetData.budgetDate().month());
-    total += record.saveAmount;
-  }
-  return total;
+  return summary().totalToSave();
 }
 
 double CategoryController::totalToReport() const {
-  double total = 0.0;
-  for (const Category* category : _categories) {
-    MonthRecord record = category->monthRecord(_budgetData.budgetDate().year(), _budgetData.budgetDate().month());
-    if (record.reportAmount > 0) {
-      total += record.reportAmount;
-    }
-  }
-  return total;
+  return summary().totalToReport();
 }
 
 double CategoryController::totalFromReport() const {
-  double total = 0.0;
-  for (const Category* category : _categories) {
-    MonthRecord record = category->monthRecord(_budgetData.budgetDate().year(), _budgetData.budgetDate().month());
-    if (record.reportAmount < 0) {
-      total += -record.reportAmount;
-    }
-  }
-  return total;
+  return summary().totalFromReport();
 }
 
 double CategoryController::netReport() const {
-  return totalToReport() - totalFromReport();
+  return summary().netReport();
 }
 
 QList<Category*> CategoryController::categories() const {
@@ -170,12 +168,15 @@ int CategoryController::categoryIndex(const Category* category) const {
 }
 
 Category* CategoryController::getCategoryByName(const QString& name) const {
-  for (Category* category : _categories) {
-    if (category->name() == name) {
-      return category;
+  // A rename can give two categories the same name: the first in list order wins
+  Category* found = nullptr;
+  const auto range = _categoriesByName.equal_range(name);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (!found || categoryIndex(*it) < categoryIndex(found)) {
+      found = *it;
     }
   }
-  return nullptr;
+  return found;
 }
 
 Allocation* CategoryController::createAllocation(const QString& categoryName, double amount) {
@@ -186,7 +187,7 @@ Allocation* CategoryController::createAllocation(const QString& categoryName, do
 Category* CategoryController::editCategory(const QString& name, double budgetLimit, Category* category, QDate budgetDate) {
   if (category) {
     // Only create undo command if something changed
-    if (category->name() != name || category->budgetLimitForMonth(budgetDate) != budgetLimit) {
+    if (category->name() != name || category->budgetLimitMoneyForMonth(budgetDate) != Money(budgetLimit)) {
       _undoStack.push(new EditCategoryCommand(*category,
                                               name,
                                               budgetLimit,
@@ -205,16 +206,17 @@ void CategoryController::deleteCategory(Category* category) {
   }
   int previousIndex = currentIndex();
 
-  QUndoCommand* macroCommand = new QUndoCommand();
+  QUndoCommand* macroCommand = new BatchCommand(_budgetData);
 
   // Update all operations that reference this category to remove it from their allocations
+  _budgetData.requireAllAccounts();
   for (Account* account : _budgetData.accounts()) {
-    for (Operation* op : account->operations()) {
+    for (Operation* op : account->operationsWithCategory(category)) {
       // Create a new allocations list without the deleted category
       QList<Allocation*> newAllocations;
       for (auto alloc : op->allocations()) {
         if (alloc->category() != category) {
-          newAllocations.append(new Allocation(alloc->category(), alloc->amount()));
+          newAllocations.append(new Allocation(alloc->category(), alloc->amountMoney()));
         }
       }
       // Only create a command if the allocations actually changed
@@ -243,21 +245,39 @@ Category* CategoryController::addCategory(Category* category) {
   }
   category->setParent(this);
 
+  // Drop cached figures first so that the refreshes below recompute them
+  auto invalidate = [this, category] {
+    _figureCache.invalidate(category);
+    invalidateSummary();
+  };
+  connect(category, &Category::budgetLimitChanged, this, invalidate);
+  connect(category, &Category::monthHistoryChanged, this, invalidate);
+
   // Connect category signals so model refreshes when category data changes (e.g., via undo/redo)
   connect(category, &Category::budgetLimitChanged, this, &CategoryController::refresh);
   connect(category, &Category::budgetLimitChanged, this, &CategoryController::budgetDataChanged);
-  connect(category, &Category::monthHistoryChanged, this, &CategoryController::refresh);
+  connect(category, &Category::monthHistoryChanged, this, &CategoryController::notifyBudgetDataChanged);
   connect(category, &Category::nameChanged, this, &CategoryController::refresh);
+  connect(category, &Category::nameChanged, this, [this, category] {
+    // A category taken out (and kept by an undo command) is indexed again when re-added
+    if (_categoryNames.contains(category)) {
+      _archive->categoryRenamed(category, _categoryNames.value(category));
+      unindexCategory(category);
+      indexCategory(category);
+    }
+  });
 
   QCollator collator;
   collator.setCaseSensitivity(Qt::CaseInsensitive);
-  int insertRow = 0;
-  while (insertRow < _categories.size() && collator.compare(_categories[insertRow]->name(), category->name()) < 0) {
-    ++insertRow;
-  }
+  auto it = std::partition_point(_categories.cbegin(), _categories.cend(), [&](const Category* existing) {
+    return collator.compare(existing->name(), category->name()) < 0;
+  });
+  int insertRow = it - _categories.cbegin();
 
   beginInsertRows(QModelIndex(), insertRow, insertRow);
   _categories.insert(insertRow, category);
+  indexCategory(category);
+  invalidateSummary();
   endInsertRows();
   emit countChanged();
   return category;
@@ -268,21 +288,46 @@ void CategoryController::clear() {
   endRemoveRows();
   qDeleteAll(_categories);
   _categories.clear();
+  _categoriesByName.clear();
+  _categoryNames.clear();
+  _figureCache.clear();
+  invalidateSummary();
   emit countChanged();
 }
 
 Category* CategoryController::takeCategoryByName(const QString& name) {
-  for (int index = 0; index < _categories.size(); index++) {
-    if (_categories[index]->name().compare(name, Qt::CaseInsensitive) == 0) {
-      beginRemoveRows(QModelIndex(), index, index);
-      Category* cat = _categories.takeAt(index);
-      cat->setParent(nullptr);  // Release Qt ownership
-      endRemoveRows();
-      emit countChanged();
-      return cat;
+  Category* cat = getCategoryByName(name);
+  if (!cat) {
+    // Fall back to a case-insensitive match
+    for (Category* category : _categories) {
+      if (category->name().compare(name, Qt::CaseInsensitive) == 0) {
+        cat = category;
+        break;
+      }
     }
   }
-  return nullptr;
+  if (!cat) {
+    return nullptr;
+  }
+  int index = _categories.indexOf(cat);
+  beginRemoveRows(QModelIndex(), index, index);
+  _categories.removeAt(index);
+  unindexCategory(cat);
+  _figureCache.invalidate(cat);
+  invalidateSummary();
+  cat->setParent(nullptr);  // Release Qt ownership
+  endRemoveRows();
+  emit countChanged();
+  return cat;
+}
+
+void CategoryController::indexCategory(Category* category) {
+  _categoriesByName.insert(category->name(), category);
+  _categoryNames.insert(category, category->name());
+}
+
+void CategoryController::unindexCategory(Category* category) {
+  _categoriesByName.remove(_categoryNames.take(category), category);
 }
 
 QStringList CategoryController::categoryNames() const {
@@ -294,54 +339,39 @@ QStringList CategoryController::categoryNames() const {
 }
 
 double CategoryController::spentInCategory(const Category* category, const QDate& budgetDate) const {
-  double total = 0.0;
-  for (const Account* account : _budgetData.accounts()) {
-    for (const Operation* op : account->operations()) {
-      if (isSameMonth(op->budgetDate(), budgetDate)) {
-        // Use amountForCategory which handles both split and non-split operations
-        total += op->amountForCategory(category);
-      }
-    }
-  }
-  return total;
-}
-
-QVariantList CategoryController::operationsForCategory(const Category* category, const QDate& date) const {
-  QVariantList result;
-  for (const Account* account : _budgetData.accounts()) {
-    for (const Operation* op : account->operations()) {
-      if (isSameMonth(op->budgetDate(), date)) {
-        // Check if this operation contributes to this category
-        double categoryAmount = op->amountForCategory(category);
-        if (!qFuzzyIsNull(categoryAmount)) {
-          QVariantMap item;
-          item["operation"] = QVariant::fromValue(op);
-          item["date"] = op->date();
-          item["budgetDate"] = op->budgetDate();
-          item["label"] = op->label();
-          item["amount"] = categoryAmount;     // Show only the amount for this category
-          item["totalAmount"] = op->amount();  // Total operation amount
-          item["isCategorized"] = op->isCategorized();
-          item["accountName"] = account->name();
-          result.append(item);
-        }
-      }
-    }
-  }
-
-  // Sort by date (most recent first)
-  std::sort(result.begin(), result.end(), [](const QVariant& a, const QVariant& b) {
-    return a.toMap()["date"].toDate() > b.toMap()["date"].toDate();
-  });
+  return spentMoneyInCategory(category, budgetDate).toDouble();
+}
 
-  return result;
+Money CategoryController::spentMoneyInCategory(const Category* category, const QDate& budgetDate) const {
+  return _cube->spentMoney(category, budgetDate);
 }
 
 double CategoryController::leftoverForCategory(const Category* category, const QDate& date) const {
   if (!category) return 0.0;
+  return figures(category, date).leftover.toDouble();
+}
+
+CategoryFigures CategoryController::figures(const Category* category, const QDate& month) const {
+  if (!category) return {};
+  if (const CategoryFigures* cached = _figureCache.find(category, month)) {
+    return *cached;
+  }
+  CategoryFigures result = computeFigures(category, month);
+  _figureCache.insert(category, month, result);
+  return result;
+}
+
+CategoryFigures CategoryController::computeFigures(const Category* category, const QDate& month) const {
+  CategoryFigures result;
+  result.spent = spentMoneyInCategory(category, month);
+  result.budgetLimit = category->budgetLimitMoneyForMonth(month);
+  result.accumulated = category->accumulatedLeftoverBefore(month);
+  MonthRecord record = category->monthRecord(month.year(), month.month());
+  result.saveAmount = record.saveAmount;
+  result.reportAmount = record.reportAmount;
 
-  double budgetLimit = category->budgetLimitForMonth(date);
-  double spent = spentInCategory(category, date);
+  Money budgetLimit = result.budgetLimit;
+  Money spent = result.spent;
 
   // For expense categories (negative budget limit):
   // leftover = |budgetLimit| - |spent|
@@ -352,18 +382,37 @@ double CategoryController::leftoverForCategory(const Category* category, const Q
   if (isIncome) {
     // Income: positive spent means income received
     // leftover = actual income - expected income
-    return spent - budgetLimit;
+    result.leftover = spent - budgetLimit;
   } else {
     // Expense: negative spent means money spent
     // leftover = budget - spent = -budgetLimit - (-spent)
-    return -budgetLimit + spent;
+    result.leftover = -budgetLimit + spent;
+  }
+  return result;
+}
+
+void CategoryController::schedulePrefetch() {
+  if (_prefetchScheduled)
+    return;
+  // Let the current month render first, then warm up its neighbours
+  _prefetchScheduled = true;
+  QTimer::singleShot(0, this, &CategoryController::prefetchAdjacentMonths);
+}
+
+void CategoryController::prefetchAdjacentMonths() {
+  _prefetchScheduled = false;
+  const QDate current = _budgetData.budgetDate();
+  for (const QDate& month : { current.addMonths(-1), current.addMonths(1) }) {
+    for (const Category* category : _categories) {
+      figures(category, month);
+    }
   }
 }
 
 double CategoryController::accumulatedLeftover(const QString& categoryName, const QDate& date) const {
   Category* category = getCategoryByName(categoryName);
   if (!category) return 0.0;
-  return category->accumulatedLeftoverBefore(date);
+  return category->accumulatedLeftoverBefore(date).toDouble();
 }
 
 void CategoryController::setSaveAmount(Category* category, const QDate& date, double saveAmount) {
@@ -374,7 +423,7 @@ void CategoryController::setSaveAmount(Category* category, const QDate& date, do
   newRecord.saveAmount = saveAmount;
 
   // Only create undo command if something changed
-  if (!qFuzzyCompare(oldRecord.saveAmount, newRecord.saveAmount)) {
+  if (oldRecord.saveAmount != newRecord.saveAmount) {
     _undoStack.push(new SetLeftoverDecisionCommand(*category, this, date, oldRecord, newRecord));
   }
 }
@@ -389,12 +438,43 @@ void CategoryController::setReportAmount(Category* category,
   newRecord.reportAmount = reportAmount;
 
   // Only create undo command if something changed
-  if (!qFuzzyCompare(oldRecord.saveAmount, newRecord.saveAmount) || !qFuzzyCompare(oldRecord.reportAmount, newRecord.reportAmount)) {
+  if (oldRecord.saveAmount != newRecord.saveAmount || oldRecord.reportAmount != newRecord.reportAmount) {
     _undoStack.push(new SetLeftoverDecisionCommand(*category, this, date, oldRecord, newRecord));
   }
 }
 
+void CategoryController::beginBatch() {
+  _batchDepth++;
+}
+
+void CategoryController::endBatch() {
+  if (_batchDepth == 0 || --_batchDepth > 0)
+    return;
+
+  if (_budgetDataChangedPending) {
+    // budgetDataChanged refreshes the model as well
+    _budgetDataChangedPending = false;
+    _refreshPending = false;
+    emit budgetDataChanged();
+  } else if (_refreshPending) {
+    _refreshPending = false;
+    refresh();
+  }
+}
+
+void CategoryController::notifyBudgetDataChanged() {
+  if (isBatching()) {
+    _budgetDataChangedPending = true;
+  } else {
+    emit budgetDataChanged();
+  }
+}
+
 void CategoryController::refresh() {
+  if (isBatching()) {
+    _refreshPending = true;
+    return;
+  }
   emit dataChanged(
       index(0, 0),
       index(rowCount() - 1, 0));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QString>
@@ -8,7 +9,12 @@
 #include <QUndoStack>
 #include <QVariant>
 
+#include "ArchiveStore.h"
+#include "BudgetCube.h"
 #include "Category.h"
+#include "CategoryDetailModel.h"
+#include "MonthFiguresCache.h"
+#include "MonthSummary.h"
 #include "PropertyMacros.h"
 
 class Account;
@@ -29,6 +35,10 @@ class CategoryController : public QAbstractListModel {
   Q_PROPERTY(double totalToReport READ totalToReport NOTIFY budgetDataChanged)
   Q_PROPERTY(double totalFromReport READ totalFromReport NOTIFY budgetDataChanged)
   Q_PROPERTY(double netReport READ netReport NOTIFY budgetDataChanged)
+  Q_PROPERTY(MonthSummary summary READ summary NOTIFY budgetDataChanged)
+  Q_PROPERTY(CategoryDetailModel* detailModel READ detailModel CONSTANT)
+  Q_PROPERTY(ArchiveStore* archive READ archive CONSTANT)
+  Q_PROPERTY(BudgetCube* cube READ cube CONSTANT)
 
 public:
   enum Roles {
@@ -54,7 +64,10 @@ public:
   QVariant data(const QModelIndex& index, int role) const override;
   QHash<int, QByteArray> roleNames() const override;
 
-  // Totals accessors
+  // Totals of the budget month, computed once per change
+  MonthSummary summary() const;
+
+  // Totals accessors (read from summary())
   double totalIncome() const;
   double totalExpense() const;
   double totalToSave() const;
@@ -79,7 +92,19 @@ public:
 
   // Budget calculations (aggregates across all accounts)
   Q_INVOKABLE double spentInCategory(const Category* categoryName, const QDate& budgetDate) const;
-  Q_INVOKABLE QVariantList operationsForCategory(const Category* category, const QDate& date) const;
+  Money spentMoneyInCategory(const Category* category, const QDate& budgetDate) const;
+
+  // Operations of a category for one month, filled on demand by the detail view
+  CategoryDetailModel* detailModel() { return _detailModel; }
+
+  // Archived years of the current budget file, read on demand by the detail view
+  ArchiveStore* archive() { return _archive; }
+
+  // Spent per category and month, with trends and yearly sums
+  BudgetCube* cube() { return _cube; }
+
+  // All figures of a category for a month, served from a small cache of recent months
+  CategoryFigures figures(const Category* category, const QDate& month) const;
 
   // Leftover calculations
   // Calculate the leftover for a category in a month: budget - spent
@@ -91,6 +116,12 @@ public:
   Q_INVOKABLE void setSaveAmount(Category* category, const QDate& date, double saveAmount);
   Q_INVOKABLE void setReportAmount(Category* category, const QDate& date, double reportAmount);
 
+  // Batching (see BatchScope): refreshes and budgetDataChanged are coalesced until the outermost endBatch()
+  void beginBatch();
+  void endBatch();
+  bool isBatching() const { return _batchDepth > 0; }
+  void notifyBudgetDataChanged();
+
 public slots:
   void refresh();
 
@@ -100,7 +131,28 @@ signals:
   void monthHistoryChanged();
 
 private:
+  CategoryFigures computeFigures(const Category* category, const QDate& month) const;
+  MonthSummary computeSummary(const QDate& month) const;
+  void invalidateSummary() { _summaryValid = false; }
+  void indexCategory(Category* category);
+  void unindexCategory(Category* category);
+  void schedulePrefetch();
+  void prefetchAdjacentMonths();
+
   QList<Category*> _categories;
+  QMultiHash<QString, Category*> _categoriesByName;  // Name index, kept in sync on add, take and rename
+  QHash<const Category*, QString> _categoryNames;    // Name each category is indexed with, until it changes
   BudgetData& _budgetData;
   QUndoStack& _undoStack;
+  ArchiveStore* _archive = nullptr;
+  CategoryDetailModel* _detailModel = nullptr;
+  BudgetCube* _cube = nullptr;
+  mutable MonthFiguresCache _figureCache;
+  bool _prefetchScheduled = false;
+  mutable MonthSummary _summary;
+  mutable YearMonth _summaryMonth;
+  mutable bool _summaryValid = false;
+  int _batchDepth = 0;
+  bool _refreshPending = false;
+  bool _budgetDataChangedPending = false;
 };
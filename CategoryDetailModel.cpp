@@ -0,0 +1,135 @@
+#include <algorithm>
+
+#include "Account.h"
+#include "ArchiveStore.h"
+#include "BudgetData.h"
+#include "CategoryDetailModel.h"
+#include "Operation.h"
+
+CategoryDetailModel::CategoryDetailModel(BudgetData& budgetData, ArchiveStore& archive, QObject* parent) :
+    QAbstractListModel(parent),
+    _budgetData(budgetData),
+    _archive(archive) {
+}
+
+int CategoryDetailModel::rowCount(const QModelIndex& parent) const {
+  if (parent.isValid())
+    return 0;
+  return _rows.size();
+}
+
+QVariant CategoryDetailModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= _rows.size()) {
+    return QVariant();
+  }
+
+  const Row& row = _rows[index.row()];
+  const Operation* op = row.operation;
+
+  switch (static_cast<Roles>(role)) {
+    case OperationRole:
+      return QVariant::fromValue(row.operation);
+    case DateRole:
+      return op->date();
+    case BudgetDateRole:
+      return op->budgetDate();
+    case LabelRole:
+      return op->label();
+    case AmountRole:
+      return row.amount.toDouble();
+    case TotalAmountRole:
+      return op->amount();
+    case IsCategorizedRole:
+      return op->isCategorized();
+    case AccountNameRole:
+      return row.account->name();
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> CategoryDetailModel::roleNames() const {
+  return {
+    { OperationRole, "operation" },
+    { DateRole, "date" },
+    { BudgetDateRole, "budgetDate" },
+    { LabelRole, "label" },
+    { AmountRole, "amount" },
+    { TotalAmountRole, "totalAmount" },
+    { IsCategorizedRole, "isCategorized" },
+    { AccountNameRole, "accountName" },
+  };
+}
+
+double CategoryDetailModel::totalAmount() const {
+  return _totalAmount.toDouble();
+}
+
+Money CategoryDetailModel::totalAmountMoney() const {
+  return _totalAmount;
+}
+
+Operation* CategoryDetailModel::operationAt(int index) const {
+  if (index >= 0 && index < _rows.size()) {
+    return _rows[index].operation;
+  }
+  return nullptr;
+}
+
+void CategoryDetailModel::load(const Category* category, const QDate& date) {
+  QList<Row> rows;
+  auto collect = [&](const Account* account) {
+    // Only the operations allocated to this category are visited
+    for (Operation* op : account->operationsWithCategory(category)) {
+      const QDate budgetDate = op->budgetDate();
+      if (budgetDate.year() != date.year() || budgetDate.month() != date.month()) {
+        continue;
+      }
+      Money amount = op->amountMoneyForCategory(category);
+      if (!amount.isZero()) {
+        rows.append({ op, account, amount });
+      }
+    }
+  };
+  if (category) {
+    _budgetData.requireAllAccounts();
+    for (const Account* account : _budgetData.accounts()) {
+      collect(account);
+    }
+    if (_archive.contains(date.year())) {
+      for (const Account* account : _archive.accounts(date.year())) {
+        collect(account);
+      }
+    }
+  }
+
+  // Most recent first
+  std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+    return a.operation->date() > b.operation->date();
+  });
+
+  setRows(rows);
+}
+
+void CategoryDetailModel::clear() {
+  setRows({});
+}
+
+void CategoryDetailModel::setRows(QList<Row> rows) {
+  const int previousCount = _rows.size();
+  const Money previousTotal = _totalAmount;
+
+  beginResetModel();
+  _rows = std::move(rows);
+  _totalAmount = {};
+  for (const Row& row : _rows) {
+    _totalAmount += row.amount;
+  }
+  endResetModel();
+
+  if (_rows.size() != previousCount) {
+    emit countChanged();
+  }
+  if (_totalAmount != previousTotal) {
+    emit totalAmountChanged();
+  }
+}
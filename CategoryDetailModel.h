@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDate>
+#include <QList>
+#include <QObject>
+#include <QQmlEngine>
+
+#include "Money.h"
+
+class Account;
+class ArchiveStore;
+class BudgetData;
+class Category;
+class Operation;
+
+// Operations contributing to one category in one month, most recent first.
+// Months of an archived year are read from the archive shard.
+class CategoryDetailModel : public QAbstractListModel {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by CategoryController")
+
+  Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+  Q_PROPERTY(double totalAmount READ totalAmount NOTIFY totalAmountChanged)
+
+public:
+  enum Roles {
+    OperationRole = Qt::UserRole + 1,
+    DateRole,
+    BudgetDateRole,
+    LabelRole,
+    AmountRole,  // Amount allocated to the category
+    TotalAmountRole,
+    IsCategorizedRole,
+    AccountNameRole,
+  };
+  Q_ENUM(Roles)
+
+  CategoryDetailModel(BudgetData& budgetData, ArchiveStore& archive, QObject* parent = nullptr);
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+  double totalAmount() const;
+  Money totalAmountMoney() const;
+  Operation* operationAt(int index) const;
+
+  Q_INVOKABLE void load(const Category* category, const QDate& date);
+  Q_INVOKABLE void clear();
+
+signals:
+  void countChanged();
+  void totalAmountChanged();
+
+private:
+  struct Row {
+    Operation* operation = nullptr;
+    const Account* account = nullptr;
+    Money amount;
+  };
+
+  void setRows(QList<Row> rows);
+
+  BudgetData& _budgetData;
+  ArchiveStore& _archive;
+  QList<Row> _rows;
+  Money _totalAmount;
+};
@@ -0,0 +1,243 @@
+#include <QUndoStack>
+#include <algorithm>
+
+#include "Account.h"
+#include "BudgetData.h"
+#include "Category.h"
+#include "CategorySuggester.h"
+#include "Operation.h"
+#include "UndoCommands.h"
+
+CategorySuggester::CategorySuggester(BudgetData& budgetData, QUndoStack& undoStack, QObject* parent) :
+    QObject(parent),
+    _budgetData(budgetData),
+    _undoStack(undoStack) {
+  connect(&_budgetData, &BudgetData::accountCountChanged, this, &CategorySuggester::synchronize);
+  connect(&_budgetData, &BudgetData::modelReset, this, &CategorySuggester::synchronize);
+  synchronize();
+}
+
+QStringList CategorySuggester::tokens(const QString& label) {
+  QStringList result;
+  QString token;
+  auto flush = [&] {
+    if (token.size() >= 2 && !result.contains(token)) {
+      result.append(token);
+    }
+    token.clear();
+  };
+  for (QChar c : label) {
+    if (c.isLetter()) {
+      token.append(c.toLower());
+    } else {
+      flush();
+    }
+  }
+  flush();
+  return result;
+}
+
+QList<CategorySuggester::Suggestion> CategorySuggester::suggestions(const QString& label, int limit) const {
+  // Each known token votes for its categories in proportion to how often it was seen with them
+  QHash<const Category*, double> scores;
+  int knownTokenCount = 0;
+  for (const QString& token : tokens(label)) {
+    auto it = _tokens.constFind(token);
+    if (it == _tokens.cend())
+      continue;
+    knownTokenCount++;
+    for (auto category = it->categories.cbegin(); category != it->categories.cend(); ++category) {
+      scores[category.key()] += double(category.value()) / it->operationCount;
+    }
+  }
+
+  QList<Suggestion> result;
+  for (auto it = scores.cbegin(); it != scores.cend(); ++it) {
+    result.append({ it.key(), it.value() / knownTokenCount });
+  }
+  std::sort(result.begin(), result.end(), [](const Suggestion& a, const Suggestion& b) {
+    if (a.confidence != b.confidence)
+      return a.confidence > b.confidence;
+    return a.category->name() < b.category->name();
+  });
+  if (limit >= 0 && result.size() > limit) {
+    result.resize(limit);
+  }
+  return result;
+}
+
+QStringList CategorySuggester::suggestedCategoryNames(const QString& label, int limit) const {
+  QStringList names;
+  for (const Suggestion& suggestion : suggestions(label, limit)) {
+    names.append(suggestion.category->name());
+  }
+  return names;
+}
+
+int CategorySuggester::acceptTopSuggestions(double minimumConfidence) {
+  _budgetData.requireAllAccounts();
+
+  // Suggestions are all computed first, the commands then update the index
+  QUndoCommand* macroCommand = new BatchCommand(_budgetData);
+  QHash<QString, const Category*> topCategories;  // Per label, operations often share one
+  int count = 0;
+  for (Account* account : _budgetData.accounts()) {
+    for (Operation* operation : account->operations()) {
+      if (!operation->allocations().isEmpty() || operation->amountMoney().isZero())
+        continue;
+
+      auto it = topCategories.constFind(operation->label());
+      if (it == topCategories.cend()) {
+        const QList<Suggestion> best = suggestions(operation->label(), 1);
+        it = topCategories.insert(operation->label(),
+                                  !best.isEmpty() && best.first().confidence >= minimumConfidence ? best.first().category : nullptr);
+      }
+      if (!*it)
+        continue;
+
+      new SplitOperationCommand(*operation, { new Allocation(*it, operation->amountMoney()) }, macroCommand);
+      count++;
+    }
+  }
+
+  if (count > 0) {
+    macroCommand->setText(tr("Categorize %n operation(s) from suggestions", "", count));
+    _undoStack.push(macroCommand);
+  } else {
+    delete macroCommand;
+  }
+  return count;
+}
+
+void CategorySuggester::synchronize() {
+  const QList<Account*> accounts = _budgetData.accounts();
+  for (Account* account : accounts) {
+    watchAccount(account);
+  }
+
+  // Forget accounts taken out of the budget, and operations no longer in a watched account
+  const QSet<Account*> liveAccounts(accounts.cbegin(), accounts.cend());
+  for (auto it = _accounts.begin(); it != _accounts.end();) {
+    if (liveAccounts.contains(*it)) {
+      ++it;
+      continue;
+    }
+    disconnect(*it, nullptr, this, nullptr);
+    it = _accounts.erase(it);
+  }
+  QSet<const Operation*> liveOperations;
+  for (const Account* account : accounts) {
+    for (const Operation* operation : account->operations()) {
+      liveOperations.insert(operation);
+    }
+  }
+  QList<Operation*> staleOperations;
+  for (auto it = _contributions.cbegin(); it != _contributions.cend(); ++it) {
+    if (!liveOperations.contains(it.key())) {
+      staleOperations.append(const_cast<Operation*>(it.key()));
+    }
+  }
+  for (Operation* operation : std::as_const(staleOperations)) {
+    unwatchOperation(operation);
+  }
+}
+
+void CategorySuggester::watchAccount(Account* account) {
+  if (_accounts.contains(account))
+    return;
+  _accounts.insert(account);
+
+  connect(account, &QObject::destroyed, this, [this, account] {
+    _accounts.remove(account);
+  });
+  connect(account, &Account::rowsInserted, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      watchOperation(account->operationAt(row));
+    }
+  });
+  connect(account, &Account::rowsAboutToBeRemoved, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      unwatchOperation(account->operationAt(row));
+    }
+  });
+  // Operations may be deleted or replaced during a reset
+  connect(account, &Account::modelAboutToBeReset, this, [this, account] {
+    for (Operation* operation : account->operations()) {
+      unwatchOperation(operation);
+    }
+  });
+  connect(account, &Account::modelReset, this, [this, account] {
+    for (Operation* operation : account->operations()) {
+      watchOperation(operation);
+    }
+  });
+
+  for (Operation* operation : account->operations()) {
+    watchOperation(operation);
+  }
+}
+
+void CategorySuggester::watchOperation(Operation* operation) {
+  if (!operation || _contributions.contains(operation))
+    return;
+  index(operation);
+
+  auto reindex = [this, operation] {
+    unindex(operation);
+    index(operation);
+  };
+  connect(operation, &Operation::allocationsChanged, this, reindex);
+  connect(operation, &Operation::labelChanged, this, reindex);
+  connect(operation, &QObject::destroyed, this, [this, operation] {
+    unindex(operation);
+  });
+}
+
+void CategorySuggester::unwatchOperation(Operation* operation) {
+  if (!operation || !_contributions.contains(operation))
+    return;
+  unindex(operation);
+  disconnect(operation, nullptr, this, nullptr);
+}
+
+void CategorySuggester::index(Operation* operation) {
+  Contribution& contribution = _contributions[operation];
+  for (const Allocation* allocation : operation->allocations()) {
+    if (allocation->category() && !contribution.categories.contains(allocation->category())) {
+      contribution.categories.append(allocation->category());
+    }
+  }
+  if (contribution.categories.isEmpty())
+    return;  // Watched, but uncategorized operations teach nothing
+
+  contribution.tokens = tokens(operation->label());
+  for (const QString& token : std::as_const(contribution.tokens)) {
+    TokenCounts& counts = _tokens[token];
+    counts.operationCount++;
+    for (const Category* category : std::as_const(contribution.categories)) {
+      counts.categories[category]++;
+    }
+  }
+}
+
+void CategorySuggester::unindex(const Operation* operation) {
+  auto it = _contributions.find(operation);
+  if (it == _contributions.end())
+    return;
+
+  for (const QString& token : std::as_const(it->tokens)) {
+    auto counts = _tokens.find(token);
+    if (counts == _tokens.end())
+      continue;
+    for (const Category* category : std::as_const(it->categories)) {
+      auto categoryCount = counts->categories.find(category);
+      if (categoryCount != counts->categories.end() && --*categoryCount == 0) {
+        counts->categories.erase(categoryCount);
+      }
+    }
+    if (--counts->operationCount == 0) {
+      _tokens.erase(counts);
+    }
+  }
+  _contributions.erase(it);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QQmlEngine>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class Account;
+class BudgetData;
+class Category;
+class Operation;
+class QUndoStack;
+
+// Suggests categories for an operation from the categories of past operations sharing words
+// of its label. The index maps each label token to the categories of the operations carrying
+// it, and is kept up to date as operations are added, removed, relabeled or recategorized.
+class CategorySuggester : public QObject {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by RuleController")
+
+public:
+  static constexpr double DefaultMinimumConfidence = 0.5;
+
+  struct Suggestion {
+    const Category* category = nullptr;
+    double confidence = 0;  // Between 0 and 1
+  };
+
+  CategorySuggester(BudgetData& budgetData, QUndoStack& undoStack, QObject* parent = nullptr);
+
+  // Lowercase words of at least two letters, each once; digits and punctuation separate words
+  static QStringList tokens(const QString& label);
+
+  // Best categories first, in O(tokens of the label)
+  QList<Suggestion> suggestions(const QString& label, int limit = 3) const;
+  Q_INVOKABLE QStringList suggestedCategoryNames(const QString& label, int limit = 3) const;
+
+  // Categorize every uncategorized operation with its top suggestion, in one undo step.
+  // Returns the number of operations categorized.
+  Q_INVOKABLE int acceptTopSuggestions(double minimumConfidence = DefaultMinimumConfidence);
+
+private:
+  // What an operation added to the index, to remove exactly that
+  struct Contribution {
+    QStringList tokens;
+    QList<const Category*> categories;
+  };
+
+  struct TokenCounts {
+    int operationCount = 0;                    // Categorized operations with the token
+    QHash<const Category*, int> categories;  // Operations with the token, per category
+  };
+
+  void synchronize();  // Follow the accounts of the budget
+  void watchAccount(Account* account);
+  void watchOperation(Operation* operation);
+  void unwatchOperation(Operation* operation);
+  void index(Operation* operation);
+  void unindex(const Operation* operation);
+
+  BudgetData& _budgetData;
+  QUndoStack& _undoStack;
+  QSet<Account*> _accounts;
+  QHash<const Operation*, Contribution> _contributions;  // Every watched operation
+  QHash<QString, TokenCounts> _tokens;
+};
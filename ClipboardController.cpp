@@ -2,6 +2,7 @@
 #include <QGuiApplication>
 
 #include "Account.h"
+#include "CsvExporter.h"
 #include "ClipboardController.h"
 
 ClipboardController2::ClipboardController2(Account& account) :
@@ -9,7 +10,7 @@ ClipboardController2::ClipboardController2(Account& account) :
 }
 
 void ClipboardController2::copySelectedOperations() const {
-  QString csv = _account.selectedOperationsAsCsv();
+  QString csv = CsvExporter::operationsText(_account, _account.selectedOperations());
   if (!csv.isEmpty()) {
     QGuiApplication::clipboard()->setText(csv);
   }
@@ -0,0 +1,244 @@
+#include <QBuffer>
+#include <QIODevice>
+
+#include "Account.h"
+#include "CategoryController.h"
+#include "CsvExporter.h"
+#include "Operation.h"
+
+CsvExporter::CsvExporter(QIODevice& device, Format format) :
+    _device(device),
+    _separator(format == Format::Tsv ? QLatin1Char('\t') : QLatin1Char(',')),
+    _columns(defaultColumns()) {
+  _buffer.reserve(ChunkSize + 1024);
+}
+
+CsvExporter::~CsvExporter() {
+  flush();
+}
+
+CsvExporter::Format CsvExporter::formatForFile(const QString& filePath) {
+  if (filePath.endsWith(".tsv", Qt::CaseInsensitive) || filePath.endsWith(".tab", Qt::CaseInsensitive))
+    return Format::Tsv;
+  return Format::Csv;
+}
+
+QList<CsvExporter::Column> CsvExporter::defaultColumns() {
+  return { Column::Date, Column::Label, Column::Amount, Column::Category };
+}
+
+QString CsvExporter::operationsText(const Account& account, const QList<Operation*>& operations, Format format) {
+  if (operations.isEmpty())
+    return QString();
+
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  {
+    CsvExporter exporter(buffer, format);
+    exporter.writeHeader();
+    exporter.writeOperations(account, operations);
+  }
+  return QString::fromUtf8(data);
+}
+
+void CsvExporter::setColumns(const QList<Column>& columns) {
+  _columns = columns.isEmpty() ? defaultColumns() : columns;
+}
+
+bool CsvExporter::writeHeader() {
+  for (Column column : std::as_const(_columns)) {
+    switch (column) {
+      case Column::Account:
+        appendField(QStringLiteral("Account"));
+        break;
+      case Column::Date:
+        appendField(QStringLiteral("Date"));
+        break;
+      case Column::BudgetDate:
+        appendField(QStringLiteral("Budget date"));
+        break;
+      case Column::Label:
+        appendField(QStringLiteral("Label"));
+        break;
+      case Column::Details:
+        appendField(QStringLiteral("Details"));
+        break;
+      case Column::Amount:
+        appendField(QStringLiteral("Amount"));
+        break;
+      case Column::Category:
+        appendField(QStringLiteral("Category"));
+        break;
+      case Column::Balance:
+        appendField(QStringLiteral("Balance"));
+        break;
+    }
+  }
+  endRow();
+  return flushIfFull();
+}
+
+bool CsvExporter::writeOperations(const Account& account, const QList<Operation*>& operations) {
+  for (Operation* op : operations) {
+    writeOperation(account, *op, Money(account.balanceAt(account.operationIndex(op))));
+    if (!flushIfFull())
+      return false;
+  }
+  return !_failed;
+}
+
+bool CsvExporter::writeAccount(const Account& account) {
+  const QList<Operation*> operations = account.operations();
+  for (int row = 0; row < operations.size(); ++row) {
+    writeOperation(account, *operations[row], Money(account.balanceAt(row)));
+    if (!flushIfFull())
+      return false;
+  }
+  return !_failed;
+}
+
+bool CsvExporter::writeAccounts(const QList<Account*>& accounts) {
+  for (const Account* account : accounts) {
+    if (!writeAccount(*account))
+      return false;
+  }
+  return !_failed;
+}
+
+bool CsvExporter::writeBudgetReport(const CategoryController& categoryController, const QDate& from, const QDate& to) {
+  for (const char* title : { "Month", "Category", "Budget", "Spent", "Leftover", "Accumulated", "Save", "Report" }) {
+    appendField(QString::fromLatin1(title));
+  }
+  endRow();
+
+  const QList<Category*> categories = categoryController.categories();
+  const QDate last(to.year(), to.month(), 1);
+  for (QDate month(from.year(), from.month(), 1); month <= last; month = month.addMonths(1)) {
+    const QString monthText = month.toString("yyyy-MM");
+    for (const Category* category : categories) {
+      const CategoryFigures figures = categoryController.figures(category, month);
+      appendField(monthText);
+      appendField(category->name());
+      appendField(figures.budgetLimit.toString());
+      appendField(figures.spent.toString());
+      appendField(figures.leftover.toString());
+      appendField(figures.accumulated.toString());
+      appendField(figures.saveAmount.toString());
+      appendField(figures.reportAmount.toString());
+      endRow();
+      if (!flushIfFull())
+        return false;
+    }
+  }
+  return !_failed;
+}
+
+bool CsvExporter::flush() {
+  if (_failed)
+    return false;
+  if (_buffer.isEmpty())
+    return true;
+
+  const QByteArray chunk = _buffer.toUtf8();
+  _buffer.resize(0);  // Keeps the capacity for the next chunk
+  if (_device.write(chunk) != chunk.size()) {
+    _failed = true;
+  }
+  return !_failed;
+}
+
+QString CsvExporter::errorString() const {
+  return _device.errorString();
+}
+
+void CsvExporter::writeOperation(const Account& account, const Operation& operation, Money balance) {
+  if (!_splitAllocations || operation.allocations().isEmpty()) {
+    writeOperationRow(account, operation, balance, operation.amountMoney(), operation.categoryDisplay());
+    return;
+  }
+  for (const Allocation* allocation : operation.allocations()) {
+    writeOperationRow(account, operation, balance, allocation->amountMoney(),
+                      allocation->category() ? allocation->category()->name() : QString());
+  }
+}
+
+void CsvExporter::writeOperationRow(const Account& account,
+                                    const Operation& operation,
+                                    Money balance,
+                                    Money amount,
+                                    const QString& category) {
+  for (Column column : std::as_const(_columns)) {
+    switch (column) {
+      case Column::Account:
+        appendField(account.name());
+        break;
+      case Column::Date:
+        appendField(operation.date().toString("yyyy-MM-dd"));
+        break;
+      case Column::BudgetDate:
+        appendField(operation.budgetDate().toString("yyyy-MM-dd"));
+        break;
+      case Column::Label:
+        appendField(operation.label());
+        break;
+      case Column::Details:
+        appendField(operation.details());
+        break;
+      case Column::Amount:
+        appendField(amount.toString());
+        break;
+      case Column::Category:
+        appendField(category);
+        break;
+      case Column::Balance:
+        appendField(balance.toString());
+        break;
+    }
+  }
+  endRow();
+}
+
+void CsvExporter::appendField(const QString& value) {
+  if (_rowStarted) {
+    _buffer.append(_separator);
+  }
+  _rowStarted = true;
+
+  if (_separator == QLatin1Char('\t')) {
+    // TSV has no quoting: line breaks and tabs become spaces
+    for (QChar c : value) {
+      _buffer.append(c == QLatin1Char('\t') || c == QLatin1Char('\n') || c == QLatin1Char('\r') ? QLatin1Char(' ') : c);
+    }
+    return;
+  }
+
+  bool needsQuotes = false;
+  for (QChar c : value) {
+    if (c == _separator || c == QLatin1Char('"') || c == QLatin1Char('\n') || c == QLatin1Char('\r')) {
+      needsQuotes = true;
+      break;
+    }
+  }
+  if (!needsQuotes) {
+    _buffer.append(value);
+    return;
+  }
+  _buffer.append(QLatin1Char('"'));
+  for (QChar c : value) {
+    if (c == QLatin1Char('"')) {
+      _buffer.append(QLatin1Char('"'));
+    }
+    _buffer.append(c);
+  }
+  _buffer.append(QLatin1Char('"'));
+}
+
+void CsvExporter::endRow() {
+  _buffer.append(QLatin1Char('\n'));
+  _rowStarted = false;
+}
+
+bool CsvExporter::flushIfFull() {
+  return _buffer.size() < ChunkSize ? !_failed : flush();
+}
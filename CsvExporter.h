@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QDate>
+#include <QList>
+#include <QString>
+
+#include "Money.h"
+
+class Account;
+class CategoryController;
+class Operation;
+class QIODevice;
+
+// Streams operations and budget figures to a device as CSV or TSV.
+// Rows are formatted into one reused buffer that is written out in chunks, so memory
+// stays bounded whatever the number of rows.
+class CsvExporter {
+public:
+  enum class Format {
+    Csv,
+    Tsv,
+  };
+
+  enum class Column {
+    Account,
+    Date,
+    BudgetDate,
+    Label,
+    Details,
+    Amount,
+    Category,
+    Balance,
+  };
+
+  static constexpr qsizetype ChunkSize = 64 * 1024;  // Characters buffered before writing
+
+  explicit CsvExporter(QIODevice& device, Format format = Format::Csv);
+  ~CsvExporter();  // Writes what is left in the buffer
+
+  static Format formatForFile(const QString& filePath);  // TSV for .tsv and .tab files
+  static QList<Column> defaultColumns();                // Date, Label, Amount, Category
+
+  // Header and operations as text with the default columns, for the clipboard
+  static QString operationsText(const Account& account, const QList<Operation*>& operations, Format format = Format::Csv);
+
+  void setColumns(const QList<Column>& columns);
+  QList<Column> columns() const { return _columns; }
+
+  // One row per allocation, with its own amount and category
+  void setSplitAllocations(bool split) { _splitAllocations = split; }
+
+  bool writeHeader();
+  bool writeOperations(const Account& account, const QList<Operation*>& operations);
+  bool writeAccount(const Account& account);
+  bool writeAccounts(const QList<Account*>& accounts);
+
+  // Figures of every category for each month of a range, with their own columns
+  bool writeBudgetReport(const CategoryController& categoryController, const QDate& from, const QDate& to);
+
+  bool flush();
+  QString errorString() const;
+
+private:
+  void writeOperation(const Account& account, const Operation& operation, Money balance);
+  void writeOperationRow(const Account& account, const Operation& operation, Money balance, Money amount, const QString& category);
+  void appendField(const QString& value);
+  void endRow();
+  bool flushIfFull();
+
+  QIODevice& _device;
+  QChar _separator;
+  QList<Column> _columns;
+  bool _splitAllocations = false;
+  bool _failed = false;
+  bool _rowStarted = false;
+  QString _buffer;
+};
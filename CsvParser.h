@@ -5,10 +5,12 @@
 #include <QStringList>
 #include <QtMath>
 
+#include "Money.h"
+
 namespace CsvParser {
 
 // Parse amount string handling French format (e.g., "-5 428,69 €" or "-5428.69")
-inline double parseAmount(const QString& str) {
+inline Money parseMoney(const QString& str) {
   QString cleaned = str.trimmed();
   cleaned.remove(' ');            // Remove regular spaces (thousand separators)
   cleaned.remove(QChar(0xA0));    // Remove non-breaking space (U+00A0)
@@ -22,10 +24,13 @@ inline double parseAmount(const QString& str) {
     cleaned = cleaned.mid(1);
   }
 
-  cleaned.replace(',', '.');  // French decimal to standard
+  // Money::fromString accepts both French and standard decimal separators
+  Money value = Money::fromString(cleaned);
+  return isPositive ? value.abs() : value;
+}
 
-  double value = cleaned.toDouble();
-  return isPositive ? qAbs(value) : value;
+inline double parseAmount(const QString& str) {
+  return parseMoney(str).toDouble();
 }
 
 // Parse CSV line respecting quoted fields
@@ -12,6 +12,7 @@ Menu {
     signal editAction
     signal deleteAction
     signal rulesAction
+    signal transfersAction
     signal preferencesAction
 
     Action {
@@ -62,6 +63,15 @@ Menu {
         text: qsTr("Categorization &Rules...")
         onTriggered: root.rulesAction()
     }
+    Action {
+        text: qsTr("Categorize from &Suggestions")
+        onTriggered: RuleController.suggester.acceptTopSuggestions()
+    }
+    Action {
+        text: qsTr("Match &Transfers...")
+        enabled: BudgetData.accountCount > 1
+        onTriggered: root.transfersAction()
+    }
     MenuSeparator {}
     Action {
         text: qsTr("&Preferences...")
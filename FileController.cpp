@@ -4,20 +4,28 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QHash>
 #include <QString>
 #include <QTextStream>
 #include <QUrl>
 #include <string>
 
 #include "Account.h"
+#include "AnalyticsExport.h"
 #include "AppSettings.h"
+#include "ArchiveStore.h"
+#include "BatchScope.h"
 #include "BudgetData.h"
+#include "BudgetSnapshot.h"
 #include "Category.h"
 #include "CategoryController.h"
+#include "CsvExporter.h"
 #include "CsvParser.h"
 #include "FileController.h"
 #include "FileCoordinator.h"
 #include "Operation.h"
+#include "OperationYaml.h"
 #include "Rule.h"
 #include "RuleController.h"
 #include "UndoCommands.h"
@@ -33,28 +41,32 @@ FileController::FileController(AppSettings& appSettings,
     _budgetData(budgetData),
     _categoryController(categoryController),
     _ruleController(ruleController),
-    _undoStack(undoStack) {
+    _undoStack(undoStack),
+    _sqliteStorage(budgetData, categoryController, ruleController) {
   connect(&_fileWatcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path) {
     qDebug() << "File changed detected by QFileSystemWatcher:" << path;
-    if (path == currentFilePath()) {
-      if (hasUnsavedChanges()) {
-        qDebug() << "Current file was modified externally, but there are unsaved changes.";
-        emit externalChangeDetected();
-      } else {
-        qDebug() << "Current file was modified externally. Reloading...";
-        reloadCurrentFile();
-      }
+    checkWatchedFile(path);
+  });
+
+  _autosavePool.setMaxThreadCount(1);
+  _autosaveTimer.setSingleShot(true);
+  _autosaveTimer.setInterval(AutosaveDelay);
+  connect(&_autosaveTimer, &QTimer::timeout, this, &FileController::autosave);
+  connect(&_undoStack, &QUndoStack::indexChanged, this, [this] {
+    _revision++;
+    // Not restarted on each edit, so that a stream of edits is still saved every few seconds
+    if (_appSettings.autosave() && !_autosaveTimer.isActive()) {
+      _autosaveTimer.start();
     }
   });
 }
 
-bool FileController::hasUnsavedChanges() const {
-  return !_undoStack.isClean();
+FileController::~FileController() {
+  _autosavePool.waitForDone();
 }
 
-// Helper to convert QString to std::string for yaml-cpp
-static std::string toStdString(const QString& s) {
-  return s.toStdString();
+bool FileController::hasUnsavedChanges() const {
+  return !_undoStack.isClean();
 }
 
 bool FileController::saveToYamlUrl(const QUrl& fileUrl) {
@@ -71,160 +83,205 @@ bool FileController::saveToYamlFile(const QString& filePath) {
   // Clear any previous error
   set_errorMessage({});
 
-  YAML::Emitter out;
-  out << YAML::BeginMap;
+  // An autosave still being written would land after this save
+  _autosavePool.waitForDone();
 
-  // Get navigation state from NavigationController
-  int currentTabIndex = _budgetData.currentTabIndex();
-  auto currentAccount = _budgetData.currentAccount();
-  auto currentCategory = _categoryController.current();
-
-  // Write state section
-  out << YAML::Key << "state" << YAML::Value << YAML::BeginMap;
-  out << YAML::Key << "currentTab" << YAML::Value << currentTabIndex;
-  out << YAML::Key << "budgetDate" << YAML::Value << toStdString(_budgetData.budgetDate().toString("MMMM yyyy"));
-  out << YAML::EndMap;
-
-  // Write categories
-  out << YAML::Key << "categories" << YAML::Value << YAML::BeginSeq;
-  QList<Category*> cats = _categoryController.categories();
-  for (auto category : _categoryController.categories()) {
-    out << YAML::BeginMap;
-    out << YAML::Key << "name" << YAML::Value << toStdString(category->name());
-    out << YAML::Key << "budget_limit" << YAML::Value << toStdString(QString::number(category->budgetLimit(), 'f', 2));
-    if (category == currentCategory) {
-      out << YAML::Key << "current" << YAML::Value << "true";
-    }
+  // Archived years follow the budget to a new file, their amounts are already in its history
+  ArchiveStore* archive = _categoryController.archive();
+  if (!archive->copyTo(filePath)) {
+    set_errorMessage(tr("Could not save file: %1").arg(archive->errorString()));
+    return false;
+  }
 
-    // Write month history (leftover decisions + budget limit overrides)
-    QMap<YearMonth, MonthRecord> history = category->allMonthHistory();
-    if (!history.isEmpty()) {
-      out << YAML::Key << "month_history" << YAML::Value << YAML::BeginSeq;
-      for (auto it = history.constBegin(); it != history.constEnd(); ++it) {
-        const YearMonth& ym = it.key();
-        const MonthRecord& record = it.value();
-        if (!record.isEmpty()) {
-          out << YAML::BeginMap;
-          out << YAML::Key << "year" << YAML::Value << ym.year;
-          out << YAML::Key << "month" << YAML::Value << ym.month;
-          if (record.budgetLimit.has_value()) {
-            out << YAML::Key << "budget_limit" << YAML::Value << toStdString(QString::number(record.budgetLimit.value(), 'f', 2));
-          }
-          if (record.saveAmount != 0.0) {
-            out << YAML::Key << "save_amount" << YAML::Value << toStdString(QString::number(record.saveAmount, 'f', 2));
-          }
-          if (record.reportAmount != 0.0) {
-            out << YAML::Key << "report_amount" << YAML::Value << toStdString(QString::number(record.reportAmount, 'f', 2));
-          }
-          out << YAML::EndMap;
-        }
-      }
-      out << YAML::EndSeq;
+  if (SqliteStorage::isStorageFile(filePath)) {
+    if (!_sqliteStorage.save(filePath)) {
+      qWarning() << "Failed to save database:" << filePath << _sqliteStorage.errorString();
+      set_errorMessage(tr("Could not save file: %1").arg(_sqliteStorage.errorString()));
+      return false;
     }
+    unwatchFiles();  // The database is written in place on each save
+    finishSave(filePath);
+    return true;
+  }
+  if (!_sqliteStorage.loadPendingAccounts()) {
+    set_errorMessage(tr("Could not save file: %1").arg(_sqliteStorage.errorString()));
+    return false;
+  }
 
-    out << YAML::EndMap;
+  // Written once, atomically: the watcher sees a single change, recognized as ours
+  QString errorMessage;
+  QByteArray contentHash;
+  if (!BudgetSnapshot::capture(_budgetData, _categoryController, _ruleController).save(filePath, errorMessage, &contentHash)) {
+    qWarning() << "Failed to write file:" << filePath << errorMessage;
+    set_errorMessage(tr("Could not save file: %1").arg(errorMessage));
+    return false;
   }
-  out << YAML::EndSeq;
 
-  // Write accounts
-  out << YAML::Key << "accounts" << YAML::Value << YAML::BeginSeq;
-  for (auto account : _budgetData.accounts()) {
-    out << YAML::BeginMap;
-    out << YAML::Key << "name" << YAML::Value << toStdString(account->name());
-    if (account == currentAccount) {
-      out << YAML::Key << "current" << YAML::Value << "true";
-    }
+  watchFile(filePath, contentHash);
+  finishSave(filePath);
+  return true;
+}
 
-    // Save import sources (filenames previously imported into this account)
-    if (!account->importSourcePrefixes().isEmpty()) {
-      out << YAML::Key << "import_source_prefixes" << YAML::Value << YAML::BeginSeq;
-      for (const QString& source : account->importSourcePrefixes()) {
-        out << toStdString(source);
-      }
-      out << YAML::EndSeq;
-    }
+bool FileController::exportOperationsToUrl(const QUrl& fileUrl) {
+  set_errorMessage({});
+  const QString filePath = fileUrl.toLocalFile();
+  if (!_sqliteStorage.loadPendingAccounts()) {
+    set_errorMessage(tr("Could not export file: %1").arg(_sqliteStorage.errorString()));
+    return false;
+  }
 
-    out << YAML::Key << "operations" << YAML::Value << YAML::BeginSeq;
-    const auto& ops = account->operations();
-    for (int opIdx = 0; opIdx < ops.size(); opIdx++) {
-      const Operation* op = ops[opIdx];
-      out << YAML::BeginMap;
-      out << YAML::Key << "date" << YAML::Value << toStdString(op->date().toString("yyyy-MM-dd"));
-      out << YAML::Key << "amount" << YAML::Value << toStdString(QString::number(op->amount(), 'f', 2));
-      out << YAML::Key << "label" << YAML::Value << toStdString(op->label());
-
-      if (!op->allocations().isEmpty()) {
-        // Handle split operations
-        out << YAML::Key << "allocations" << YAML::Value << YAML::BeginSeq;
-        for (const auto& alloc : op->allocations()) {
-          out << YAML::BeginMap;
-          if (alloc->category()) {
-            out << YAML::Key << "category" << YAML::Value << toStdString(alloc->category()->name());
-          }
-          out << YAML::Key << "amount" << YAML::Value << toStdString(QString::number(alloc->amount(), 'f', 2));
-          out << YAML::EndMap;
-        }
-        out << YAML::EndSeq;
-      }
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
+    return false;
+  }
+  CsvExporter exporter(file, CsvExporter::formatForFile(filePath));
+  exporter.setColumns({ CsvExporter::Column::Account,
+                        CsvExporter::Column::Date,
+                        CsvExporter::Column::BudgetDate,
+                        CsvExporter::Column::Label,
+                        CsvExporter::Column::Details,
+                        CsvExporter::Column::Amount,
+                        CsvExporter::Column::Category,
+                        CsvExporter::Column::Balance });
+  exporter.setSplitAllocations(true);
+  if (!exporter.writeHeader() || !exporter.writeAccounts(_budgetData.accounts()) || !exporter.flush() || !file.commit()) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
+    return false;
+  }
+  qDebug() << "Operations exported to:" << filePath;
+  return true;
+}
 
-      // Only save budget_date if explicitly set (different from operation date)
-      if (op->budgetDate() != op->date()) {
-        out << YAML::Key << "budget_date" << YAML::Value << toStdString(op->budgetDate().toString("yyyy-MM-dd"));
-      }
-      // Mark current operation for this account
-      if (op == account->currentOperation()) {
-        out << YAML::Key << "current" << YAML::Value << "true";
-      }
+bool FileController::exportBudgetReportToUrl(const QUrl& fileUrl) {
+  set_errorMessage({});
+  const QString filePath = fileUrl.toLocalFile();
+  if (!_sqliteStorage.loadPendingAccounts()) {
+    set_errorMessage(tr("Could not export file: %1").arg(_sqliteStorage.errorString()));
+    return false;
+  }
 
-      out << YAML::EndMap;
-    }
-    out << YAML::EndSeq;
-
-    out << YAML::EndMap;
-  }
-  out << YAML::EndSeq;
-
-  // Write categorization rules
-  QList<Rule*> rulesList = _ruleController.rules();
-  if (!rulesList.isEmpty()) {
-    out << YAML::Key << "rules" << YAML::Value << YAML::BeginSeq;
-    for (const Rule* rule : rulesList) {
-      out << YAML::BeginMap;
-      if (rule->category()) {
-        out << YAML::Key << "category" << YAML::Value << toStdString(rule->category()->name());
-        out << YAML::Key << "label_match" << YAML::Value << toStdString(rule->labelMatch());
-        if (rule->amountFilter() != 0) {
-          out << YAML::Key << "amount" << YAML::Value << rule->amountFilter();
-        }
-      }
-      out << YAML::EndMap;
-    }
-    out << YAML::EndSeq;
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
+    return false;
   }
+  const int year = _budgetData.budgetDate().year();
+  CsvExporter exporter(file, CsvExporter::formatForFile(filePath));
+  if (!exporter.writeBudgetReport(_categoryController, QDate(year, 1, 1), QDate(year, 12, 1)) || !exporter.flush()
+      || !file.commit()) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
+    return false;
+  }
+  qDebug() << "Budget report exported to:" << filePath;
+  return true;
+}
 
-  out << YAML::EndMap;
+bool FileController::exportAnalyticsToUrl(const QUrl& fileUrl) {
+  set_errorMessage({});
+  const QString filePath = fileUrl.toLocalFile();
+  if (!_sqliteStorage.loadPendingAccounts()) {
+    set_errorMessage(tr("Could not export file: %1").arg(_sqliteStorage.errorString()));
+    return false;
+  }
 
-  // Write to file
-  QFile file(filePath);
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-    qWarning() << "Failed to open file for writing:" << filePath;
-    set_errorMessage(tr("Could not save file: %1").arg(file.errorString()));
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
     return false;
   }
+  QString errorMessage;
+  if (!AnalyticsExport::writeOperations(file, _budgetData.accounts(), errorMessage)) {
+    set_errorMessage(tr("Could not export file: %1").arg(errorMessage));
+    return false;
+  }
+  if (!file.commit()) {
+    set_errorMessage(tr("Could not export file: %1").arg(file.errorString()));
+    return false;
+  }
+  qDebug() << "Operations exported for analysis to:" << filePath;
+  return true;
+}
 
-  QTextStream stream(&file);
-  stream.setEncoding(QStringConverter::Utf8);
-  stream << QString::fromStdString(std::string(out.c_str()));
-  stream << "\n";
-  file.close();
+void FileController::autosave() {
+  const QString filePath = currentFilePath();
+  if (filePath.isEmpty() || _undoStack.isClean())
+    return;
 
+  // The database is written incrementally, in place
+  if (SqliteStorage::isStorageFile(filePath)) {
+    saveToYamlFile(filePath);
+    return;
+  }
+  // One write at a time, and never in the middle of a bulk edit
+  if (_autosaving || _budgetData.isBatching()) {
+    _autosaveTimer.start();
+    return;
+  }
+  if (!_sqliteStorage.loadPendingAccounts())
+    return;
+
+  // Not watched while written: the new file replaces the watched one
+  const bool watched = _fileWatcher.removePath(filePath);
+  const quint64 revision = _revision;
+  _autosaving = true;
+  _autosavePool.start([this, filePath, revision, watched,
+                       snapshot = BudgetSnapshot::capture(_budgetData, _categoryController, _ruleController)] {
+    QString errorMessage;
+    QByteArray contentHash;
+    const bool saved = snapshot.save(filePath, errorMessage, &contentHash);
+    QMetaObject::invokeMethod(
+        this,
+        [this, filePath, revision, watched, saved, errorMessage, contentHash] {
+          finishAutosave(filePath, revision, watched, saved, errorMessage, contentHash);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void FileController::finishAutosave(const QString& filePath,
+                                    quint64 revision,
+                                    bool watched,
+                                    bool saved,
+                                    const QString& errorMessage,
+                                    const QByteArray& contentHash) {
+  _autosaving = false;
+  const bool sameFile = filePath == currentFilePath();
+  // A save or an edit made during the write leaves the hash behind the file on disk: the
+  // file state recorded by that save, or by the next autosave, is the one to keep
+  const bool current = !_undoStack.isClean() && revision == _revision;
+  if (saved && sameFile && current) {
+    watchFile(filePath, contentHash);
+  } else if ((watched || saved) && sameFile && !_fileWatcher.files().contains(filePath)) {
+    _fileWatcher.addPath(filePath);
+  }
+
+  if (!saved) {
+    qWarning() << "Failed to autosave:" << filePath << errorMessage;
+    set_errorMessage(tr("Could not save file: %1").arg(errorMessage));
+    return;
+  }
+  if (!sameFile || _undoStack.isClean())
+    return;
+  if (revision == _revision) {
+    finishSave(filePath);
+  } else {
+    _autosaveTimer.start();  // Edited during the write
+  }
+}
+
+void FileController::finishSave(const QString& filePath) {
   qDebug() << "Budget data saved to:" << filePath;
   _undoStack.setClean();
   emit dataSaved();
   set_currentFilePath(filePath);
+  // The budget now names renamed categories as they are: so must the archived years
+  ArchiveStore* archive = _categoryController.archive();
+  archive->setBudgetFile(filePath);
+  if (!archive->applyRenames()) {
+    set_errorMessage(tr("Could not write archive: %1").arg(archive->errorString()));
+  }
   _appSettings.addRecentFile(filePath);
-
-  return true;
 }
 
 bool FileController::loadFromYamlUrl(const QUrl& fileUrl) {
@@ -252,6 +309,17 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
   // Clear any previous error
   set_errorMessage({});
 
+  if (SqliteStorage::isStorageFile(filePath)) {
+    _budgetData.clear();
+    if (!_sqliteStorage.load(filePath)) {
+      qWarning() << "Failed to load database:" << filePath << _sqliteStorage.errorString();
+      set_errorMessage(tr("Could not open file: %1").arg(_sqliteStorage.errorString()));
+      return false;
+    }
+    finishLoad(filePath);  // Not watched: the database is written in place on each save
+    return true;
+  }
+
   // Use FileCoordinator to read the file - this triggers cloud file downloads
   // on MacOS (Dropbox, iCloud, etc.) via NSFileCoordinator
   QByteArray data;
@@ -309,7 +377,7 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
           category->set_name(yamlString(cat["name"]));
         }
         if (cat["budget_limit"]) {
-          category->set_budgetLimit(yamlString(cat["budget_limit"]).toDouble());
+          category->set_budgetLimit(Money::fromString(yamlString(cat["budget_limit"])));
         }
 
         // Load month history (new format) or leftover decisions (legacy format)
@@ -326,19 +394,22 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
             }
             // Budget limit override (new in month_history format)
             if (entryNode["budget_limit"]) {
-              record.budgetLimit = yamlString(entryNode["budget_limit"]).toDouble();
+              record.budgetLimit = Money::fromString(yamlString(entryNode["budget_limit"]));
             }
             // New format: separate save_amount and report_amount
             if (entryNode["save_amount"]) {
-              record.saveAmount = yamlString(entryNode["save_amount"]).toDouble();
+              record.saveAmount = Money::fromString(yamlString(entryNode["save_amount"]));
             }
             if (entryNode["report_amount"]) {
-              record.reportAmount = yamlString(entryNode["report_amount"]).toDouble();
+              record.reportAmount = Money::fromString(yamlString(entryNode["report_amount"]));
+            }
+            if (entryNode["archived_spent"]) {
+              record.archivedSpent = Money::fromString(yamlString(entryNode["archived_spent"]));
             }
             // Legacy format: action + amount
             if (entryNode["action"] && entryNode["amount"]) {
               QString actionStr = yamlString(entryNode["action"]).toLower();
-              double amount = yamlString(entryNode["amount"]).toDouble();
+              Money amount = Money::fromString(yamlString(entryNode["amount"]));
               if (actionStr == "save") {
                 record.saveAmount = amount;
               } else if (actionStr == "report") {
@@ -369,6 +440,7 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
     }
 
     // Load accounts
+    auto categoryByName = [this](const QString& name) { return _categoryController.getCategoryByName(name); };
     if (root["accounts"]) {
       for (const auto& acc : root["accounts"]) {
         QString name;
@@ -376,6 +448,7 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
           name = yamlString(acc["name"]);
         }
         auto account = new Account(name);
+        BatchScope batch(*account);  // Balances are computed once all operations are loaded
         // Load import source prefix
         YAML::Node importSourcePrefixes;
         if (acc["import_source_prefixes"]) {
@@ -390,49 +463,17 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
           }
           account->setImportSourcePrefixes(sources);
         }
-        // Note: balance field is ignored - balance is calculated from operations
+        // Note: balance field is ignored - balance is calculated from operations and the opening balance
+        if (acc["opening_balance"]) {
+          account->set_openingBalance(Money::fromString(yamlString(acc["opening_balance"])));
+        }
         if (acc["operations"]) {
           for (const auto& opNode : acc["operations"]) {
-            auto op = new Operation(account);
-            if (opNode["date"]) {
-              op->set_date(QDate::fromString(yamlString(opNode["date"]), "yyyy-MM-dd"));
-            }
-            if (opNode["amount"]) {
-              op->set_amount(yamlString(opNode["amount"]).toDouble());
-            }
-            // Handle split operations (allocations) vs single category
-            if (opNode["allocations"]) {
-              QList<Allocation*> allocations;
-              for (const auto& allocNode : opNode["allocations"]) {
-                if (allocNode["category"] && allocNode["amount"]) {
-                  allocations.append(new Allocation(
-                      _categoryController.getCategoryByName(yamlString(allocNode["category"])),
-                      yamlString(allocNode["amount"]).toDouble()));
-                }
-              }
-              op->setAllocations(allocations);
-            } else if (opNode["category"]) {  // Support for old format (<= 0.14)
-              auto category = _categoryController.getCategoryByName(yamlString(opNode["category"]));
-              op->setAllocations({ new Allocation(category, op->amount()) });
-            }
-
-            if (opNode["label"]) {
-              op->set_label(yamlString(opNode["label"]));
-            } else if (opNode["description"]) {
-              op->set_label(yamlString(opNode["description"]));
-            }
-            if (opNode["details"]) {
-              op->set_details(yamlString(opNode["details"]));
-            }
-            if (opNode["budget_date"]) {
-              op->set_budgetDate(QDate::fromString(yamlString(opNode["budget_date"]), "yyyy-MM-dd"));
-            }
+            auto op = OperationYaml::read(opNode, account, categoryByName);
             account->addOperation(op, false);  // Preserve file order
-            if (opNode["current"]) {
-              if (yamlString(opNode["current"]).toLower() == "true") {
-                // Set this operation as the current operation for this account
-                account->select(op);
-              }
+            if (OperationYaml::isCurrent(opNode)) {
+              // Set this operation as the current operation for this account
+              account->select(op);
             }
           }
         }
@@ -462,13 +503,22 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
           labelMatch = yamlString(ruleNode["label_prefix"]);
         }
 
+        // Older files only have contains rules
+        Rule::MatchMode matchMode = Rule::MatchMode::Contains;
+        if (ruleNode["match_mode"]) {
+          bool ok = false;
+          matchMode = Rule::matchModeFromName(yamlString(ruleNode["match_mode"]), &ok);
+          if (!ok) {
+            qWarning() << "Unknown rule match mode:" << yamlString(ruleNode["match_mode"]);
+          }
+        }
+
         if (category && !labelMatch.isEmpty()) {
           Rule* rule;
           if (ruleNode["amount"]) {
-            double amount = ruleNode["amount"].as<double>();
-            rule = new Rule(category, labelMatch, amount);
+            rule = new Rule(category, labelMatch, Money::fromString(yamlString(ruleNode["amount"])), matchMode);
           } else {
-            rule = new Rule(category, labelMatch);
+            rule = new Rule(category, labelMatch, {}, matchMode);
           }
           _ruleController.addRule(rule);
         }
@@ -482,6 +532,13 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
 
   _budgetData.set_budgetDate(loadedBudgetDate);
   _budgetData.set_currentTabIndex(loadedTabIndex);
+  finishLoad(filePath);
+  watchFile(filePath, BudgetSnapshot::hash(data));
+
+  return true;
+}
+
+void FileController::finishLoad(const QString& filePath) {
   auto currentAccount = _budgetData.currentAccount();
   if (currentAccount == nullptr) {
     currentAccount = _budgetData.accountAt(0);
@@ -494,6 +551,7 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
   }
 
   set_currentFilePath(filePath);
+  _categoryController.archive()->setBudgetFile(filePath);
   _undoStack.clear();
   _undoStack.setClean();
 
@@ -503,10 +561,67 @@ bool FileController::loadFromYamlFile(const QString& filePath) {
   emit yamlFileLoaded();
   emit dataLoaded();
   qDebug() << "Budget data loaded from:" << filePath;
+}
 
-  _fileWatcher.addPath(filePath);
+void FileController::watchFile(const QString& filePath, const QByteArray& contentHash) {
+  const QFileInfo info(filePath);
+  _fileState = { info.size(), info.lastModified(), contentHash };
 
-  return true;
+  for (const QString& watchedPath : _fileWatcher.files()) {
+    if (watchedPath != filePath) {
+      _fileWatcher.removePath(watchedPath);
+    }
+  }
+  // Also watched again after a write replaced the file by a rename
+  if (!_fileWatcher.files().contains(filePath)) {
+    _fileWatcher.addPath(filePath);
+  }
+}
+
+void FileController::unwatchFiles() {
+  if (!_fileWatcher.files().isEmpty()) {
+    _fileWatcher.removePaths(_fileWatcher.files());
+  }
+  _fileState = {};
+}
+
+void FileController::checkWatchedFile(const QString& filePath, int attempts) {
+  if (filePath != currentFilePath() || SqliteStorage::isStorageFile(filePath))
+    return;
+
+  const QFileInfo info(filePath);
+  if (!info.exists()) {
+    // Deleted and written again by a sync tool: check once it is back
+    if (attempts > 0) {
+      QTimer::singleShot(RewatchDelay, this, [this, filePath, attempts] {
+        checkWatchedFile(filePath, attempts - 1);
+      });
+    }
+    return;
+  }
+  // A file replaced by a rename is no longer watched
+  if (!_fileWatcher.files().contains(filePath)) {
+    _fileWatcher.addPath(filePath);
+  }
+
+  if (info.size() == _fileState.size) {
+    if (info.lastModified() == _fileState.lastModified)
+      return;  // Our own write
+    QByteArray data;
+    QString readError;
+    if (FileCoordinator::readFile(filePath, data, readError) && BudgetSnapshot::hash(data) == _fileState.contentHash) {
+      _fileState.lastModified = info.lastModified();  // Touched, or written again with the same content
+      return;
+    }
+  }
+
+  if (hasUnsavedChanges()) {
+    qDebug() << "Current file was modified externally, but there are unsaved changes.";
+    emit externalChangeDetected();
+  } else {
+    qDebug() << "Current file was modified externally. Reloading...";
+    reloadCurrentFile();
+  }
 }
 
 void FileController::reloadCurrentFile() {
@@ -613,8 +728,9 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
     return false;
   }
 
-  // Create or get account
+  // Create or get account, the duplicate check below needs its operations still on disk
   QString name = accountName.isEmpty() ? "Imported Account" : accountName;
+  _budgetData.requireAllAccounts();
   Account* account = _budgetData.accountByName(name);
   bool isNewAccount = false;
   if (!account) {
@@ -624,12 +740,12 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
   }
 
   // Create a macro command that composes all the sub-commands
-  QUndoCommand* macroCommand = new QUndoCommand();
+  QUndoCommand* macroCommand = new BatchCommand(_budgetData);
 
   QList<Operation*> importedOperations;
   int skippedCount = 0;
-  QSet<Category*> newCategories;
-  double totalBalance = 0.0;
+  QHash<QString, Category*> newCategories;
+  Money totalBalance;
 
   while (!in.atEnd()) {
     QString line = in.readLine();
@@ -653,19 +769,19 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
     }
 
     // Parse amount (required - from debit, credit, or amount column)
-    double amount = 0.0;
+    Money amount;
     if (idx.amount >= 0) {
       QString amountStr = getField(fields, idx.amount);
       if (!amountStr.isEmpty()) {
-        amount = parseAmount(amountStr);
+        amount = parseMoney(amountStr);
       }
     } else {
       QString debitStr = getField(fields, idx.debit);
       QString creditStr = getField(fields, idx.credit);
       if (!debitStr.isEmpty()) {
-        amount = parseAmount(debitStr);
+        amount = parseMoney(debitStr);
       } else if (!creditStr.isEmpty()) {
-        amount = parseAmount(creditStr);
+        amount = parseMoney(creditStr);
       }
     }
 
@@ -693,17 +809,12 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
       if (!categoryName.isEmpty()) {
         category = _categoryController.getCategoryByName(categoryName);
         if (category == nullptr) {
-          for (auto cat : newCategories) {
-            if (cat->name() == categoryName) {
-              category = cat;
-              break;
-            }
-          }
+          category = newCategories.value(categoryName, nullptr);
         }
         if (category == nullptr) {
           category = new Category(categoryName, 0.0);
           new AddCategoryCommand(&_categoryController, category, macroCommand);
-          newCategories.insert(category);
+          newCategories.insert(categoryName, category);
         }
       }
     }
@@ -782,8 +893,11 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
   _budgetData.set_currentAccount(account);
 
   // Apply categorization rules to imported operations
-  for (Operation* op : importedOperations) {
-    _ruleController.applyRulesToOperation(op);
+  {
+    BatchScope batch(_budgetData);
+    for (Operation* op : importedOperations) {
+      _ruleController.applyRulesToOperation(op);
+    }
   }
 
   // Record import source for future auto-suggestion
@@ -803,12 +917,77 @@ bool FileController::importFromCsv(const QUrl& fileUrl,
   return true;
 }
 
+bool FileController::archiveYearsBefore(int year) {
+  set_errorMessage({});
+  if (currentFilePath().isEmpty()) {
+    set_errorMessage(tr("Save the budget before archiving years"));
+    return false;
+  }
+  if (!_sqliteStorage.loadPendingAccounts()) {
+    set_errorMessage(tr("Could not archive years: %1").arg(_sqliteStorage.errorString()));
+    return false;
+  }
+
+  // Operations of closed years, grouped by budget year then account name.
+  // Both dates must be closed so that neither balances nor budgets of open years change.
+  QHash<int, QHash<QString, QList<const Operation*>>> shards;
+  QHash<Account*, QSet<Operation*>> archived;
+  for (Account* account : _budgetData.accounts()) {
+    for (Operation* op : account->operations()) {
+      if (op->date().year() < year && op->budgetDate().year() < year) {
+        shards[op->budgetDate().year()][account->name()].append(op);
+        archived[account].insert(op);
+      }
+    }
+  }
+  if (archived.isEmpty())
+    return true;
+
+  // The detail view may show operations of a shard about to be rewritten
+  _categoryController.detailModel()->clear();
+  ArchiveStore* archive = _categoryController.archive();
+  for (auto it = shards.cbegin(); it != shards.cend(); ++it) {
+    if (!archive->write(it.key(), it.value())) {
+      set_errorMessage(tr("Could not write archive: %1").arg(archive->errorString()));
+      return false;
+    }
+  }
+
+  // Archived operations can no longer be restored by undo
+  _undoStack.clear();
+
+  {
+    BatchScope batch(_budgetData);
+    for (auto it = archived.cbegin(); it != archived.cend(); ++it) {
+      Account* account = it.key();
+      Money total;
+      for (Operation* op : it.value()) {
+        total += op->amountMoney();
+        const QDate budgetDate = op->budgetDate();
+        for (const Allocation* allocation : op->allocations()) {
+          if (!allocation->category())
+            continue;
+          if (Category* category = _categoryController.getCategoryByName(allocation->category()->name())) {
+            category->addArchivedSpent(budgetDate.year(), budgetDate.month(), allocation->amountMoney());
+          }
+        }
+      }
+      account->set_openingBalance(account->openingBalanceMoney() + total);
+      account->removeOperations(it.value());
+      qDeleteAll(it.value());
+    }
+  }
+
+  return saveToYamlFile(currentFilePath());
+}
+
 void FileController::clear() {
+  _categoryController.detailModel()->clear();
+  _categoryController.archive()->setBudgetFile({});
+  _sqliteStorage.close();
   _budgetData.clear();
   _categoryController.clear();
-  if (_fileWatcher.files().contains(currentFilePath())) {
-    _fileWatcher.removePath(currentFilePath());
-  }
+  unwatchFiles();
   set_currentFilePath({});
 }
 
@@ -816,7 +995,8 @@ void FileController::loadInitialFile(const QStringList& args) {
   // Command line argument takes priority (skip first arg which is the program name)
   if (args.size() > 1) {
     QString filePath = args.at(1);
-    if (filePath.endsWith(".comptine") || filePath.endsWith(".yaml") || filePath.endsWith(".yml")) {
+    if (filePath.endsWith(".comptine") || filePath.endsWith(".yaml") || filePath.endsWith(".yml")
+        || SqliteStorage::isStorageFile(filePath)) {
       loadFromYamlFile(filePath);
       return;
     } else if (filePath.endsWith(".csv")) {
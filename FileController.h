@@ -1,13 +1,18 @@
 #pragma once
 
+#include <QByteArray>
+#include <QDateTime>
 #include <QFileSystemWatcher>
 #include <QObject>
 #include <QQmlEngine>
 #include <QString>
+#include <QThreadPool>
+#include <QTimer>
 #include <QUndoStack>
 #include <QUrl>
 
 #include "PropertyMacros.h"
+#include "SqliteStorage.h"
 
 class AppSettings;
 class Account;
@@ -35,6 +40,7 @@ public:
                  CategoryController& categoryController,
                  RuleController& ruleController,
                  QUndoStack& undoStack);
+  ~FileController() override;
 
   // File operations
   Q_INVOKABLE bool loadFromYamlUrl(const QUrl& fileUrl);
@@ -46,6 +52,22 @@ public:
                                  const QString& accountName = QString(),
                                  bool useCategories = false);
 
+  // Export every operation of every account, one row per allocation, as CSV or TSV (.tsv files)
+  Q_INVOKABLE bool exportOperationsToUrl(const QUrl& fileUrl);
+  // Export the figures of every category for each month of the budget date year
+  Q_INVOKABLE bool exportBudgetReportToUrl(const QUrl& fileUrl);
+  // Export every operation of every account as a columnar Arrow file, for data analysis tools
+  Q_INVOKABLE bool exportAnalyticsToUrl(const QUrl& fileUrl);
+
+  // Save the current file from a snapshot, written on a worker thread. The budget is marked
+  // clean when the write completes, unless it was edited in the meantime.
+  // Called after each edit when autosave is enabled in the settings.
+  Q_INVOKABLE void autosave();
+
+  // Move the operations of the years before the given one into read-only archive shards
+  // next to the budget file, then save it. Balances and spent amounts are carried over.
+  Q_INVOKABLE bool archiveYearsBefore(int year);
+
   // Load initial file from command line arguments or most recent file
   void loadInitialFile(const QStringList& args);
 
@@ -59,10 +81,42 @@ signals:
   void externalChangeDetected();  // Emitted when QFileSystemWatcher detects external modification
 
 private:
+  void finishSave(const QString& filePath);
+  void finishLoad(const QString& filePath);
+  void finishAutosave(const QString& filePath, quint64 revision, bool watched, bool saved, const QString& errorMessage,
+                      const QByteArray& contentHash);
+
+  // Watch the current file, as just read or written with the given content hash
+  void watchFile(const QString& filePath, const QByteArray& contentHash);
+  void unwatchFiles();
+  // Reload the current file if it changed since we last read or wrote it. A file still
+  // missing, while a sync tool replaces it, is checked again a few times.
+  void checkWatchedFile(const QString& filePath, int attempts = RewatchAttempts);
+
   AppSettings& _appSettings;
   BudgetData& _budgetData;
   CategoryController& _categoryController;
   RuleController& _ruleController;
   QUndoStack& _undoStack;
   QFileSystemWatcher _fileWatcher;
+  SqliteStorage _sqliteStorage;
+
+  // State of the current file when we last read or wrote it: watcher notifications matching
+  // it come from our own writes. The size and modification time are compared first, the
+  // content is only read and hashed when the time alone differs.
+  struct FileState {
+    qint64 size = -1;
+    QDateTime lastModified;
+    QByteArray contentHash;
+  };
+  static constexpr int RewatchDelay = 200;  // Milliseconds between checks for a replaced file
+  static constexpr int RewatchAttempts = 10;
+  FileState _fileState;
+
+  // Autosave
+  static constexpr int AutosaveDelay = 3000;  // Milliseconds between an edit and its autosave
+  QTimer _autosaveTimer;
+  QThreadPool _autosavePool;  // A single writer, so that writes land in order
+  quint64 _revision = 0;      // Bumped by every undo stack move, to tell edits made during a write
+  bool _autosaving = false;
 };
@@ -13,6 +13,10 @@ Menu {
     signal openFileAction
     signal saveFileDialogAction
     signal importFileDialogAction
+    signal exportOperationsDialogAction
+    signal exportBudgetReportDialogAction
+    signal exportAnalyticsDialogAction
+    signal archiveYearsDialogAction
     signal openRecentFileAction(string filePath)
     signal quitAction
 
@@ -75,6 +79,23 @@ Menu {
         shortcut: "Ctrl+Shift+I"
         onTriggered: root.importFileDialogAction()
     }
+    Action {
+        text: qsTr("&Export Operations...")
+        onTriggered: root.exportOperationsDialogAction()
+    }
+    Action {
+        text: qsTr("Export &Budget Report...")
+        onTriggered: root.exportBudgetReportDialogAction()
+    }
+    Action {
+        text: qsTr("Export for &Analysis...")
+        onTriggered: root.exportAnalyticsDialogAction()
+    }
+    MenuSeparator {}
+    Action {
+        text: qsTr("Archive Closed &Years...")
+        onTriggered: root.archiveYearsDialogAction()
+    }
     MenuSeparator {}
     Action {
         text: qsTr("&Quit")
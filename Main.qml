@@ -21,7 +21,7 @@ ApplicationWindow {
     title: FileController.currentFilePath.length > 0 ? "Comptine - " + FileController.currentFilePath.split('/').pop() : "Comptine"
     color: Theme.background
 
-    property bool fileDialogOpen: openDialog.visible || saveDialog.visible || csvDialog.visible
+    property bool fileDialogOpen: openDialog.visible || saveDialog.visible || csvDialog.visible || exportDialog.visible || analyticsDialog.visible
     property bool anyDialogOpen: fileDialogOpen || importDialog.visible || aboutDialog.visible || preferencesDialog.visible || unsavedChangesDialog.visible || budgetView.dialogOpen || updateDialog.visible || rulesView.visible
     property string pendingAction: ""  // "quit", "new", or "open"
     property string pendingRecentFile: ""  // File path to open from recent files
@@ -81,6 +81,16 @@ ApplicationWindow {
         }
         onSaveFileDialogAction: saveDialog.open()
         onImportFileDialogAction: csvDialog.open()
+        onExportOperationsDialogAction: {
+            exportDialog.budgetReport = false;
+            exportDialog.open();
+        }
+        onExportBudgetReportDialogAction: {
+            exportDialog.budgetReport = true;
+            exportDialog.open();
+        }
+        onExportAnalyticsDialogAction: analyticsDialog.open()
+        onArchiveYearsDialogAction: budgetView.archiveYears()
         onOpenRecentFileAction: function (filePath) {
             if (!window.checkUnsavedChanges("openRecent")) {
                 FileController.loadFromYamlFile(filePath);
@@ -116,6 +126,10 @@ ApplicationWindow {
             }
         }
         onRulesAction: rulesView.open()
+        onTransfersAction: {
+            BudgetData.currentTabIndex = 0;
+            operationView.matchTransfers();
+        }
         onPreferencesAction: preferencesDialog.open()
 
         onCheckUpdateAction: {
@@ -136,7 +150,7 @@ ApplicationWindow {
         id: openDialog
         title: qsTr("Open Budget File")
         fileMode: FileDialog.OpenFile
-        nameFilters: ["Comptine files (*.comptine)", "All files (*)"]
+        nameFilters: ["Comptine files (*.comptine)", "Comptine databases (*.comptinedb)", "All files (*)"]
         onAccepted: {
             FileController.loadFromYamlUrl(selectedFile);
         }
@@ -146,7 +160,7 @@ ApplicationWindow {
         id: saveDialog
         title: qsTr("Save Budget File")
         fileMode: FileDialog.SaveFile
-        nameFilters: ["Comptine files (*.comptine)", "All files (*)"]
+        nameFilters: ["Comptine files (*.comptine)", "Comptine databases (*.comptinedb)", "All files (*)"]
         currentFile: FileController.currentFilePath.length > 0 ? "file://" + FileController.currentFilePath : ""
         onAccepted: {
             if (FileController.saveToYamlUrl(selectedFile)) {
@@ -171,6 +185,29 @@ ApplicationWindow {
         }
     }
 
+    FileDialog {
+        id: exportDialog
+        property bool budgetReport: false
+        title: budgetReport ? qsTr("Export Budget Report") : qsTr("Export Operations")
+        fileMode: FileDialog.SaveFile
+        nameFilters: ["CSV files (*.csv)", "TSV files (*.tsv)", "All files (*)"]
+        onAccepted: {
+            if (budgetReport) {
+                FileController.exportBudgetReportToUrl(selectedFile);
+            } else {
+                FileController.exportOperationsToUrl(selectedFile);
+            }
+        }
+    }
+
+    FileDialog {
+        id: analyticsDialog
+        title: qsTr("Export for Analysis")
+        fileMode: FileDialog.SaveFile
+        nameFilters: ["Arrow files (*.arrow *.feather)", "All files (*)"]
+        onAccepted: FileController.exportAnalyticsToUrl(selectedFile)
+    }
+
     ImportDialog {
         id: importDialog
     }
@@ -0,0 +1,121 @@
+// Fixed-point monetary amount for Comptine
+#pragma once
+
+#include <QDebug>
+#include <QHashFunctions>
+#include <QString>
+#include <QtGlobal>
+
+#include <cmath>
+
+// Monetary amount stored as integer cents.
+// Sums and comparisons are exact; doubles only appear at the QML boundary.
+class Money {
+public:
+  constexpr Money() = default;
+
+  // Implicit so that literals and QML doubles convert naturally (rounded to the nearest cent)
+  Money(double value) :
+      _cents(std::llround(value * 100.0)) {}
+
+  static constexpr Money fromCents(qint64 cents) {
+    Money money;
+    money._cents = cents;
+    return money;
+  }
+
+  // Parse a decimal string ("-1234.56", "12,5", "+3") without going through floating point.
+  // Extra fraction digits are rounded half away from zero. Falls back to QString::toDouble()
+  // for anything else (e.g. exponent notation written by older versions).
+  static Money fromString(const QString& str, bool* ok = nullptr) {
+    const QString s = str.trimmed();
+    int i = 0;
+    bool negative = false;
+    if (i < s.size() && (s[i] == '-' || s[i] == '+')) {
+      negative = s[i] == '-';
+      i++;
+    }
+    qint64 units = 0;
+    int unitDigits = 0;
+    while (i < s.size() && s[i].isDigit()) {
+      units = units * 10 + s[i].digitValue();
+      unitDigits++;
+      i++;
+    }
+    qint64 fraction = 0;
+    int fractionDigits = 0;
+    bool roundUp = false;
+    if (i < s.size() && (s[i] == '.' || s[i] == ',')) {
+      i++;
+      while (i < s.size() && s[i].isDigit()) {
+        if (fractionDigits < 2) {
+          fraction = fraction * 10 + s[i].digitValue();
+        } else if (fractionDigits == 2) {
+          roundUp = s[i].digitValue() >= 5;
+        }
+        fractionDigits++;
+        i++;
+      }
+    }
+    if (i != s.size() || unitDigits + fractionDigits == 0) {
+      bool doubleOk = false;
+      const double value = s.toDouble(&doubleOk);
+      if (ok) *ok = doubleOk;
+      return doubleOk ? Money(value) : Money();
+    }
+    if (fractionDigits == 1) {
+      fraction *= 10;
+    }
+    qint64 cents = units * 100 + fraction + (roundUp ? 1 : 0);
+    if (ok) *ok = true;
+    return fromCents(negative ? -cents : cents);
+  }
+
+  constexpr qint64 cents() const { return _cents; }
+  double toDouble() const { return _cents / 100.0; }
+
+  // Format with exactly two decimals and a dot separator (file format)
+  QString toString() const {
+    const qint64 absCents = _cents < 0 ? -_cents : _cents;
+    QString result = QString::number(absCents / 100) + QLatin1Char('.') + QString::number(absCents % 100).rightJustified(2, QLatin1Char('0'));
+    return _cents < 0 ? QLatin1Char('-') + result : result;
+  }
+
+  // Format with a comma separator and the currency, like Theme.formatAmount() in QML
+  QString toDisplayString() const { return toString().replace(QLatin1Char('.'), QLatin1Char(',')) + QStringLiteral(" €"); }
+
+  constexpr bool isZero() const { return _cents == 0; }
+  constexpr Money abs() const { return fromCents(_cents < 0 ? -_cents : _cents); }
+
+  constexpr Money operator-() const { return fromCents(-_cents); }
+  constexpr Money& operator+=(Money other) {
+    _cents += other._cents;
+    return *this;
+  }
+  constexpr Money& operator-=(Money other) {
+    _cents -= other._cents;
+    return *this;
+  }
+
+  friend constexpr Money operator+(Money a, Money b) { return fromCents(a._cents + b._cents); }
+  friend constexpr Money operator-(Money a, Money b) { return fromCents(a._cents - b._cents); }
+  friend constexpr bool operator==(Money a, Money b) { return a._cents == b._cents; }
+  friend constexpr bool operator!=(Money a, Money b) { return a._cents != b._cents; }
+  friend constexpr bool operator<(Money a, Money b) { return a._cents < b._cents; }
+  friend constexpr bool operator<=(Money a, Money b) { return a._cents <= b._cents; }
+  friend constexpr bool operator>(Money a, Money b) { return a._cents > b._cents; }
+  friend constexpr bool operator>=(Money a, Money b) { return a._cents >= b._cents; }
+
+private:
+  qint64 _cents = 0;
+};
+
+inline size_t qHash(Money money, size_t seed = 0) {
+  return qHash(money.cents(), seed);
+}
+
+inline QDebug operator<<(QDebug debug, Money money) {
+  QDebugStateSaver saver(debug);
+  debug.nospace() << money.toString();
+  return debug;
+}
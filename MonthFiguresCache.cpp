@@ -0,0 +1,44 @@
+#include "MonthFiguresCache.h"
+
+MonthFiguresCache::MonthFiguresCache() :
+    _months(MaxMonths) {
+}
+
+const CategoryFigures* MonthFiguresCache::find(const Category* category, const QDate& month) const {
+  // QCache::object() refreshes the month in the LRU order
+  MonthEntry* entry = _months.object(key(month.year(), month.month()));
+  if (!entry)
+    return nullptr;
+  auto it = entry->constFind(category);
+  return it != entry->cend() ? &it.value() : nullptr;
+}
+
+void MonthFiguresCache::insert(const Category* category, const QDate& month, const CategoryFigures& figures) {
+  const int monthKey = key(month.year(), month.month());
+  MonthEntry* entry = _months.object(monthKey);
+  if (!entry) {
+    entry = new MonthEntry;
+    _months.insert(monthKey, entry);  // May evict the least recently used month
+  }
+  entry->insert(category, figures);
+}
+
+bool MonthFiguresCache::contains(const QDate& month) const {
+  return _months.contains(key(month.year(), month.month()));
+}
+
+void MonthFiguresCache::invalidate(const Category* category, int year, int month) {
+  if (MonthEntry* entry = _months.object(key(year, month))) {
+    entry->remove(category);
+  }
+}
+
+void MonthFiguresCache::invalidate(const Category* category) {
+  for (int monthKey : _months.keys()) {
+    _months.object(monthKey)->remove(category);
+  }
+}
+
+void MonthFiguresCache::clear() {
+  _months.clear();
+}
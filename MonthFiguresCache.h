@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QCache>
+#include <QDate>
+#include <QHash>
+
+#include "Money.h"
+
+class Category;
+
+// Budget figures of one category for one month
+struct CategoryFigures {
+  Money spent;
+  Money budgetLimit;
+  Money leftover;
+  Money accumulated;
+  Money saveAmount;
+  Money reportAmount;
+};
+
+// Least recently used cache of per-category figures for a few months.
+// Entries are filled on demand and invalidated per (category, month) or per category.
+class MonthFiguresCache {
+public:
+  static constexpr int MaxMonths = 6;
+
+  MonthFiguresCache();
+
+  const CategoryFigures* find(const Category* category, const QDate& month) const;
+  void insert(const Category* category, const QDate& month, const CategoryFigures& figures);
+
+  bool contains(const QDate& month) const;
+  void invalidate(const Category* category, int year, int month);
+  void invalidate(const Category* category);
+  void clear();
+
+private:
+  using MonthEntry = QHash<const Category*, CategoryFigures>;
+
+  static int key(int year, int month) { return year * 12 + month - 1; }
+
+  QCache<int, MonthEntry> _months;
+};
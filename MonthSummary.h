@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QObject>
+#include <QQmlEngine>
+
+#include "Money.h"
+
+// Budget totals of one month over all categories, computed in a single pass
+class MonthSummary {
+  Q_GADGET
+  QML_VALUE_TYPE(monthSummary)
+
+  Q_PROPERTY(double totalIncome READ totalIncome)
+  Q_PROPERTY(double totalExpense READ totalExpense)
+  Q_PROPERTY(double totalToSave READ totalToSave)
+  Q_PROPERTY(double totalToReport READ totalToReport)
+  Q_PROPERTY(double totalFromReport READ totalFromReport)
+  Q_PROPERTY(double netReport READ netReport)
+  Q_PROPERTY(int balancedCount READ balancedCount)
+
+public:
+  double totalIncome() const { return income.toDouble(); }
+  double totalExpense() const { return expense.toDouble(); }
+  double totalToSave() const { return toSave.toDouble(); }
+  double totalToReport() const { return toReport.toDouble(); }
+  double totalFromReport() const { return fromReport.toDouble(); }
+  double netReport() const { return (toReport - fromReport).toDouble(); }
+  int balancedCount() const { return balanced; }
+
+  Money income;      // Sum of positive budget limits
+  Money expense;     // Sum of negative budget limits, as a positive amount
+  Money toSave;      // Sum of save decisions
+  Money toReport;    // Sum of positive report decisions
+  Money fromReport;  // Sum of negative report decisions, as a positive amount
+  int balanced = 0;  // Categories whose budget, spent and leftover decisions balance out
+};
@@ -3,7 +3,7 @@
 
 Operation::Operation(Account* account,
                      const QDate& date,
-                     double amount,
+                     Money amount,
                      const QString& label,
                      const QString& details,
                      const QList<Allocation*>& allocations) :
@@ -70,36 +70,34 @@ bool Operation::sameAllocations(const QList<Allocation*>& otherAllocations) cons
 }
 
 bool Operation::isCategorized() const {
-  double totalAmount = 0.0;
+  Money totalAmount;
   for (auto allocation : _allocations) {
-    totalAmount += allocation->amount();
+    totalAmount += allocation->amountMoney();
   }
-  return qFuzzyCompare(totalAmount, _amount);
+  return totalAmount == _amount;
 }
 
 QString Operation::categoryDisplay() const {
-  QSet<QString> categoryNames;
-
-  // Return comma-separated list of categories
-  QSet<const Category*> uniqueCategories;
+  // Comma-separated list of categories, in allocation order
+  QStringList displayNames;
   for (const auto& alloc : _allocations) {
-    if (!uniqueCategories.contains(alloc->category())) {
-      uniqueCategories.insert(alloc->category());
+    if (alloc->category() && !displayNames.contains(alloc->category()->name())) {
+      displayNames.append(alloc->category()->name());
     }
   }
-  QStringList displayNames;
-  for (const Category* category : uniqueCategories) {
-    displayNames.append(category->name());
-  }
   return displayNames.join(", ");
 }
 
 double Operation::amountForCategory(const Category* category) const {
+  return amountMoneyForCategory(category).toDouble();
+}
+
+Money Operation::amountMoneyForCategory(const Category* category) const {
   // Split - sum all allocations for this category
-  double total = 0.0;
+  Money total;
   for (const auto& alloc : _allocations) {
     if (alloc->category() == category) {
-      total += alloc->amount();
+      total += alloc->amountMoney();
     }
   }
   return total;
@@ -18,17 +18,15 @@ class Allocation : public QObject {
   QML_ELEMENT
 
   PROPERTY_RW(const Category*, category, nullptr)
-  PROPERTY_RW(double, amount, 0.0)
+  PROPERTY_MONEY(amount, {})
 
 public:
-  explicit Allocation(const Category* c = nullptr, double a = 0.0, QObject* parent = nullptr) :
+  explicit Allocation(const Category* c = nullptr, Money a = {}, QObject* parent = nullptr) :
       QObject(parent), _category(c), _amount(a) {
   }
 
   bool operator==(const Allocation& other) const {
-    // qFuzzyCompare doesn't work well with zero values, use threshold comparison
-    constexpr double epsilon = 0.0001;
-    return _category == other._category && std::abs(_amount - other._amount) < epsilon;
+    return _category == other._category && _amount == other._amount;
   }
 
   bool operator!=(const Allocation& other) const { return !(*this == other); }
@@ -40,7 +38,7 @@ class Operation : public QObject {
 
   PROPERTY_CONSTANT(Account*, account, nullptr)
   PROPERTY_RW(QDate, date, {})
-  PROPERTY_RW(double, amount, 0.0)
+  PROPERTY_MONEY(amount, {})
   PROPERTY_RW(QString, label, {})
   PROPERTY_RW(QString, details, {})
 
@@ -56,7 +54,7 @@ class Operation : public QObject {
 public:
   Operation(Account* account = nullptr,
             const QDate& date = {},
-            double amount = 0.0,
+            Money amount = {},
             const QString& label = {},
             const QString& details = {},
             const QList<Allocation*>& allocations = {});
@@ -72,6 +70,7 @@ public:
 
   // Get amount allocated to a specific category (for budget calculations)
   Q_INVOKABLE double amountForCategory(const Category* category) const;
+  Money amountMoneyForCategory(const Category* category) const;
 
 signals:
   void allocationsChanged();
@@ -0,0 +1,102 @@
+#include <QDate>
+#include <string>
+
+#include "BudgetSnapshot.h"
+#include "Category.h"
+#include "Operation.h"
+#include "OperationYaml.h"
+
+namespace OperationYaml {
+
+// Helper to convert QString to std::string for yaml-cpp
+static std::string toStdString(const QString& s) {
+  return s.toStdString();
+}
+
+// Helper to safely read a string value from a YAML node
+static QString yamlString(const YAML::Node& node) {
+  if (!node.IsDefined() || node.IsNull()) {
+    return {};
+  }
+  return QString::fromStdString(node.as<std::string>());
+}
+
+void write(YAML::Emitter& out, const OperationSnapshot& operation, bool current) {
+  out << YAML::BeginMap;
+  out << YAML::Key << "date" << YAML::Value << toStdString(operation.date.toString("yyyy-MM-dd"));
+  out << YAML::Key << "amount" << YAML::Value << toStdString(operation.amount.toString());
+  out << YAML::Key << "label" << YAML::Value << toStdString(operation.label);
+
+  if (!operation.allocations.isEmpty()) {
+    // Handle split operations
+    out << YAML::Key << "allocations" << YAML::Value << YAML::BeginSeq;
+    for (const auto& alloc : operation.allocations) {
+      out << YAML::BeginMap;
+      if (!alloc.category.isEmpty()) {
+        out << YAML::Key << "category" << YAML::Value << toStdString(alloc.category);
+      }
+      out << YAML::Key << "amount" << YAML::Value << toStdString(alloc.amount.toString());
+      out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+  }
+
+  // Only save budget_date if explicitly set (different from operation date)
+  if (operation.budgetDate != operation.date) {
+    out << YAML::Key << "budget_date" << YAML::Value << toStdString(operation.budgetDate.toString("yyyy-MM-dd"));
+  }
+  // Mark current operation for this account
+  if (current) {
+    out << YAML::Key << "current" << YAML::Value << "true";
+  }
+
+  out << YAML::EndMap;
+}
+
+void write(YAML::Emitter& out, const Operation& operation, bool current) {
+  write(out, OperationSnapshot::capture(operation), current);
+}
+
+Operation* read(const YAML::Node& node, Account* account, const CategoryLookup& categoryByName) {
+  auto op = new Operation(account);
+  if (node["date"]) {
+    op->set_date(QDate::fromString(yamlString(node["date"]), "yyyy-MM-dd"));
+  }
+  if (node["amount"]) {
+    op->set_amount(Money::fromString(yamlString(node["amount"])));
+  }
+  // Handle split operations (allocations) vs single category
+  if (node["allocations"]) {
+    QList<Allocation*> allocations;
+    for (const auto& allocNode : node["allocations"]) {
+      if (allocNode["category"] && allocNode["amount"]) {
+        allocations.append(new Allocation(
+            categoryByName(yamlString(allocNode["category"])),
+            Money::fromString(yamlString(allocNode["amount"]))));
+      }
+    }
+    op->setAllocations(allocations);
+  } else if (node["category"]) {  // Support for old format (<= 0.14)
+    auto category = categoryByName(yamlString(node["category"]));
+    op->setAllocations({ new Allocation(category, op->amountMoney()) });
+  }
+
+  if (node["label"]) {
+    op->set_label(yamlString(node["label"]));
+  } else if (node["description"]) {
+    op->set_label(yamlString(node["description"]));
+  }
+  if (node["details"]) {
+    op->set_details(yamlString(node["details"]));
+  }
+  if (node["budget_date"]) {
+    op->set_budgetDate(QDate::fromString(yamlString(node["budget_date"]), "yyyy-MM-dd"));
+  }
+  return op;
+}
+
+bool isCurrent(const YAML::Node& node) {
+  return node["current"] && yamlString(node["current"]).toLower() == "true";
+}
+
+}  // namespace OperationYaml
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <yaml-cpp/yaml.h>
+
+#include <QString>
+#include <functional>
+
+class Account;
+class Category;
+class Operation;
+struct OperationSnapshot;
+
+// YAML format of an operation, shared by budget files and archive shards
+namespace OperationYaml {
+
+using CategoryLookup = std::function<Category*(const QString& name)>;
+
+// Write an operation map, `current` marks the current operation of its account
+void write(YAML::Emitter& out, const OperationSnapshot& operation, bool current = false);
+void write(YAML::Emitter& out, const Operation& operation, bool current = false);
+
+// Read an operation map, in the current or any legacy format
+Operation* read(const YAML::Node& node, Account* account, const CategoryLookup& categoryByName);
+
+// Whether an operation map is marked as the current operation of its account
+bool isCurrent(const YAML::Node& node);
+
+}  // namespace OperationYaml
@@ -12,12 +12,16 @@ BaseDialog {
     property string originalLanguage: ""
     property string originalTheme: ""
     property bool originalCheckForUpdates: true
+    property bool originalAutosave: false
+    property int originalUndoLimit: 0
 
     onOpened: {
         // Save original values to restore on cancel
         originalLanguage = AppSettings.language;
         originalTheme = AppSettings.theme;
         originalCheckForUpdates = AppSettings.checkForUpdates;
+        originalAutosave = AppSettings.autosave;
+        originalUndoLimit = AppSettings.undoLimit;
 
         // Set initial language combo box value
         if (AppSettings.language === "") {
@@ -39,6 +43,9 @@ BaseDialog {
 
         // Set initial update checkbox value
         updateCheckBox.checked = AppSettings.checkForUpdates;
+        autosaveCheckBox.checked = AppSettings.autosave;
+        undoLimitCheckBox.checked = AppSettings.undoLimit > 0;
+        undoLimitSpinBox.value = AppSettings.undoLimit > 0 ? AppSettings.undoLimit : 500;
     }
 
     onRejected: {
@@ -52,6 +59,12 @@ BaseDialog {
         if (AppSettings.checkForUpdates !== originalCheckForUpdates) {
             AppSettings.checkForUpdates = originalCheckForUpdates;
         }
+        if (AppSettings.autosave !== originalAutosave) {
+            AppSettings.autosave = originalAutosave;
+        }
+        if (AppSettings.undoLimit !== originalUndoLimit) {
+            AppSettings.undoLimit = originalUndoLimit;
+        }
     }
 
     ColumnLayout {
@@ -114,6 +127,46 @@ BaseDialog {
                     AppSettings.checkForUpdates = checked;
                 }
             }
+
+            Label {
+                text: qsTr("Saving:")
+            }
+
+            CheckBox {
+                id: autosaveCheckBox
+                text: qsTr("Save automatically after each change")
+                onToggled: {
+                    AppSettings.autosave = checked;
+                }
+            }
+
+            Label {
+                text: qsTr("Undo:")
+            }
+
+            RowLayout {
+                CheckBox {
+                    id: undoLimitCheckBox
+                    text: qsTr("Limit the number of undo steps")
+                    onToggled: {
+                        AppSettings.undoLimit = checked ? undoLimitSpinBox.value : 0;
+                    }
+                }
+
+                SpinBox {
+                    id: undoLimitSpinBox
+                    enabled: undoLimitCheckBox.checked
+                    from: 10
+                    to: 10000
+                    stepSize: 50
+                    editable: true
+                    ToolTip.visible: hovered
+                    ToolTip.text: qsTr("Applies from the next opened file")
+                    onValueModified: {
+                        AppSettings.undoLimit = value;
+                    }
+                }
+            }
         }
     }
 }
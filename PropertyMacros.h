@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Money.h"
+
 #define PROPERTY_RW(Type, name, defaultValue)                           \
   Q_PROPERTY(Type name READ name WRITE set_##name NOTIFY name##Changed) \
 public:                                                                 \
@@ -43,3 +45,22 @@ Q_SIGNALS:                                                              \
                                                                         \
 private:                                                                \
   Type _##name = defaultValue;
+
+// Money-backed property: stored as exact cents, exposed to QML as a double
+#define PROPERTY_MONEY(name, defaultValue)                                   \
+  Q_PROPERTY(double name READ name WRITE set_##name NOTIFY name##Changed)    \
+public:                                                                      \
+  double name() const { return _##name.toDouble(); }                         \
+  Money name##Money() const { return _##name; }                              \
+  Q_INVOKABLE void set_##name(double value) { set_##name(Money(value)); }    \
+  void set_##name(Money value) {                                             \
+    if (_##name != value) {                                                  \
+      _##name = value;                                                       \
+      emit name##Changed();                                                  \
+    }                                                                        \
+  }                                                                          \
+Q_SIGNALS:                                                                   \
+  void name##Changed();                                                      \
+                                                                             \
+private:                                                                     \
+  Money _##name = defaultValue;
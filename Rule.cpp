@@ -8,30 +8,170 @@ Rule::Rule(QObject* parent) :
 
 Rule::Rule(const Category* category,
            const QString& labelMatch,
-           double amountFilter,
+           Money amountFilter,
+           MatchMode matchMode,
            QObject* parent) :
     QObject(parent) {
   _category = category;
   _labelMatch = labelMatch;
   _amountFilter = amountFilter;
+  _matchMode = matchMode;
+  compile();
+}
+
+QString Rule::labelMatch() const {
+  return _labelMatch;
+}
+
+void Rule::set_labelMatch(QString value) {
+  if (_labelMatch != value) {
+    _labelMatch = value;
+    compile();
+    emit labelMatchChanged();
+  }
+}
+
+Rule::MatchMode Rule::matchMode() const {
+  return _matchMode;
+}
+
+void Rule::set_matchMode(MatchMode value) {
+  if (_matchMode != value) {
+    _matchMode = value;
+    compile();
+    emit matchModeChanged();
+  }
+}
+
+QString Rule::matchModeName(MatchMode mode) {
+  switch (mode) {
+    case MatchMode::Contains:
+      return QStringLiteral("contains");
+    case MatchMode::Prefix:
+      return QStringLiteral("prefix");
+    case MatchMode::Exact:
+      return QStringLiteral("exact");
+    case MatchMode::WholeWord:
+      return QStringLiteral("word");
+    case MatchMode::Regex:
+      return QStringLiteral("regex");
+  }
+  return QString();
+}
+
+Rule::MatchMode Rule::matchModeFromName(const QString& name, bool* ok) {
+  for (MatchMode mode : { MatchMode::Contains, MatchMode::Prefix, MatchMode::Exact, MatchMode::WholeWord, MatchMode::Regex }) {
+    if (name.compare(matchModeName(mode), Qt::CaseInsensitive) == 0) {
+      if (ok) *ok = true;
+      return mode;
+    }
+  }
+  if (ok) *ok = false;
+  return MatchMode::Contains;
+}
+
+QString Rule::matchError(const QString& labelMatch, MatchMode mode) {
+  const QRegularExpression regex = expression(labelMatch, mode);
+  return regex.isValid() ? QString() : regex.errorString();
 }
 
 bool Rule::matches(Operation* operation) const {
   if (!operation) {
     return false;
   }
+  return matchesLabel(operation->label()) && matchesAmount(operation->amountMoney());
+}
+
+bool Rule::matchesLabel(const QString& label) const {
   if (_labelMatch.isEmpty()) {
     return false;
   }
-  // Case-insensitive prefix match
-  if (!operation->label().contains(_labelMatch, Qt::CaseInsensitive)) {
-    return false;
+  switch (_matchMode) {
+    case MatchMode::Contains:
+      return label.contains(_labelMatch, Qt::CaseInsensitive);
+    case MatchMode::Prefix:
+      return label.startsWith(_labelMatch, Qt::CaseInsensitive);
+    case MatchMode::Exact:
+      return label.compare(_labelMatch, Qt::CaseInsensitive) == 0;
+    case MatchMode::WholeWord:
+    case MatchMode::Regex:
+      return _expression.isValid() && _expression.match(label).hasMatch();
   }
-  // If amount filter is set, check it matches
-  if (_amountFilter != 0) {
-    if (!qFuzzyCompare(_amountFilter, operation->amount())) {
+  return false;
+}
+
+bool Rule::shadows(const Rule& other) const {
+  if (matchesNothing() || other.matchesNothing())
+    return false;
+  if (!_amountFilter.isZero() && _amountFilter != other._amountFilter)
+    return false;
+
+  const QString& match = _foldedLabelMatch;
+  const QString& otherMatch = other._foldedLabelMatch;
+  switch (other._matchMode) {
+    case MatchMode::Exact:
+      return matchesLabel(other._labelMatch);  // The only label it matches
+    case MatchMode::Contains:
+      return _matchMode == MatchMode::Contains && otherMatch.contains(match);
+    case MatchMode::Prefix:
+      return (_matchMode == MatchMode::Contains && otherMatch.contains(match))
+             || (_matchMode == MatchMode::Prefix && otherMatch.startsWith(match));
+    case MatchMode::WholeWord:
+      // A whole word of the other match is a whole word of the labels it matches
+      return (_matchMode == MatchMode::Contains && otherMatch.contains(match))
+             || (_matchMode == MatchMode::WholeWord && matchesLabel(other._labelMatch));
+    case MatchMode::Regex:
       return false;
-    }
+  }
+  return false;
+}
+
+bool Rule::mayOverlap(const Rule& other) const {
+  if (matchesNothing() || other.matchesNothing())
+    return false;
+  if (!_amountFilter.isZero() && !other._amountFilter.isZero() && _amountFilter != other._amountFilter)
+    return false;
+
+  if (_matchMode == MatchMode::Exact)
+    return other.matchesLabel(_labelMatch);
+  if (other._matchMode == MatchMode::Exact)
+    return matchesLabel(other._labelMatch);
+  if (_matchMode == MatchMode::Prefix && other._matchMode == MatchMode::Prefix) {
+    return _foldedLabelMatch.startsWith(other._foldedLabelMatch) || other._foldedLabelMatch.startsWith(_foldedLabelMatch);
   }
   return true;
 }
+
+void Rule::recordMatch(const QDate& date) {
+  _statistics.matches++;
+  if (!_statistics.lastMatchDate.isValid() || date > _statistics.lastMatchDate) {
+    _statistics.lastMatchDate = date;
+  }
+}
+
+QRegularExpression Rule::expression(const QString& labelMatch, MatchMode mode) {
+  const auto options = QRegularExpression::CaseInsensitiveOption | QRegularExpression::UseUnicodePropertiesOption;
+  switch (mode) {
+    case MatchMode::Contains:
+    case MatchMode::Prefix:
+    case MatchMode::Exact:
+      return QRegularExpression();
+    case MatchMode::WholeWord:
+      return QRegularExpression(QStringLiteral("(?<!\\w)%1(?!\\w)").arg(QRegularExpression::escape(labelMatch)), options);
+    case MatchMode::Regex:
+      return QRegularExpression(labelMatch, options);
+  }
+  return QRegularExpression();
+}
+
+bool Rule::matchesNothing() const {
+  return _labelMatch.isEmpty() || (_matchMode == MatchMode::Regex && !_expression.isValid());
+}
+
+void Rule::compile() {
+  _foldedLabelMatch = _labelMatch.toCaseFolded();
+  _expression = expression(_labelMatch, _matchMode);
+  if (!_expression.pattern().isEmpty() && _expression.isValid()) {
+    _expression.optimize();  // Compile now rather than on the first operation
+  }
+}
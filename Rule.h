@@ -1,7 +1,9 @@
 #pragma once
 
 #include <QtQml/qqml.h>
+#include <QDate>
 #include <QObject>
+#include <QRegularExpression>
 #include <QString>
 
 #include "Category.h"
@@ -13,19 +15,69 @@ class Rule : public QObject {
   Q_OBJECT
   QML_ELEMENT
 
+public:
+  // How labelMatch is compared to operation labels, always ignoring case
+  enum class MatchMode {
+    Contains,
+    Prefix,
+    Exact,
+    WholeWord,  // Contained, between word boundaries
+    Regex,
+  };
+  Q_ENUM(MatchMode)
+
+  // Matching statistics, kept for the session only
+  struct Statistics {
+    int evaluations = 0;  // Operations the rule was tested against
+    int matches = 0;      // Operations it categorized
+    QDate lastMatchDate;  // Latest operation it categorized
+  };
+
   PROPERTY_RW(const Category*, category, nullptr)
-  PROPERTY_RW(QString, labelMatch, QString())
+  PROPERTY_RW_CUSTOM(QString, labelMatch, QString())
+  PROPERTY_RW_CUSTOM(MatchMode, matchMode, MatchMode::Contains)
 
   // Optional amount filter (0 means no filter)
-  PROPERTY_RW(double, amountFilter, 0)
+  PROPERTY_MONEY(amountFilter, {})
 
 public:
   explicit Rule(QObject* parent = nullptr);
   Rule(const Category* category,
        const QString& labelMatch,
-       double amountFilter = 0.,
+       Money amountFilter = {},
+       MatchMode matchMode = MatchMode::Contains,
        QObject* parent = nullptr);
 
+  // Names of the modes in files ("contains", "prefix", "exact", "word", "regex")
+  static QString matchModeName(MatchMode mode);
+  static MatchMode matchModeFromName(const QString& name, bool* ok = nullptr);
+
+  // Why a match cannot be used, empty if it is valid (regular expression errors)
+  Q_INVOKABLE static QString matchError(const QString& labelMatch, MatchMode mode);
+
   // Check if this rule matches an operation
   Q_INVOKABLE bool matches(Operation* operation) const;
+  bool matchesLabel(const QString& label) const;
+  bool matchesAmount(Money amount) const { return _amountFilter.isZero() || _amountFilter == amount; }
+  const QString& foldedLabelMatch() const { return _foldedLabelMatch; }  // For case insensitive comparisons
+
+  // Whether every operation matching other also matches this rule. Only provable cases
+  // are detected, regular expressions never shadow anything but exact matches.
+  bool shadows(const Rule& other) const;
+  // Whether an operation may match both rules, false only when they provably cannot
+  bool mayOverlap(const Rule& other) const;
+
+  const Statistics& statistics() const { return _statistics; }
+  void recordEvaluation() { _statistics.evaluations++; }
+  void recordMatch(const QDate& date);
+  void resetStatistics() { _statistics = {}; }
+
+private:
+  static QRegularExpression expression(const QString& labelMatch, MatchMode mode);
+  void compile();
+  bool matchesNothing() const;
+
+  QRegularExpression _expression;  // Compiled once for the regex and whole word modes
+  QString _foldedLabelMatch;
+  Statistics _statistics;
 };
@@ -1,3 +1,4 @@
+#include <QElapsedTimer>
 #include <QUndoStack>
 
 #include "Account.h"
@@ -14,6 +15,18 @@ RuleController::RuleController(BudgetData& budgetData,
     _undoStack(undoStack) {
   _ruleModel = new RuleListModel(this);
   _ruleModel->setRuleController(this);
+  _suggester = new CategorySuggester(budgetData, undoStack, this);
+  _preview = new RulePreviewModel(budgetData, *this, this);
+  connect(this, &RuleController::rulesChanged, this, [this] {
+    _matcherDirty = true;
+  });
+  // Statistics are notified once per batch, an import applies rules to each of its operations
+  connect(&_budgetData, &BudgetData::batchEnded, this, [this] {
+    if (_statisticsPending) {
+      _statisticsPending = false;
+      emit statisticsChanged();
+    }
+  });
 }
 
 RuleController::~RuleController() {
@@ -32,32 +45,16 @@ Rule* RuleController::getRule(int index) const {
 }
 
 void RuleController::addRule(Rule* rule) {
-  if (!rule) {
-    return;
-  }
-
-  // Check for duplicate (same match + same amount filter)
-  for (const Rule* existing : _rules) {
-    if (existing->labelMatch().compare(rule->labelMatch(), Qt::CaseInsensitive) == 0
-        && qFuzzyCompare(existing->amountFilter(), rule->amountFilter())) {
-      qWarning() << "Rule with same match and amount already exists:" << rule->labelMatch();
-      return;
-    }
-  }
-
-  rule->setParent(this);
-  _rules.append(rule);
-  _ruleModel->refresh();
-  emit ruleCountChanged();
-  emit rulesChanged();
+  insertRule(_rules.size(), rule);
 }
 
-void RuleController::addRule(const Category* category, const QString& labelMatch, double amountFilter) {
-  if (category == nullptr || labelMatch.isEmpty()) {
+void RuleController::addRule(const Category* category, const QString& labelMatch, double amountFilter,
+                             Rule::MatchMode matchMode) {
+  if (category == nullptr || labelMatch.isEmpty() || !Rule::matchError(labelMatch, matchMode).isEmpty()) {
     return;
   }
 
-  auto* rule = new Rule(category, labelMatch, amountFilter, this);
+  auto* rule = new Rule(category, labelMatch, amountFilter, matchMode, this);
   _undoStack.push(new AddRuleCommand(this, rule));
 }
 
@@ -69,31 +66,33 @@ void RuleController::removeRule(int index) {
   _undoStack.push(new RemoveRuleCommand(this, index));
 }
 
-void RuleController::editRule(int index, const Category* category, const QString& labelMatch, double amountFilter) {
+void RuleController::editRule(int index, const Category* category, const QString& labelMatch, double amountFilter,
+                              Rule::MatchMode matchMode) {
   if (index < 0 || index >= _rules.size()) {
     return;
   }
+  if (!Rule::matchError(labelMatch, matchMode).isEmpty()) {
+    return;
+  }
 
   Rule* rule = _rules[index];
   if (rule->category() == category && rule->labelMatch() == labelMatch
-      && qFuzzyCompare(rule->amountFilter(), amountFilter)) {
+      && rule->amountFilterMoney() == Money(amountFilter) && rule->matchMode() == matchMode) {
     return;  // No change
   }
 
-  // Check for duplicate (same match + same amount filter), excluding the rule being edited
-  for (int i = 0; i < _rules.size(); i++) {
-    if (i != index
-        && _rules[i]->labelMatch().compare(labelMatch, Qt::CaseInsensitive) == 0
-        && qFuzzyCompare(_rules[i]->amountFilter(), amountFilter)) {
-      qWarning() << "Rule with same match and amount already exists:" << labelMatch;
-      return;
-    }
+  // Excluding the rule being edited
+  Rule* existing = findRule(labelMatch, matchMode, amountFilter);
+  if (existing && existing != rule) {
+    qWarning() << "Rule with same match and amount already exists:" << labelMatch;
+    return;
   }
 
   _undoStack.push(new EditRuleCommand(this, index,
                                       rule->category(), category,
                                       rule->labelMatch(), labelMatch,
-                                      rule->amountFilter(), amountFilter));
+                                      rule->amountFilterMoney(), amountFilter,
+                                      rule->matchMode(), matchMode));
 }
 
 void RuleController::moveRule(int fromIndex, int toIndex) {
@@ -121,28 +120,57 @@ void RuleController::moveRuleDirect(int fromIndex, int toIndex) {
     return;
   }
 
-  Rule* rule = _rules.takeAt(fromIndex);
-  _rules.insert(toIndex, rule);
-
-  _ruleModel->refresh();
+  _ruleModel->beginMoveRule(fromIndex, toIndex);
+  _rules.move(fromIndex, toIndex);
+  _ruleModel->endMoveRule();
   emit rulesChanged();
 }
 
 void RuleController::clearRules() {
+  _preview->cancel();
   qDeleteAll(_rules);
   _rules.clear();
+  _rulesByKey.clear();
+  _ruleKeys.clear();
   _ruleModel->refresh();
   emit ruleCountChanged();
   emit rulesChanged();
 }
 
+void RuleController::insertRule(int index, Rule* rule) {
+  if (!rule) {
+    return;
+  }
+
+  if (findRule(rule->labelMatch(), rule->matchMode(), rule->amountFilterMoney())) {
+    qWarning() << "Rule with same match and amount already exists:" << rule->labelMatch();
+    return;
+  }
+
+  index = qBound(0, index, int(_rules.size()));
+  rule->setParent(this);
+  connect(rule, &Rule::categoryChanged, this, [this, rule] { ruleEdited(rule); });
+  connect(rule, &Rule::labelMatchChanged, this, [this, rule] { ruleEdited(rule); });
+  connect(rule, &Rule::matchModeChanged, this, [this, rule] { ruleEdited(rule); });
+  connect(rule, &Rule::amountFilterChanged, this, [this, rule] { ruleEdited(rule); });
+  _ruleModel->beginInsertRule(index);
+  _rules.insert(index, rule);
+  indexRule(rule);
+  _ruleModel->endInsertRule();
+  emit ruleCountChanged();
+  emit rulesChanged();
+}
+
 Rule* RuleController::takeRule(int index) {
   if (index < 0 || index >= _rules.size()) {
     return nullptr;
   }
 
+  _ruleModel->beginRemoveRule(index);
   Rule* rule = _rules.takeAt(index);
-  _ruleModel->refresh();
+  disconnect(rule, nullptr, this, nullptr);
+  unindexRule(rule);
+  _ruleModel->endRemoveRule();
   emit ruleCountChanged();
   emit rulesChanged();
   return rule;
@@ -153,12 +181,97 @@ const Category* RuleController::matchingCategory(Operation* operation) const {
     return nullptr;
   }
   // Use full matching (label + optional amount) so amount-filtered rules work
-  for (const Rule* rule : _rules) {
-    if (rule->matches(operation)) {
-      return rule->category();
+  const int position = matcher().firstMatch(operation->label(), operation->amountMoney());
+  return position >= 0 ? _rules[position]->category() : nullptr;
+}
+
+void RuleController::resetStatistics() {
+  for (Rule* rule : std::as_const(_rules)) {
+    rule->resetStatistics();
+  }
+  _matchingNanoseconds = 0;
+  notifyStatistics();
+}
+
+int RuleController::shadowingRule(int index) const {
+  if (index < 0 || index >= _rules.size()) {
+    return -1;
+  }
+  for (int i = 0; i < index; i++) {
+    if (_rules[i]->shadows(*_rules[index])) {
+      return i;
     }
   }
-  return nullptr;
+  return -1;
+}
+
+QList<int> RuleController::shadowingRules() const {
+  QList<int> shadowing;
+  shadowing.reserve(_rules.size());
+  for (int i = 0; i < _rules.size(); i++) {
+    shadowing.append(shadowingRule(i));
+  }
+  return shadowing;
+}
+
+QList<int> RuleController::frequencyOrder() const {
+  // Stable topological sort of the rules, where a rule must stay after every earlier rule it
+  // may conflict with, taking the most matched rule available first
+  const int count = _rules.size();
+  QList<QList<int>> successors(count);
+  QList<int> predecessorCounts(count, 0);
+  for (int i = 0; i < count; i++) {
+    for (int j = i + 1; j < count; j++) {
+      if (_rules[i]->category() != _rules[j]->category() && _rules[i]->mayOverlap(*_rules[j])) {
+        successors[i].append(j);
+        predecessorCounts[j]++;
+      }
+    }
+  }
+
+  QList<int> order;
+  QList<bool> placed(count, false);
+  while (order.size() < count) {
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+      if (!placed[i] && predecessorCounts[i] == 0
+          && (best < 0 || _rules[i]->statistics().matches > _rules[best]->statistics().matches)) {
+        best = i;
+      }
+    }
+    placed[best] = true;
+    order.append(best);
+    for (int successor : std::as_const(successors[best])) {
+      predecessorCounts[successor]--;
+    }
+  }
+  return order;
+}
+
+bool RuleController::reorderByFrequency() {
+  const QList<int> order = frequencyOrder();
+  QList<int> positions;  // Original position of the rule at each position, as the moves are made
+  for (int i = 0; i < _rules.size(); i++) {
+    positions.append(i);
+  }
+
+  auto* macroCommand = new QUndoCommand(tr("Reorder rules by frequency"));
+  int moves = 0;
+  for (int target = 0; target < order.size(); target++) {
+    const int from = positions.indexOf(order[target]);
+    if (from != target) {
+      new MoveRuleCommand(this, from, target, macroCommand);
+      positions.move(from, target);
+      moves++;
+    }
+  }
+
+  if (moves == 0) {
+    delete macroCommand;
+    return false;
+  }
+  _undoStack.push(macroCommand);
+  return true;
 }
 
 int RuleController::applyRulesToOperation(Operation* operation) {
@@ -166,32 +279,61 @@ int RuleController::applyRulesToOperation(Operation* operation) {
     return 0;
   }
 
-  if (auto category = matchingCategory(operation)) {
-    operation->setAllocations({ new Allocation(category, operation->amount()) });
+  QElapsedTimer timer;
+  timer.start();
+  QList<int> tested;
+  const int position = matcher().firstMatch(operation->label(), operation->amountMoney(), &tested);
+  _matchingNanoseconds += timer.nsecsElapsed();
+
+  for (int index : std::as_const(tested)) {
+    _rules[index]->recordEvaluation();
+  }
+  if (position >= 0) {
+    _rules[position]->recordMatch(operation->date());
+  }
+  notifyStatistics();
+
+  if (position >= 0 && _rules[position]->category()) {
+    operation->setAllocations({ new Allocation(_rules[position]->category(), operation->amountMoney()) });
     return 1;
   }
   return 0;
 }
 
-int RuleController::applyRuleToUncategorized(const Category* category, const QString& labelMatch, double amountFilter) {
+int RuleController::applyRuleToUncategorized(const Category* category, const QString& labelMatch, double amountFilter,
+                                             Rule::MatchMode matchMode) {
   if (!category || labelMatch.isEmpty()) {
     return 0;
   }
 
-  // Create a temporary rule for matching
-  Rule tempRule;
-  tempRule.set_category(category);
-  tempRule.set_labelMatch(labelMatch);
-  tempRule.set_amountFilter(amountFilter);
+  // Create a temporary rule for matching, its expression is compiled once for all operations
+  Rule tempRule(category, labelMatch, amountFilter, matchMode);
+
+  // Statistics go to the rule with the same match, usually just added
+  Rule* rule = findRule(labelMatch, matchMode, amountFilter);
 
-  QUndoCommand* macroCommand = new QUndoCommand();
+  QUndoCommand* macroCommand = new BatchCommand(_budgetData);
   int count = 0;
+  qint64 matchingNanoseconds = 0;
+  QElapsedTimer timer;
 
+  _budgetData.requireAllAccounts();
   for (Account* account : _budgetData.accounts()) {
     for (Operation* op : account->operations()) {
-      if (!op->isCategorized() && tempRule.matches(op)) {
+      if (op->isCategorized())
+        continue;
+      timer.start();
+      const bool matches = tempRule.matches(op);
+      matchingNanoseconds += timer.nsecsElapsed();
+      if (rule) {
+        rule->recordEvaluation();
+        if (matches) {
+          rule->recordMatch(op->date());
+        }
+      }
+      if (matches) {
         QList<Allocation*> newAllocations;
-        newAllocations.append(new Allocation(category, op->amount()));
+        newAllocations.append(new Allocation(category, op->amountMoney()));
         new SplitOperationCommand(*op,
                                   newAllocations, macroCommand);
         count++;
@@ -199,6 +341,9 @@ int RuleController::applyRuleToUncategorized(const Category* category, const QSt
     }
   }
 
+  _matchingNanoseconds += matchingNanoseconds;
+  notifyStatistics();
+
   if (count > 0) {
     _undoStack.push(macroCommand);
   } else {
@@ -210,6 +355,7 @@ int RuleController::applyRuleToUncategorized(const Category* category, const QSt
 
 Operation* RuleController::nextUncategorizedOperation(Operation* current) const {
   bool foundCurrent = current == nullptr;
+  _budgetData.requireAllAccounts();
   for (Account* account : _budgetData.accounts()) {
     for (Operation* op : account->operations()) {
       if (op == current) {
@@ -230,6 +376,7 @@ Operation* RuleController::previousUncategorizedOperation(Operation* current) co
   }
 
   Operation* previousUncategorized = nullptr;
+  _budgetData.requireAllAccounts();
   for (Account* account : _budgetData.accounts()) {
     for (Operation* op : account->operations()) {
       if (op == current) {
@@ -242,3 +389,47 @@ Operation* RuleController::previousUncategorizedOperation(Operation* current) co
   }
   return nullptr;
 }
+
+QString RuleController::ruleKey(const QString& labelMatch, Rule::MatchMode matchMode, Money amountFilter) {
+  // Same match, ignoring case, and same amount filter. Case matters in the syntax of a regular
+  // expression (\d and \D are opposites), so those are compared as written.
+  const QString match = matchMode == Rule::MatchMode::Regex ? labelMatch : labelMatch.toCaseFolded();
+  return QStringLiteral("%1:%2:%3").arg(static_cast<int>(matchMode)).arg(amountFilter.cents()).arg(match);
+}
+
+Rule* RuleController::findRule(const QString& labelMatch, Rule::MatchMode matchMode, Money amountFilter) const {
+  return _rulesByKey.value(ruleKey(labelMatch, matchMode, amountFilter), nullptr);
+}
+
+void RuleController::indexRule(Rule* rule) {
+  const QString key = ruleKey(rule->labelMatch(), rule->matchMode(), rule->amountFilterMoney());
+  _rulesByKey.insert(key, rule);
+  _ruleKeys.insert(rule, key);
+}
+
+void RuleController::unindexRule(Rule* rule) {
+  _rulesByKey.remove(_ruleKeys.take(rule), rule);
+}
+
+void RuleController::ruleEdited(Rule* rule) {
+  _matcherDirty = true;
+  unindexRule(rule);
+  indexRule(rule);
+  _ruleModel->ruleChanged(_rules.indexOf(rule));
+}
+
+const RuleMatcher& RuleController::matcher() const {
+  if (_matcherDirty) {
+    _matcher.rebuild(_rules);
+    _matcherDirty = false;
+  }
+  return _matcher;
+}
+
+void RuleController::notifyStatistics() {
+  if (_budgetData.isBatching()) {
+    _statisticsPending = true;
+  } else {
+    emit statisticsChanged();
+  }
+}
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <QtQml/qqml.h>
+#include <QHash>
 #include <QList>
+#include <QMultiHash>
 
 #include "Category.h"
+#include "CategorySuggester.h"
 #include "PropertyMacros.h"
 #include "RuleListModel.h"
+#include "RuleMatcher.h"
+#include "RulePreviewModel.h"
+#include "Rule.h"
 
 class BudgetData;
-class Rule;
 class Operation;
 class QUndoStack;
 
@@ -19,6 +24,9 @@ class RuleController : public QObject {
   PROPERTY_RO(int, ruleCount)
 
   Q_PROPERTY(RuleListModel* ruleModel READ ruleModel CONSTANT)
+  Q_PROPERTY(CategorySuggester* suggester READ suggester CONSTANT)
+  Q_PROPERTY(RulePreviewModel* preview READ preview CONSTANT)
+  Q_PROPERTY(double matchingTime READ matchingTime NOTIFY statisticsChanged)  // Milliseconds spent applying rules
 
 public:
   explicit RuleController(BudgetData& budgetData,
@@ -29,27 +37,47 @@ public:
   QList<Rule*> rules() const { return _rules; }
   Q_INVOKABLE Rule* getRule(int index) const;
   RuleListModel* ruleModel() { return _ruleModel; }
+  CategorySuggester* suggester() { return _suggester; }
+  RulePreviewModel* preview() { return _preview; }  // Impact of rule changes before making them
 
   // Rule management
   void addRule(Rule* rule);
-  Q_INVOKABLE void addRule(const Category* category, const QString& labelMatch, double amountFilter = 0);
+  Q_INVOKABLE void addRule(const Category* category, const QString& labelMatch, double amountFilter = 0,
+                           Rule::MatchMode matchMode = Rule::MatchMode::Contains);
   Q_INVOKABLE void removeRule(int index);
-  Q_INVOKABLE void editRule(int index, const Category* category, const QString& labelMatch, double amountFilter = 0);
+  Q_INVOKABLE void editRule(int index, const Category* category, const QString& labelMatch, double amountFilter = 0,
+                            Rule::MatchMode matchMode = Rule::MatchMode::Contains);
   Q_INVOKABLE void moveRule(int fromIndex, int toIndex);
   void clearRules();
 
   // For undo/redo support
+  void insertRule(int index, Rule* rule);
   Rule* takeRule(int index);
   void moveRuleDirect(int fromIndex, int toIndex);
 
   // Matching operations
   Q_INVOKABLE const Category* matchingCategory(Operation* operation) const;
 
+  // Statistics of the rules applied since loading, by rule (see Rule::statistics)
+  double matchingTime() const { return _matchingNanoseconds / 1e6; }
+  Q_INVOKABLE void resetStatistics();
+
+  // Position of the first earlier rule shadowing the rule at index (-1 if none): a shadowed
+  // rule never categorizes anything
+  int shadowingRule(int index) const;
+  QList<int> shadowingRules() const;  // shadowingRule of each rule
+  // Positions of the rules ordered by decreasing match count, keeping the order of every two
+  // rules which may match the same operation with different categories, so that each operation
+  // still gets the same category
+  Q_INVOKABLE QList<int> frequencyOrder() const;
+  Q_INVOKABLE bool reorderByFrequency();  // In a single undo step, returns whether the order changed
+
   // Apply rules to operations (used during import)
   int applyRulesToOperation(Operation* operation);
 
   // Apply a specific rule to all uncategorized operations (used after creating a new rule)
-  Q_INVOKABLE int applyRuleToUncategorized(const Category* category, const QString& labelMatch, double amountFilter = 0);
+  Q_INVOKABLE int applyRuleToUncategorized(const Category* category, const QString& labelMatch, double amountFilter = 0,
+                                           Rule::MatchMode matchMode = Rule::MatchMode::Contains);
 
   // Navigation between uncategorized operations (for OperationEditDialog)
   Q_INVOKABLE Operation* nextUncategorizedOperation(Operation* current) const;
@@ -57,10 +85,27 @@ public:
 
 signals:
   void rulesChanged();
+  void statisticsChanged();
 
 private:
+  static QString ruleKey(const QString& labelMatch, Rule::MatchMode matchMode, Money amountFilter);
+  Rule* findRule(const QString& labelMatch, Rule::MatchMode matchMode, Money amountFilter) const;
+  void indexRule(Rule* rule);
+  void unindexRule(Rule* rule);
+  void ruleEdited(Rule* rule);
+  const RuleMatcher& matcher() const;
+  void notifyStatistics();
+
   QList<Rule*> _rules;
+  QMultiHash<QString, Rule*> _rulesByKey;  // For the duplicate check, see ruleKey
+  QHash<const Rule*, QString> _ruleKeys;   // Key each rule is indexed with, until it changes
   RuleListModel* _ruleModel = nullptr;
+  CategorySuggester* _suggester = nullptr;
+  RulePreviewModel* _preview = nullptr;
   BudgetData& _budgetData;
   QUndoStack& _undoStack;
+  mutable RuleMatcher _matcher;  // Rebuilt on the first match after the rules changed
+  mutable bool _matcherDirty = true;
+  qint64 _matchingNanoseconds = 0;
+  bool _statisticsPending = false;  // Changed during a batch
 };
@@ -3,12 +3,19 @@
 #include "Rule.h"
 #include "RuleController.h"
 
+static constexpr int UnknownShadowing = -2;
+
 RuleListModel::RuleListModel(QObject* parent) :
     QAbstractListModel(parent) {
 }
 
 void RuleListModel::setRuleController(RuleController* controller) {
   _controller = controller;
+  connect(controller, &RuleController::statisticsChanged, this, [this] {
+    if (rowCount() > 0) {
+      emit dataChanged(index(0), index(rowCount() - 1), { MatchCountRole, EvaluationCountRole, LastMatchDateRole });
+    }
+  });
 }
 
 int RuleListModel::rowCount(const QModelIndex& parent) const {
@@ -43,6 +50,16 @@ QVariant RuleListModel::data(const QModelIndex& index, int role) const {
       return rule->labelMatch();
     case AmountFilterRole:
       return rule->amountFilter();
+    case MatchModeRole:
+      return static_cast<int>(rule->matchMode());
+    case MatchCountRole:
+      return rule->statistics().matches;
+    case EvaluationCountRole:
+      return rule->statistics().evaluations;
+    case LastMatchDateRole:
+      return rule->statistics().lastMatchDate;
+    case ShadowedByRole:
+      return shadowedBy(row);
   }
   return QVariant();
 }
@@ -52,10 +69,76 @@ QHash<int, QByteArray> RuleListModel::roleNames() const {
   roles[CategoryRole] = "category";
   roles[LabelMatchRole] = "labelMatch";
   roles[AmountFilterRole] = "amountFilter";
+  roles[MatchModeRole] = "matchMode";
+  roles[MatchCountRole] = "matchCount";
+  roles[EvaluationCountRole] = "evaluationCount";
+  roles[LastMatchDateRole] = "lastMatchDate";
+  roles[ShadowedByRole] = "shadowedBy";
   return roles;
 }
 
 void RuleListModel::refresh() {
   beginResetModel();
+  _shadowedBy.clear();
   endResetModel();
 }
+
+void RuleListModel::beginInsertRule(int row) {
+  _changedRow = row;
+  beginInsertRows(QModelIndex(), row, row);
+}
+
+void RuleListModel::endInsertRule() {
+  endInsertRows();
+  invalidateShadowing(_changedRow);
+}
+
+void RuleListModel::beginRemoveRule(int row) {
+  _changedRow = row;
+  beginRemoveRows(QModelIndex(), row, row);
+}
+
+void RuleListModel::endRemoveRule() {
+  endRemoveRows();
+  invalidateShadowing(_changedRow);
+}
+
+void RuleListModel::beginMoveRule(int fromRow, int toRow) {
+  _changedRow = qMin(fromRow, toRow);
+  // The destination is the row before which the rule goes, before the move
+  beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), toRow > fromRow ? toRow + 1 : toRow);
+}
+
+void RuleListModel::endMoveRule() {
+  endMoveRows();
+  invalidateShadowing(_changedRow);
+}
+
+void RuleListModel::ruleChanged(int row) {
+  if (row < 0 || row >= rowCount())
+    return;
+  emit dataChanged(index(row), index(row));
+  invalidateShadowing(row);
+}
+
+int RuleListModel::shadowedBy(int row) const {
+  if (row >= _shadowedBy.size()) {
+    _shadowedBy.resize(row + 1, UnknownShadowing);
+  }
+  if (_shadowedBy[row] == UnknownShadowing) {
+    _shadowedBy[row] = _controller->shadowingRule(row);
+  }
+  return _shadowedBy[row];
+}
+
+void RuleListModel::invalidateShadowing(int row) {
+  // A change can shadow or unshadow a later rule, or shift the position of a shadowing one,
+  // but earlier rules keep theirs
+  if (row < _shadowedBy.size()) {
+    _shadowedBy.resize(row);
+  }
+  const int count = rowCount();
+  if (row < count) {
+    emit dataChanged(index(row), index(count - 1), { ShadowedByRole });
+  }
+}
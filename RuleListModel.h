@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QList>
 #include <QObject>
 #include <QQmlEngine>
 
@@ -16,6 +17,11 @@ public:
     CategoryRole = Qt::UserRole + 1,
     LabelMatchRole,
     AmountFilterRole,
+    MatchModeRole,
+    MatchCountRole,
+    EvaluationCountRole,
+    LastMatchDateRole,  // Invalid if the rule never matched
+    ShadowedByRole,     // Position of an earlier rule matching everything this one does, -1 if none
   };
 
   explicit RuleListModel(QObject* parent = nullptr);
@@ -28,6 +34,21 @@ public:
 
   Q_INVOKABLE void refresh();
 
+  // Called by RuleController around each change of its rules, so that views keep their
+  // delegates and scroll position
+  void beginInsertRule(int row);
+  void endInsertRule();
+  void beginRemoveRule(int row);
+  void endRemoveRule();
+  void beginMoveRule(int fromRow, int toRow);
+  void endMoveRule();
+  void ruleChanged(int row);
+
 private:
+  int shadowedBy(int row) const;
+  void invalidateShadowing(int row);
+
   RuleController* _controller = nullptr;
+  int _changedRow = -1;            // First row touched by the change in progress
+  mutable QList<int> _shadowedBy;  // Computed when first read, see RuleController::shadowingRule
 };
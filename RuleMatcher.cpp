@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <utility>
+
+#include "Rule.h"
+#include "RuleMatcher.h"
+
+namespace {
+
+// Same characters as \w in the whole word expressions
+bool isWordCharacter(QChar c) {
+  return c.isLetterOrNumber() || c.category() == QChar::Mark_NonSpacing || c == QLatin1Char('_');
+}
+
+}  // namespace
+
+void RuleMatcher::rebuild(const QList<Rule*>& rules) {
+  _rules = rules;
+  _exactRules.clear();
+  _nodes.clear();
+  _patterns.clear();
+  _regexRules.clear();
+  addNode();  // Root
+
+  for (int position = 0; position < _rules.size(); ++position) {
+    const Rule* rule = _rules[position];
+    if (rule->labelMatch().isEmpty())
+      continue;
+    switch (rule->matchMode()) {
+      case Rule::MatchMode::Exact:
+        _exactRules[rule->foldedLabelMatch()].append(position);
+        break;
+      case Rule::MatchMode::Contains:
+      case Rule::MatchMode::Prefix:
+      case Rule::MatchMode::WholeWord:
+        addPattern(rule->foldedLabelMatch(), position);
+        break;
+      case Rule::MatchMode::Regex:
+        _regexRules.append(position);
+        break;
+    }
+  }
+  linkFailures();
+}
+
+QList<int> RuleMatcher::matchingRules(const QString& label) const {
+  const QString folded = label.toCaseFolded();
+  QList<int> positions = _exactRules.value(folded);
+
+  int state = 0;
+  for (int end = 0; end < folded.size(); ++end) {
+    const QChar c = folded[end];
+    while (state != 0 && !_nodes[state].next.contains(c)) {
+      state = _nodes[state].fail;
+    }
+    state = _nodes[state].next.value(c, 0);
+
+    for (int patternIndex : _nodes[state].patterns) {
+      const Pattern& pattern = _patterns[patternIndex];
+      const int start = end + 1 - pattern.length;
+      switch (_rules[pattern.rule]->matchMode()) {
+        case Rule::MatchMode::Prefix:
+          if (start != 0)
+            continue;
+          break;
+        case Rule::MatchMode::WholeWord:
+          if ((start > 0 && isWordCharacter(folded[start - 1])) || (end + 1 < folded.size() && isWordCharacter(folded[end + 1])))
+            continue;
+          break;
+        case Rule::MatchMode::Contains:
+        case Rule::MatchMode::Exact:
+        case Rule::MatchMode::Regex:
+          break;
+      }
+      positions.append(pattern.rule);
+    }
+  }
+
+  for (int position : _regexRules) {
+    if (_rules[position]->matchesLabel(label)) {
+      positions.append(position);
+    }
+  }
+
+  std::sort(positions.begin(), positions.end());
+  positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+  return positions;
+}
+
+int RuleMatcher::firstMatch(const QString& label, Money amount, QList<int>* tested) const {
+  if (tested) {
+    *tested = _regexRules;
+  }
+  for (int position : matchingRules(label)) {
+    if (tested && _rules[position]->matchMode() != Rule::MatchMode::Regex) {
+      tested->append(position);
+    }
+    if (_rules[position]->matchesAmount(amount)) {
+      return position;
+    }
+  }
+  return -1;
+}
+
+int RuleMatcher::addNode() {
+  _nodes.append(Node());
+  return _nodes.size() - 1;
+}
+
+void RuleMatcher::addPattern(const QString& foldedMatch, int rule) {
+  int state = 0;
+  for (QChar c : foldedMatch) {
+    int next = _nodes[state].next.value(c, 0);
+    if (next == 0) {
+      next = addNode();
+      _nodes[state].next.insert(c, next);
+    }
+    state = next;
+  }
+  _patterns.append({ rule, int(foldedMatch.size()) });
+  _nodes[state].patterns.append(_patterns.size() - 1);
+}
+
+void RuleMatcher::linkFailures() {
+  // Breadth first, so that the fail node of a node is complete before the node
+  QList<int> queue;
+  for (int child : std::as_const(_nodes[0].next)) {
+    queue.append(child);
+  }
+  for (qsizetype i = 0; i < queue.size(); ++i) {
+    const int state = queue[i];
+    const QHash<QChar, int> next = _nodes[state].next;
+    for (auto it = next.cbegin(); it != next.cend(); ++it) {
+      int fail = _nodes[state].fail;
+      while (fail != 0 && !_nodes[fail].next.contains(it.key())) {
+        fail = _nodes[fail].fail;
+      }
+      const int child = it.value();
+      _nodes[child].fail = _nodes[fail].next.value(it.key(), 0);
+      _nodes[child].patterns.append(_nodes[_nodes[child].fail].patterns);
+      queue.append(child);
+    }
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QChar>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "Money.h"
+
+class Rule;
+
+// Finds the first of an ordered list of rules matching an operation, without trying every rule.
+// Exact matches are looked up in a hash. Contains, prefix and whole word matches are all found
+// in one pass over the label, with an Aho-Corasick automaton of their patterns. Only regular
+// expressions are tried one by one.
+class RuleMatcher {
+public:
+  void rebuild(const QList<Rule*>& rules);
+
+  // Positions of the rules whose label match accepts the label, in order
+  QList<int> matchingRules(const QString& label) const;
+  // Position of the first rule matching, -1 if none. Tested receives the positions of the
+  // rules actually tried: every regular expression, and the other rules found in the index
+  // up to the first match.
+  int firstMatch(const QString& label, Money amount, QList<int>* tested = nullptr) const;
+
+private:
+  struct Node {
+    QHash<QChar, int> next;
+    int fail = 0;
+    QList<int> patterns;  // Patterns ending here, including through fail links
+  };
+
+  struct Pattern {
+    int rule;
+    int length;
+  };
+
+  int addNode();
+  void addPattern(const QString& foldedMatch, int rule);
+  void linkFailures();
+
+  QList<Rule*> _rules;
+  QHash<QString, QList<int>> _exactRules;  // By case-folded label
+  QList<Node> _nodes;
+  QList<Pattern> _patterns;
+  QList<int> _regexRules;
+};
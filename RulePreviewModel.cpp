@@ -0,0 +1,267 @@
+#include <QHash>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "Account.h"
+#include "BudgetData.h"
+#include "Operation.h"
+#include "RuleController.h"
+#include "RuleMatcher.h"
+#include "RulePreviewModel.h"
+
+// Everything a preview reads away from the GUI thread: copies of both rule sets, and the
+// labels and amounts of the operations
+struct RulePreviewModel::Job {
+  struct Item {
+    Operation* operation;  // Only compared, never dereferenced by the tasks
+    QString label;
+    Money amount;
+  };
+
+  struct Change {
+    Operation* operation;
+    const Category* current;
+    const Category* proposed;
+  };
+
+  ~Job() {  // On the GUI thread, where the rule copies live
+    qDeleteAll(currentRules);
+    qDeleteAll(proposedRules);
+  }
+
+  std::atomic<bool> canceled{ false };
+  std::atomic<int> remaining{ 0 };  // Accounts not done yet
+  QList<Rule*> currentRules;
+  QList<Rule*> proposedRules;
+  RuleMatcher current;
+  RuleMatcher proposed;
+  QHash<const Category*, QString> categoryNames;
+  std::vector<QList<Item>> items;      // By account
+  std::vector<QList<Change>> changes;  // By account, each written by the task of its account
+};
+
+RulePreviewModel::RulePreviewModel(BudgetData& budgetData, RuleController& ruleController, QObject* parent) :
+    QAbstractListModel(parent),
+    _budgetData(budgetData),
+    _ruleController(ruleController) {
+}
+
+RulePreviewModel::~RulePreviewModel() {
+  if (_job) {
+    _job->canceled = true;
+  }
+  _pool.waitForDone();
+}
+
+int RulePreviewModel::rowCount(const QModelIndex& parent) const {
+  if (parent.isValid())
+    return 0;
+  return _rows.size();
+}
+
+QVariant RulePreviewModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= _rows.size()) {
+    return QVariant();
+  }
+
+  const Row& row = _rows[index.row()];
+  const Operation* operation = row.operation;
+  if (!operation) {
+    return QVariant();
+  }
+
+  switch (static_cast<Roles>(role)) {
+    case OperationRole:
+      return QVariant::fromValue(row.operation.data());
+    case AccountNameRole:
+      return operation->account() ? operation->account()->name() : QString();
+    case DateRole:
+      return operation->date();
+    case LabelRole:
+      return operation->label();
+    case AmountRole:
+      return operation->amount();
+    case CurrentCategoryRole:
+      return row.currentCategory;
+    case ProposedCategoryRole:
+      return row.proposedCategory;
+    case UncategorizedRole:
+      return !operation->isCategorized();
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> RulePreviewModel::roleNames() const {
+  return {
+    { OperationRole, "operation" },
+    { AccountNameRole, "accountName" },
+    { DateRole, "date" },
+    { LabelRole, "label" },
+    { AmountRole, "amount" },
+    { CurrentCategoryRole, "currentCategory" },
+    { ProposedCategoryRole, "proposedCategory" },
+    { UncategorizedRole, "uncategorized" },
+  };
+}
+
+void RulePreviewModel::previewAdd(const Category* category, const QString& labelMatch, double amountFilter,
+                                  Rule::MatchMode matchMode) {
+  if (!category || labelMatch.isEmpty() || !Rule::matchError(labelMatch, matchMode).isEmpty()) {
+    cancel();
+    return;
+  }
+
+  QList<Rule*> rules = copyRules();
+  rules.append(new Rule(category, labelMatch, amountFilter, matchMode));
+  start(std::move(rules));
+}
+
+void RulePreviewModel::previewEdit(int index, const Category* category, const QString& labelMatch, double amountFilter,
+                                   Rule::MatchMode matchMode) {
+  if (index < 0 || index >= _ruleController.ruleCount() || !category
+      || !Rule::matchError(labelMatch, matchMode).isEmpty()) {
+    cancel();
+    return;
+  }
+
+  QList<Rule*> rules = copyRules();
+  delete rules[index];
+  rules[index] = new Rule(category, labelMatch, amountFilter, matchMode);
+  start(std::move(rules));
+}
+
+void RulePreviewModel::previewMove(int fromIndex, int toIndex) {
+  const int count = _ruleController.ruleCount();
+  if (fromIndex < 0 || fromIndex >= count || toIndex < 0 || toIndex >= count) {
+    cancel();
+    return;
+  }
+
+  QList<Rule*> rules = copyRules();
+  rules.move(fromIndex, toIndex);
+  start(std::move(rules));
+}
+
+void RulePreviewModel::cancel() {
+  if (_job) {
+    _job->canceled = true;
+    _job.reset();
+    emit runningChanged();
+  }
+  setRows({});
+}
+
+QList<Rule*> RulePreviewModel::copyRules() const {
+  // The tasks must not read rules the GUI thread may edit meanwhile
+  QList<Rule*> rules;
+  for (const Rule* rule : _ruleController.rules()) {
+    rules.append(new Rule(rule->category(), rule->labelMatch(), rule->amountFilterMoney(), rule->matchMode()));
+  }
+  return rules;
+}
+
+void RulePreviewModel::start(QList<Rule*> proposedRules) {
+  if (_job) {
+    _job->canceled = true;
+  }
+
+  _budgetData.requireAllAccounts();
+
+  auto job = std::make_shared<Job>();
+  job->currentRules = copyRules();
+  job->proposedRules = std::move(proposedRules);
+  job->current.rebuild(job->currentRules);
+  job->proposed.rebuild(job->proposedRules);
+  for (const QList<Rule*>* rules : { &job->currentRules, &job->proposedRules }) {
+    for (const Rule* rule : *rules) {
+      if (rule->category()) {
+        job->categoryNames.insert(rule->category(), rule->category()->name());
+      }
+    }
+  }
+  for (const Account* account : _budgetData.accounts()) {
+    QList<Job::Item> items;
+    items.reserve(account->operations().size());
+    for (Operation* operation : account->operations()) {
+      items.append({ operation, operation->label(), operation->amountMoney() });
+    }
+    job->items.push_back(std::move(items));
+  }
+  job->changes.resize(job->items.size());
+  job->remaining = int(job->items.size());
+
+  const bool wasRunning = running();
+  _job = job;
+  if (!wasRunning) {
+    emit runningChanged();
+  }
+  if (job->items.empty()) {
+    finish(job);
+    return;
+  }
+
+  for (size_t account = 0; account < job->items.size(); ++account) {
+    _pool.start([this, job, account]() mutable {
+      QList<Job::Change>& changes = job->changes[account];
+      for (const Job::Item& item : std::as_const(job->items[account])) {
+        if (job->canceled.load(std::memory_order_relaxed))
+          break;
+        const Rule* currentRule = job->currentRules.value(job->current.firstMatch(item.label, item.amount));
+        const Rule* proposedRule = job->proposedRules.value(job->proposed.firstMatch(item.label, item.amount));
+        const Category* current = currentRule ? currentRule->category() : nullptr;
+        const Category* proposed = proposedRule ? proposedRule->category() : nullptr;
+        if (current != proposed) {
+          changes.append({ item.operation, current, proposed });
+        }
+      }
+      // Each task hands its reference back: the rule copies are deleted on the GUI thread
+      const bool done = --job->remaining == 0;
+      QMetaObject::invokeMethod(
+          this,
+          [this, job = std::move(job), done] {
+            if (done) {
+              finish(job);
+            }
+          },
+          Qt::QueuedConnection);
+    });
+  }
+}
+
+void RulePreviewModel::finish(const std::shared_ptr<Job>& job) {
+  if (job != _job || job->canceled)
+    return;  // Replaced by a newer preview
+
+  QList<Row> rows;
+  for (const QList<Job::Change>& changes : job->changes) {
+    for (const Job::Change& change : changes) {
+      rows.append({ change.operation, job->categoryNames.value(change.current), job->categoryNames.value(change.proposed) });
+    }
+  }
+  _job.reset();
+  setRows(std::move(rows));
+  emit runningChanged();
+}
+
+void RulePreviewModel::setRows(QList<Row> rows) {
+  const int previousCount = _rows.size();
+  const int previousUncategorizedCount = _uncategorizedCount;
+
+  beginResetModel();
+  _rows = std::move(rows);
+  _uncategorizedCount = 0;
+  for (const Row& row : std::as_const(_rows)) {
+    if (row.operation && !row.operation->isCategorized()) {
+      _uncategorizedCount++;
+    }
+  }
+  endResetModel();
+
+  if (_rows.size() != previousCount) {
+    emit countChanged();
+  }
+  if (_uncategorizedCount != previousUncategorizedCount) {
+    emit uncategorizedCountChanged();
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QQmlEngine>
+#include <QThreadPool>
+
+#include <memory>
+
+#include "Rule.h"
+
+class BudgetData;
+class Category;
+class Operation;
+class RuleController;
+
+// Operations whose category from the rules would change with a proposed rule set (a rule
+// added, edited or moved), compared to the current rules. Operations are matched against
+// both rule sets on a thread pool, one task per account, and the rows are replaced when
+// every account is done. A new proposal cancels the one still running, so the rules editor
+// can preview on each keystroke.
+class RulePreviewModel : public QAbstractListModel {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by RuleController")
+
+  Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+  Q_PROPERTY(int uncategorizedCount READ uncategorizedCount NOTIFY uncategorizedCountChanged)
+  Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+
+public:
+  enum Roles {
+    OperationRole = Qt::UserRole + 1,
+    AccountNameRole,
+    DateRole,
+    LabelRole,
+    AmountRole,
+    CurrentCategoryRole,   // Given by the current rules, empty if none matches
+    ProposedCategoryRole,  // Given by the proposed rules, empty if none matches
+    UncategorizedRole,     // Applying the rules would categorize the operation
+  };
+  Q_ENUM(Roles)
+
+  RulePreviewModel(BudgetData& budgetData, RuleController& ruleController, QObject* parent = nullptr);
+  ~RulePreviewModel();
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+  int uncategorizedCount() const { return _uncategorizedCount; }
+  bool running() const { return _job != nullptr; }
+
+  // Same arguments as the RuleController methods they preview
+  Q_INVOKABLE void previewAdd(const Category* category, const QString& labelMatch, double amountFilter = 0,
+                              Rule::MatchMode matchMode = Rule::MatchMode::Contains);
+  Q_INVOKABLE void previewEdit(int index, const Category* category, const QString& labelMatch, double amountFilter = 0,
+                               Rule::MatchMode matchMode = Rule::MatchMode::Contains);
+  Q_INVOKABLE void previewMove(int fromIndex, int toIndex);
+  Q_INVOKABLE void cancel();  // Stop the running preview and clear the rows
+
+signals:
+  void countChanged();
+  void uncategorizedCountChanged();
+  void runningChanged();
+
+private:
+  struct Job;
+
+  struct Row {
+    QPointer<Operation> operation;
+    QString currentCategory;
+    QString proposedCategory;
+  };
+
+  QList<Rule*> copyRules() const;
+  void start(QList<Rule*> proposedRules);
+  void finish(const std::shared_ptr<Job>& job);
+  void setRows(QList<Row> rows);
+
+  BudgetData& _budgetData;
+  RuleController& _ruleController;
+  QThreadPool _pool;
+  std::shared_ptr<Job> _job;  // Running preview
+  QList<Row> _rows;
+  int _uncategorizedCount = 0;
+};
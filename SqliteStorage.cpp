@@ -0,0 +1,844 @@
+#include <QDebug>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QVariant>
+#include <utility>
+
+#include "Account.h"
+#include "BatchScope.h"
+#include "BudgetData.h"
+#include "Category.h"
+#include "CategoryController.h"
+#include "Operation.h"
+#include "Rule.h"
+#include "RuleController.h"
+#include "SqliteStorage.h"
+
+static constexpr int SchemaVersion = 3;  // 2: opening balances and archived spent amounts, 3: rule match modes
+static const QString DateFormat = QStringLiteral("yyyy-MM-dd");
+
+SqliteStorage::SqliteStorage(BudgetData& budgetData,
+                             CategoryController& categoryController,
+                             RuleController& ruleController,
+                             QObject* parent) :
+    QObject(parent),
+    _budgetData(budgetData),
+    _categoryController(categoryController),
+    _ruleController(ruleController),
+    _connectionName(QStringLiteral("comptine-storage-%1").arg(quintptr(this), 0, 16)) {
+  connect(&_budgetData, &BudgetData::accountCountChanged, this, &SqliteStorage::syncAccounts);
+  connect(&_budgetData, &BudgetData::modelReset, this, &SqliteStorage::syncAccounts);
+  connect(&_categoryController, &CategoryController::countChanged, this, &SqliteStorage::syncCategories);
+
+  // Accounts still on disk are read as soon as they are shown, scanned or edited in bulk
+  connect(&_budgetData, &BudgetData::currentAccountChanged, this, [this] {
+    if (Account* account = _budgetData.currentAccount()) {
+      loadAccount(account);
+    }
+  });
+  connect(&_budgetData, &BudgetData::allAccountsRequired, this, &SqliteStorage::loadPendingAccounts);
+  connect(&_budgetData, &BudgetData::batchBegan, this, &SqliteStorage::loadPendingAccounts);
+}
+
+SqliteStorage::~SqliteStorage() {
+  close();
+}
+
+bool SqliteStorage::isStorageFile(const QString& filePath) {
+  return QFileInfo(filePath).suffix().compare(FileSuffix, Qt::CaseInsensitive) == 0;
+}
+
+bool SqliteStorage::load(const QString& filePath) {
+  close();
+  _errorString.clear();
+
+  if (!QFileInfo::exists(filePath)) {
+    _errorString = tr("File not found: %1").arg(filePath);
+    return false;
+  }
+  if (!open(filePath) || !readAll()) {
+    close();
+    return false;
+  }
+
+  // Everything just read is in sync with the file
+  _filePath = filePath;
+  _tracking = true;
+  syncAccounts();
+  syncCategories();
+  return true;
+}
+
+bool SqliteStorage::save(const QString& filePath) {
+  _errorString.clear();
+  if (!loadPendingAccounts()) {
+    return false;
+  }
+
+  const bool incremental = _tracking && filePath == _filePath;
+  if (!incremental) {
+    close();
+    if (!open(filePath)) {
+      close();
+      return false;
+    }
+  }
+
+  bool ok = false;
+  {
+    QSqlDatabase db = QSqlDatabase::database(_connectionName);
+    if (db.transaction()) {
+      if (incremental || clearTables()) {
+        if (!incremental) {
+          markAllDirty();
+        }
+        ok = writeChanges() && db.commit();
+      }
+      if (!ok) {
+        if (_errorString.isEmpty()) {
+          _errorString = db.lastError().text();
+        }
+        db.rollback();
+      }
+    } else {
+      _errorString = db.lastError().text();
+    }
+  }
+  if (!ok) {
+    close();  // Ids may refer to rolled back rows, the next save rewrites everything
+    return false;
+  }
+
+  _filePath = filePath;
+  _dirtyCategories.clear();
+  _dirtyOperations.clear();
+  return true;
+}
+
+void SqliteStorage::close() {
+  for (const Account* account : std::as_const(_attachedAccounts)) {
+    disconnect(account, nullptr, this, nullptr);
+  }
+  for (const Category* category : std::as_const(_attachedCategories)) {
+    disconnect(category, nullptr, this, nullptr);
+  }
+  for (Operation* operation : std::as_const(_attachedOperations)) {
+    disconnect(operation, nullptr, this, nullptr);
+  }
+  _attachedAccounts.clear();
+  _attachedCategories.clear();
+  _attachedOperations.clear();
+  _accountIds.clear();
+  _categoryIds.clear();
+  _operationIds.clear();
+  _dirtyCategories.clear();
+  _dirtyOperations.clear();
+  _deletedAccountIds.clear();
+  _deletedCategoryIds.clear();
+  _deletedOperationIds.clear();
+  _pendingAccounts.clear();
+  _tracking = false;
+  _filePath.clear();
+
+  if (QSqlDatabase::contains(_connectionName)) {
+    QSqlDatabase::database(_connectionName, false).close();
+    QSqlDatabase::removeDatabase(_connectionName);
+  }
+}
+
+bool SqliteStorage::open(const QString& filePath) {
+  QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), _connectionName);
+  db.setDatabaseName(filePath);
+  if (!db.open()) {
+    _errorString = db.lastError().text();
+    return false;
+  }
+  // Budgets may live in a synced folder (see FileCoordinator). With the rollback journal every
+  // commit lands in the main file, whereas WAL keeps it in a -wal sidecar that sync clients
+  // upload separately. The journal mode is stored in the file, so set it explicitly.
+  return exec(QStringLiteral("PRAGMA foreign_keys = ON"))
+         && exec(QStringLiteral("PRAGMA journal_mode = DELETE"))
+         && createSchema();
+}
+
+bool SqliteStorage::createSchema() {
+  QSqlQuery version(QSqlDatabase::database(_connectionName));
+  if (!version.exec(QStringLiteral("PRAGMA user_version")) || !version.next()) {
+    _errorString = version.lastError().text();
+    return false;
+  }
+  const int fileVersion = version.value(0).toInt();
+  if (fileVersion > SchemaVersion) {
+    _errorString = tr("The file was written by a newer version of Comptine");
+    return false;
+  }
+
+  const QStringList statements = {
+    "CREATE TABLE IF NOT EXISTS state ("
+    " key TEXT PRIMARY KEY,"
+    " value TEXT)",
+    "CREATE TABLE IF NOT EXISTS categories ("
+    " id INTEGER PRIMARY KEY,"
+    " name TEXT NOT NULL,"
+    " budget_limit INTEGER NOT NULL DEFAULT 0)",
+    "CREATE TABLE IF NOT EXISTS month_history ("
+    " category_id INTEGER NOT NULL REFERENCES categories(id) ON DELETE CASCADE,"
+    " year INTEGER NOT NULL,"
+    " month INTEGER NOT NULL,"
+    " budget_limit INTEGER,"
+    " save_amount INTEGER NOT NULL DEFAULT 0,"
+    " report_amount INTEGER NOT NULL DEFAULT 0,"
+    " archived_spent INTEGER NOT NULL DEFAULT 0,"
+    " PRIMARY KEY (year, month, category_id))",
+    "CREATE INDEX IF NOT EXISTS month_history_category ON month_history(category_id)",
+    "CREATE TABLE IF NOT EXISTS accounts ("
+    " id INTEGER PRIMARY KEY,"
+    " name TEXT NOT NULL,"
+    " position INTEGER NOT NULL,"
+    " import_source_prefixes TEXT NOT NULL DEFAULT '',"
+    " opening_balance INTEGER NOT NULL DEFAULT 0,"
+    " current_operation_id INTEGER)",
+    "CREATE TABLE IF NOT EXISTS operations ("
+    " id INTEGER PRIMARY KEY,"
+    " account_id INTEGER NOT NULL REFERENCES accounts(id) ON DELETE CASCADE,"
+    " date TEXT NOT NULL,"
+    " budget_date TEXT,"
+    " amount INTEGER NOT NULL,"
+    " label TEXT NOT NULL DEFAULT '',"
+    " details TEXT NOT NULL DEFAULT '')",
+    "CREATE INDEX IF NOT EXISTS operations_account_date ON operations(account_id, date)",
+    "CREATE INDEX IF NOT EXISTS operations_label ON operations(label)",
+    // budget_month duplicates the operation budget month so that per category sums need no join
+    "CREATE TABLE IF NOT EXISTS allocations ("
+    " operation_id INTEGER NOT NULL REFERENCES operations(id) ON DELETE CASCADE,"
+    " position INTEGER NOT NULL,"
+    " category_id INTEGER REFERENCES categories(id) ON DELETE SET NULL,"
+    " amount INTEGER NOT NULL,"
+    " budget_month TEXT NOT NULL,"
+    " PRIMARY KEY (operation_id, position))",
+    "CREATE INDEX IF NOT EXISTS allocations_month_category ON allocations(budget_month, category_id)",
+    "CREATE TABLE IF NOT EXISTS rules ("
+    " position INTEGER PRIMARY KEY,"
+    " category_id INTEGER NOT NULL REFERENCES categories(id) ON DELETE CASCADE,"
+    " label_match TEXT NOT NULL,"
+    " amount INTEGER NOT NULL DEFAULT 0,"
+    " match_mode TEXT NOT NULL DEFAULT 'contains')",
+  };
+  for (const QString& statement : statements) {
+    if (!exec(statement)) {
+      return false;
+    }
+  }
+
+  if (fileVersion == 1
+      && (!exec(QStringLiteral("ALTER TABLE accounts ADD COLUMN opening_balance INTEGER NOT NULL DEFAULT 0"))
+          || !exec(QStringLiteral("ALTER TABLE month_history ADD COLUMN archived_spent INTEGER NOT NULL DEFAULT 0")))) {
+    return false;
+  }
+  if (fileVersion >= 1 && fileVersion < 3
+      && !exec(QStringLiteral("ALTER TABLE rules ADD COLUMN match_mode TEXT NOT NULL DEFAULT 'contains'"))) {
+    return false;
+  }
+  return exec(QStringLiteral("PRAGMA user_version = %1").arg(SchemaVersion));
+}
+
+bool SqliteStorage::clearTables() {
+  // Children first, foreign keys are enforced
+  for (const char* table : { "rules", "allocations", "operations", "accounts", "month_history", "categories", "state" }) {
+    if (!exec(QStringLiteral("DELETE FROM %1").arg(QLatin1String(table)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SqliteStorage::readAll() {
+  QSqlDatabase db = QSqlDatabase::database(_connectionName);
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+
+  // Categories and their month history
+  QHash<qint64, Category*> categories;
+  QList<qint64> categoryOrder;
+  if (!query.exec(QStringLiteral("SELECT id, name, budget_limit FROM categories ORDER BY id"))) {
+    _errorString = query.lastError().text();
+    return false;
+  }
+  while (query.next()) {
+    const qint64 id = query.value(0).toLongLong();
+    categories.insert(id, new Category(query.value(1).toString(), Money::fromCents(query.value(2).toLongLong())));
+    categoryOrder.append(id);
+  }
+  if (!query.exec(QStringLiteral("SELECT category_id, year, month, budget_limit, save_amount, report_amount, archived_spent FROM month_history"))) {
+    _errorString = query.lastError().text();
+    qDeleteAll(categories);
+    return false;
+  }
+  while (query.next()) {
+    Category* category = categories.value(query.value(0).toLongLong());
+    if (!category)
+      continue;
+    MonthRecord record;
+    if (!query.value(3).isNull()) {
+      record.budgetLimit = Money::fromCents(query.value(3).toLongLong());
+    }
+    record.saveAmount = Money::fromCents(query.value(4).toLongLong());
+    record.reportAmount = Money::fromCents(query.value(5).toLongLong());
+    record.archivedSpent = Money::fromCents(query.value(6).toLongLong());
+    category->setMonthRecord(query.value(1).toInt(), query.value(2).toInt(), record);
+  }
+  for (qint64 id : std::as_const(categoryOrder)) {
+    Category* category = categories.value(id);
+    if (_categoryController.addCategory(category)) {
+      _categoryIds.insert(category, id);
+    } else {
+      categories.remove(id);  // Duplicate name, deleted by addCategory
+    }
+  }
+
+  // Accounts, their operations are read by loadAccount()
+  QHash<qint64, Account*> accounts;
+  if (!query.exec(QStringLiteral("SELECT id, name, import_source_prefixes, current_operation_id, opening_balance FROM accounts ORDER BY position"))) {
+    _errorString = query.lastError().text();
+    return false;
+  }
+  while (query.next()) {
+    const qint64 id = query.value(0).toLongLong();
+    auto account = new Account(query.value(1).toString());
+    account->setImportSourcePrefixes(query.value(2).toString().split('\n', Qt::SkipEmptyParts));
+    account->set_openingBalance(Money::fromCents(query.value(4).toLongLong()));
+    accounts.insert(id, account);
+    _pendingAccounts.insert(account, { id, query.value(3).isNull() ? -1 : query.value(3).toLongLong() });
+    _budgetData.addAccount(account);
+    _accountIds.insert(account, id);
+  }
+
+  // Rules
+  if (!query.exec(QStringLiteral("SELECT category_id, label_match, amount, match_mode FROM rules ORDER BY position"))) {
+    _errorString = query.lastError().text();
+    return false;
+  }
+  _ruleController.clearRules();
+  while (query.next()) {
+    if (const Category* category = categories.value(query.value(0).toLongLong())) {
+      _ruleController.addRule(new Rule(category, query.value(1).toString(), Money::fromCents(query.value(2).toLongLong()),
+                                       Rule::matchModeFromName(query.value(3).toString())));
+    }
+  }
+
+  // Navigation state
+  if (!query.exec(QStringLiteral("SELECT key, value FROM state"))) {
+    _errorString = query.lastError().text();
+    return false;
+  }
+  while (query.next()) {
+    const QString key = query.value(0).toString();
+    const QVariant value = query.value(1);
+    if (key == "currentTab") {
+      _budgetData.set_currentTabIndex(value.toInt());
+    } else if (key == "budgetDate") {
+      _budgetData.set_budgetDate(QDate::fromString(value.toString(), DateFormat));
+    } else if (key == "currentAccount") {
+      _budgetData.set_currentAccount(accounts.value(value.toLongLong()));
+    } else if (key == "currentCategory") {
+      _categoryController.set_current(categories.value(value.toLongLong()));
+    }
+  }
+
+  // Only the account on screen is read now, the others follow from the event loop
+  Account* current = _budgetData.currentAccount() ? _budgetData.currentAccount() : _budgetData.accountAt(0);
+  if (current && !loadAccount(current)) {
+    return false;
+  }
+  scheduleLoad();
+  return true;
+}
+
+bool SqliteStorage::loadAccount(Account* account) {
+  auto pendingIt = _pendingAccounts.find(account);
+  if (pendingIt == _pendingAccounts.end())
+    return true;
+  const PendingAccount pending = *pendingIt;
+  _pendingAccounts.erase(pendingIt);
+
+  QHash<qint64, const Category*> categories;
+  for (auto it = _categoryIds.cbegin(); it != _categoryIds.cend(); ++it) {
+    categories.insert(it.value(), it.key());
+  }
+
+  QSqlQuery query(QSqlDatabase::database(_connectionName));
+  query.setForwardOnly(true);
+
+  // Allocations, grouped by operation
+  QHash<qint64, QList<Allocation*>> allocations;
+  query.prepare(QStringLiteral("SELECT a.operation_id, a.category_id, a.amount FROM allocations a"
+                               " JOIN operations o ON o.id = a.operation_id"
+                               " WHERE o.account_id = ? ORDER BY a.operation_id, a.position"));
+  query.bindValue(0, pending.id);
+  if (!exec(query))
+    return false;
+  while (query.next()) {
+    allocations[query.value(0).toLongLong()].append(
+        new Allocation(categories.value(query.value(1).toLongLong()), Money::fromCents(query.value(2).toLongLong())));
+  }
+
+  // Operations, most recent first like Account::sortOperations
+  query.prepare(QStringLiteral("SELECT id, date, budget_date, amount, label, details FROM operations"
+                               " WHERE account_id = ? ORDER BY date DESC, id"));
+  query.bindValue(0, pending.id);
+  if (!exec(query)) {
+    for (const auto& list : std::as_const(allocations)) {
+      qDeleteAll(list);
+    }
+    return false;
+  }
+
+  BatchScope batch(*account);
+  while (query.next()) {
+    const qint64 id = query.value(0).toLongLong();
+    auto operation = new Operation(account,
+                                   QDate::fromString(query.value(1).toString(), DateFormat),
+                                   Money::fromCents(query.value(3).toLongLong()),
+                                   query.value(4).toString(),
+                                   query.value(5).toString(),
+                                   allocations.take(id));
+    if (!query.value(2).isNull()) {
+      operation->set_budgetDate(QDate::fromString(query.value(2).toString(), DateFormat));
+    }
+    _operationIds.insert(operation, id);  // Before insertion, so that tracking sees it as saved
+    account->addOperation(operation, false);
+    if (id == pending.currentOperationId) {
+      account->select(operation);
+    }
+  }
+  return true;
+}
+
+bool SqliteStorage::loadPendingAccounts() {
+  while (!_pendingAccounts.isEmpty()) {
+    if (!loadAccount(_pendingAccounts.constBegin().key()))
+      return false;
+  }
+  return true;
+}
+
+void SqliteStorage::scheduleLoad() {
+  if (_loadScheduled || _pendingAccounts.isEmpty())
+    return;
+
+  // One account per event loop iteration keeps the interface responsive
+  _loadScheduled = true;
+  QTimer::singleShot(0, this, [this] {
+    _loadScheduled = false;
+    if (!_pendingAccounts.isEmpty()) {
+      loadAccount(nextPendingAccount());
+      scheduleLoad();
+    }
+  });
+}
+
+Account* SqliteStorage::nextPendingAccount() const {
+  // In display order, accounts taken out of the budget last
+  for (Account* account : _budgetData.accounts()) {
+    if (_pendingAccounts.contains(account))
+      return account;
+  }
+  return _pendingAccounts.constBegin().key();
+}
+
+bool SqliteStorage::writeChanges() {
+  QSqlDatabase db = QSqlDatabase::database(_connectionName);
+  QSqlQuery query(db);
+
+  // Removals first: deleting an account or a category cascades to what refers to it
+  auto deleteIds = [&](const QString& statement, QSet<qint64>& ids) {
+    if (ids.isEmpty())
+      return true;
+    query.prepare(statement);
+    for (qint64 id : std::as_const(ids)) {
+      query.bindValue(0, id);
+      if (!exec(query))
+        return false;
+    }
+    ids.clear();
+    return true;
+  };
+  return deleteIds(QStringLiteral("DELETE FROM operations WHERE id = ?"), _deletedOperationIds)
+         && deleteIds(QStringLiteral("DELETE FROM accounts WHERE id = ?"), _deletedAccountIds)
+         && deleteIds(QStringLiteral("DELETE FROM categories WHERE id = ?"), _deletedCategoryIds)
+         && writeCategories()
+         && writeAccounts()
+         && writeOperations()
+         && writeCurrentOperations()
+         && writeRules()
+         && writeState();
+}
+
+bool SqliteStorage::writeCategories() {
+  QSqlDatabase db = QSqlDatabase::database(_connectionName);
+  QSqlQuery upsert(db);
+  upsert.prepare(QStringLiteral("INSERT INTO categories (id, name, budget_limit) VALUES (?, ?, ?)"
+                                " ON CONFLICT(id) DO UPDATE SET name = excluded.name, budget_limit = excluded.budget_limit"));
+  QSqlQuery clearHistory(db);
+  clearHistory.prepare(QStringLiteral("DELETE FROM month_history WHERE category_id = ?"));
+  QSqlQuery insertHistory(db);
+  insertHistory.prepare(QStringLiteral("INSERT INTO month_history (category_id, year, month, budget_limit, save_amount, report_amount, archived_spent)"
+                                       " VALUES (?, ?, ?, ?, ?, ?, ?)"));
+
+  for (const Category* category : std::as_const(_dirtyCategories)) {
+    auto idIt = _categoryIds.constFind(category);
+    upsert.bindValue(0, idIt != _categoryIds.cend() ? QVariant(*idIt) : QVariant());
+    upsert.bindValue(1, category->name());
+    upsert.bindValue(2, category->budgetLimitMoney().cents());
+    if (!exec(upsert))
+      return false;
+    const qint64 id = idIt != _categoryIds.cend() ? *idIt : upsert.lastInsertId().toLongLong();
+    _categoryIds.insert(category, id);
+
+    clearHistory.bindValue(0, id);
+    if (!exec(clearHistory))
+      return false;
+    const QMap<YearMonth, MonthRecord> history = category->allMonthHistory();
+    for (auto it = history.cbegin(); it != history.cend(); ++it) {
+      if (it->isEmpty())
+        continue;
+      insertHistory.bindValue(0, id);
+      insertHistory.bindValue(1, it.key().year);
+      insertHistory.bindValue(2, it.key().month);
+      insertHistory.bindValue(3, it->budgetLimit.has_value() ? QVariant(it->budgetLimit->cents()) : QVariant());
+      insertHistory.bindValue(4, it->saveAmount.cents());
+      insertHistory.bindValue(5, it->reportAmount.cents());
+      insertHistory.bindValue(6, it->archivedSpent.cents());
+      if (!exec(insertHistory))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool SqliteStorage::writeAccounts() {
+  // Accounts are few: always rewrite names, order, import sources and opening balances
+  QSqlQuery upsert(QSqlDatabase::database(_connectionName));
+  upsert.prepare(QStringLiteral("INSERT INTO accounts (id, name, position, import_source_prefixes, opening_balance) VALUES (?, ?, ?, ?, ?)"
+                                " ON CONFLICT(id) DO UPDATE SET name = excluded.name, position = excluded.position,"
+                                " import_source_prefixes = excluded.import_source_prefixes, opening_balance = excluded.opening_balance"));
+  const QList<Account*> accounts = _budgetData.accounts();
+  for (int position = 0; position < accounts.size(); ++position) {
+    const Account* account = accounts[position];
+    auto idIt = _accountIds.constFind(account);
+    upsert.bindValue(0, idIt != _accountIds.cend() ? QVariant(*idIt) : QVariant());
+    upsert.bindValue(1, account->name());
+    upsert.bindValue(2, position);
+    upsert.bindValue(3, account->importSourcePrefixes().join('\n'));
+    upsert.bindValue(4, account->openingBalanceMoney().cents());
+    if (!exec(upsert))
+      return false;
+    if (idIt == _accountIds.cend()) {
+      _accountIds.insert(account, upsert.lastInsertId().toLongLong());
+    }
+  }
+  return true;
+}
+
+bool SqliteStorage::writeOperations() {
+  QSqlDatabase db = QSqlDatabase::database(_connectionName);
+  QSqlQuery upsert(db);
+  upsert.prepare(QStringLiteral("INSERT INTO operations (id, account_id, date, budget_date, amount, label, details)"
+                                " VALUES (?, ?, ?, ?, ?, ?, ?)"
+                                " ON CONFLICT(id) DO UPDATE SET date = excluded.date, budget_date = excluded.budget_date,"
+                                " amount = excluded.amount, label = excluded.label, details = excluded.details"));
+  QSqlQuery clearAllocations(db);
+  clearAllocations.prepare(QStringLiteral("DELETE FROM allocations WHERE operation_id = ?"));
+  QSqlQuery insertAllocation(db);
+  insertAllocation.prepare(QStringLiteral("INSERT INTO allocations (operation_id, position, category_id, amount, budget_month)"
+                                          " VALUES (?, ?, ?, ?, ?)"));
+
+  for (const Operation* operation : std::as_const(_dirtyOperations)) {
+    const qint64 accountId = _accountIds.value(operation->account(), -1);
+    if (accountId < 0)
+      continue;
+
+    auto idIt = _operationIds.constFind(operation);
+    const bool isNew = idIt == _operationIds.cend();
+    upsert.bindValue(0, isNew ? QVariant() : QVariant(*idIt));
+    upsert.bindValue(1, accountId);
+    upsert.bindValue(2, operation->date().toString(DateFormat));
+    // Only store the budget date if explicitly set, as in the YAML format
+    upsert.bindValue(3, operation->budgetDate() != operation->date() ? QVariant(operation->budgetDate().toString(DateFormat)) : QVariant());
+    upsert.bindValue(4, operation->amountMoney().cents());
+    upsert.bindValue(5, operation->label());
+    upsert.bindValue(6, operation->details());
+    if (!exec(upsert))
+      return false;
+    const qint64 id = isNew ? upsert.lastInsertId().toLongLong() : *idIt;
+    if (isNew) {
+      _operationIds.insert(operation, id);
+    } else {
+      clearAllocations.bindValue(0, id);
+      if (!exec(clearAllocations))
+        return false;
+    }
+
+    const QString budgetMonth = operation->budgetDate().toString(QStringLiteral("yyyy-MM"));
+    const QList<Allocation*> allocations = operation->allocations();
+    for (int position = 0; position < allocations.size(); ++position) {
+      const Allocation* allocation = allocations[position];
+      auto categoryIt = _categoryIds.constFind(allocation->category());
+      insertAllocation.bindValue(0, id);
+      insertAllocation.bindValue(1, position);
+      insertAllocation.bindValue(2, categoryIt != _categoryIds.cend() ? QVariant(*categoryIt) : QVariant());
+      insertAllocation.bindValue(3, allocation->amountMoney().cents());
+      insertAllocation.bindValue(4, budgetMonth);
+      if (!exec(insertAllocation))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool SqliteStorage::writeCurrentOperations() {
+  QSqlQuery update(QSqlDatabase::database(_connectionName));
+  update.prepare(QStringLiteral("UPDATE accounts SET current_operation_id = ? WHERE id = ?"));
+  for (auto it = _accountIds.cbegin(); it != _accountIds.cend(); ++it) {
+    auto operationIt = _operationIds.constFind(it.key()->currentOperation());
+    update.bindValue(0, operationIt != _operationIds.cend() ? QVariant(*operationIt) : QVariant());
+    update.bindValue(1, it.value());
+    if (!exec(update))
+      return false;
+  }
+  return true;
+}
+
+bool SqliteStorage::writeRules() {
+  // Rules are few and ordered: always rewrite them
+  if (!exec(QStringLiteral("DELETE FROM rules")))
+    return false;
+
+  QSqlQuery insert(QSqlDatabase::database(_connectionName));
+  insert.prepare(QStringLiteral("INSERT INTO rules (position, category_id, label_match, amount, match_mode) VALUES (?, ?, ?, ?, ?)"));
+  const QList<Rule*> rules = _ruleController.rules();
+  for (int position = 0; position < rules.size(); ++position) {
+    const Rule* rule = rules[position];
+    auto categoryIt = _categoryIds.constFind(rule->category());
+    if (categoryIt == _categoryIds.cend())
+      continue;
+    insert.bindValue(0, position);
+    insert.bindValue(1, *categoryIt);
+    insert.bindValue(2, rule->labelMatch());
+    insert.bindValue(3, rule->amountFilterMoney().cents());
+    insert.bindValue(4, Rule::matchModeName(rule->matchMode()));
+    if (!exec(insert))
+      return false;
+  }
+  return true;
+}
+
+bool SqliteStorage::writeState() {
+  QSqlQuery upsert(QSqlDatabase::database(_connectionName));
+  upsert.prepare(QStringLiteral("INSERT OR REPLACE INTO state (key, value) VALUES (?, ?)"));
+  const QList<QPair<QString, QVariant>> values = {
+    { "currentTab", _budgetData.currentTabIndex() },
+    { "budgetDate", _budgetData.budgetDate().toString(DateFormat) },
+    { "currentAccount", _accountIds.contains(_budgetData.currentAccount()) ? QVariant(_accountIds.value(_budgetData.currentAccount())) : QVariant() },
+    { "currentCategory", _categoryIds.contains(_categoryController.current()) ? QVariant(_categoryIds.value(_categoryController.current())) : QVariant() },
+  };
+  for (const auto& [key, value] : values) {
+    upsert.bindValue(0, key);
+    upsert.bindValue(1, value);
+    if (!exec(upsert))
+      return false;
+  }
+  return true;
+}
+
+bool SqliteStorage::exec(QSqlQuery& query) {
+  if (!query.exec()) {
+    _errorString = query.lastError().text();
+    qWarning() << "SQLite error:" << _errorString << query.lastQuery();
+    return false;
+  }
+  return true;
+}
+
+bool SqliteStorage::exec(const QString& statement) {
+  QSqlQuery query(QSqlDatabase::database(_connectionName));
+  if (!query.exec(statement)) {
+    _errorString = query.lastError().text();
+    qWarning() << "SQLite error:" << _errorString << statement;
+    return false;
+  }
+  return true;
+}
+
+void SqliteStorage::syncAccounts() {
+  if (!_tracking)
+    return;
+
+  const QList<Account*> accounts = _budgetData.accounts();
+  const QSet<const Account*> present(accounts.cbegin(), accounts.cend());
+
+  // Accounts taken out of the budget (deleted ones are handled on destruction)
+  const QSet<const Account*> attached = _attachedAccounts;
+  for (const Account* account : attached) {
+    if (!present.contains(account)) {
+      disconnect(account, nullptr, this, nullptr);
+      for (Operation* operation : account->operations()) {
+        detachOperation(operation);
+      }
+      _attachedAccounts.remove(account);
+      if (auto id = _accountIds.take(account)) {
+        _deletedAccountIds.insert(id);
+      }
+    }
+  }
+
+  for (Account* account : accounts) {
+    if (!_attachedAccounts.contains(account)) {
+      attachAccount(account);
+    }
+  }
+}
+
+void SqliteStorage::attachAccount(Account* account) {
+  _attachedAccounts.insert(account);
+
+  connect(account, &Account::rowsInserted, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      attachOperation(account->operationAt(row));
+    }
+  });
+  // Emitted before the operation leaves the account, so it can still be looked up
+  connect(account, &Account::rowsAboutToBeRemoved, this, [this, account](const QModelIndex&, int first, int last) {
+    for (int row = first; row <= last; ++row) {
+      detachOperation(account->operationAt(row));
+    }
+  });
+  connect(account, &Account::modelReset, this, [this, account] {
+    // Operations deleted with the reset are handled on destruction
+    for (Operation* operation : account->operations()) {
+      if (!_attachedOperations.contains(operation)) {
+        attachOperation(operation);
+      }
+    }
+  });
+  connect(account, &QObject::destroyed, this, [this, account] {
+    _attachedAccounts.remove(account);
+    _pendingAccounts.remove(account);
+    if (auto id = _accountIds.take(account)) {
+      _deletedAccountIds.insert(id);
+    }
+  });
+
+  for (Operation* operation : account->operations()) {
+    attachOperation(operation);
+  }
+}
+
+void SqliteStorage::attachOperation(Operation* operation) {
+  if (!operation)
+    return;
+
+  _attachedOperations.insert(operation);
+  if (!_operationIds.contains(operation)) {
+    _dirtyOperations.insert(operation);
+  }
+
+  auto markDirty = [this, operation] { _dirtyOperations.insert(operation); };
+  connect(operation, &Operation::dateChanged, this, markDirty);
+  connect(operation, &Operation::budgetDateChanged, this, markDirty);
+  connect(operation, &Operation::amountChanged, this, markDirty);
+  connect(operation, &Operation::labelChanged, this, markDirty);
+  connect(operation, &Operation::detailsChanged, this, markDirty);
+  connect(operation, &Operation::allocationsChanged, this, markDirty);
+  connect(operation, &QObject::destroyed, this, [this, operation] {
+    _attachedOperations.remove(operation);
+    _dirtyOperations.remove(operation);
+    if (auto id = _operationIds.take(operation)) {
+      _deletedOperationIds.insert(id);
+    }
+  });
+}
+
+void SqliteStorage::detachOperation(Operation* operation) {
+  if (!operation)
+    return;
+
+  // A removed operation living on in an undo command comes back as a new row
+  disconnect(operation, nullptr, this, nullptr);
+  _attachedOperations.remove(operation);
+  _dirtyOperations.remove(operation);
+  if (auto id = _operationIds.take(operation)) {
+    _deletedOperationIds.insert(id);
+  }
+}
+
+void SqliteStorage::syncCategories() {
+  if (!_tracking)
+    return;
+
+  const QList<Category*> categories = _categoryController.categories();
+  const QSet<const Category*> present(categories.cbegin(), categories.cend());
+
+  const QSet<const Category*> attached = _attachedCategories;
+  for (const Category* category : attached) {
+    if (!present.contains(category)) {
+      disconnect(category, nullptr, this, nullptr);
+      _attachedCategories.remove(category);
+      _dirtyCategories.remove(category);
+      if (auto id = _categoryIds.take(category)) {
+        _deletedCategoryIds.insert(id);
+      }
+    }
+  }
+
+  for (Category* category : categories) {
+    if (!_attachedCategories.contains(category)) {
+      attachCategory(category);
+    }
+  }
+}
+
+void SqliteStorage::attachCategory(Category* category) {
+  _attachedCategories.insert(category);
+  if (!_categoryIds.contains(category)) {
+    _dirtyCategories.insert(category);
+    // A category coming back (e.g. on undo) gets a new id, rewrite the operations using it
+    for (Account* account : _budgetData.accounts()) {
+      for (Operation* operation : account->operationsWithCategory(category)) {
+        if (_attachedOperations.contains(operation)) {
+          _dirtyOperations.insert(operation);
+        }
+      }
+    }
+  }
+
+  auto markDirty = [this, category] { _dirtyCategories.insert(category); };
+  connect(category, &Category::nameChanged, this, markDirty);
+  connect(category, &Category::budgetLimitChanged, this, markDirty);
+  connect(category, &Category::monthHistoryChanged, this, markDirty);
+  connect(category, &QObject::destroyed, this, [this, category] {
+    _attachedCategories.remove(category);
+    _dirtyCategories.remove(category);
+    if (auto id = _categoryIds.take(category)) {
+      _deletedCategoryIds.insert(id);
+    }
+  });
+}
+
+void SqliteStorage::markAllDirty() {
+  // Writing to a new file: every object gets a new row
+  _accountIds.clear();
+  _categoryIds.clear();
+  _operationIds.clear();
+  _deletedAccountIds.clear();
+  _deletedCategoryIds.clear();
+  _deletedOperationIds.clear();
+  _tracking = true;
+  syncAccounts();
+  syncCategories();
+  _dirtyOperations = _attachedOperations;
+  _dirtyCategories = _attachedCategories;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class Account;
+class BudgetData;
+class Category;
+class CategoryController;
+class Operation;
+class QSqlQuery;
+class RuleController;
+
+// SQLite storage engine, an alternative to the YAML file format for large histories.
+// Rows keep stable ids across saves: once a file has been loaded or saved, saving it again
+// only writes the operations and categories that changed since, in a single transaction.
+// On load, only the current account operations are read. The other accounts are filled
+// from the event loop, or immediately when shown, scanned, saved or edited in bulk.
+class SqliteStorage : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr const char* FileSuffix = "comptinedb";
+
+  SqliteStorage(BudgetData& budgetData,
+                CategoryController& categoryController,
+                RuleController& ruleController,
+                QObject* parent = nullptr);
+  ~SqliteStorage() override;
+
+  static bool isStorageFile(const QString& filePath);
+
+  // Replace the budget content with the file content
+  bool load(const QString& filePath);
+
+  // Write the budget to the file, incrementally if it is the file last loaded or saved
+  bool save(const QString& filePath);
+
+  // Read the operations of the accounts not loaded yet
+  bool loadPendingAccounts();
+
+  // Forget the current file and the pending changes
+  void close();
+
+  QString errorString() const { return _errorString; }
+
+private:
+  bool open(const QString& filePath);
+  bool createSchema();
+  bool clearTables();
+  bool readAll();
+  bool loadAccount(Account* account);
+  void scheduleLoad();
+  Account* nextPendingAccount() const;
+  bool writeChanges();
+  bool writeCategories();
+  bool writeAccounts();
+  bool writeOperations();
+  bool writeCurrentOperations();
+  bool writeRules();
+  bool writeState();
+  bool exec(QSqlQuery& query);
+  bool exec(const QString& statement);
+
+  // Change tracking
+  void syncAccounts();
+  void attachAccount(Account* account);
+  void attachOperation(Operation* operation);
+  void detachOperation(Operation* operation);
+  void syncCategories();
+  void attachCategory(Category* category);
+  void markAllDirty();
+
+  BudgetData& _budgetData;
+  CategoryController& _categoryController;
+  RuleController& _ruleController;
+  QString _connectionName;
+  QString _filePath;  // File the ids below refer to
+  QString _errorString;
+  bool _tracking = false;
+
+  QHash<const Account*, qint64> _accountIds;
+  QHash<const Category*, qint64> _categoryIds;
+  QHash<const Operation*, qint64> _operationIds;
+  QSet<const Account*> _attachedAccounts;
+  QSet<const Category*> _attachedCategories;
+  QSet<Operation*> _attachedOperations;
+  QSet<const Category*> _dirtyCategories;
+  QSet<Operation*> _dirtyOperations;
+  QSet<qint64> _deletedAccountIds;
+  QSet<qint64> _deletedCategoryIds;
+  QSet<qint64> _deletedOperationIds;
+
+  // Accounts whose operations are not read yet
+  struct PendingAccount {
+    qint64 id = 0;
+    qint64 currentOperationId = -1;
+  };
+  QHash<Account*, PendingAccount> _pendingAccounts;
+  bool _loadScheduled = false;
+};
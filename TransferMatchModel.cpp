@@ -0,0 +1,258 @@
+#include <QSet>
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+
+#include "Account.h"
+#include "BudgetData.h"
+#include "Operation.h"
+#include "TransferMatchModel.h"
+#include "UndoCommands.h"
+
+namespace {
+
+struct Entry {
+  qint64 absoluteCents;
+  qint64 day;  // Julian day
+  int account;
+  int row;
+  Operation* operation;
+  bool source;  // Categorized, can give its allocations
+  bool target;  // Without allocations, can receive them
+};
+
+bool byAmountAndDate(const Entry& a, const Entry& b) {
+  return std::tie(a.absoluteCents, a.day, a.account, a.row) < std::tie(b.absoluteCents, b.day, b.account, b.row);
+}
+
+bool canGiveAllocations(const Operation* source) {
+  return !source->allocations().isEmpty() && source->isCategorized();
+}
+
+// The categorized side of a match gives its allocations to the uncategorized side
+bool canReceiveAllocations(const Operation* target, const Operation* source) {
+  return target->allocations().isEmpty() && canGiveAllocations(source);
+}
+
+bool canPair(const Entry& a, const Entry& b) {
+  return (a.source && b.target) || (a.target && b.source);
+}
+
+}  // namespace
+
+QList<TransferMatchModel::Match> TransferMatchModel::findMatches(const QList<Account*>& accounts, int maxDays) {
+  QList<Entry> outflows;
+  QList<Entry> inflows;
+  for (int accountIndex = 0; accountIndex < accounts.size(); ++accountIndex) {
+    const QList<Operation*> operations = accounts[accountIndex]->operations();
+    for (int row = 0; row < operations.size(); ++row) {
+      Operation* operation = operations[row];
+      const qint64 cents = operation->amountMoney().cents();
+      const bool source = canGiveAllocations(operation);
+      const bool target = operation->allocations().isEmpty();
+      if (cents == 0 || (!source && !target))
+        continue;
+      Entry entry{ cents < 0 ? -cents : cents, operation->date().toJulianDay(), accountIndex, row, operation, source, target };
+      (cents < 0 ? outflows : inflows).append(entry);
+    }
+  }
+  std::sort(outflows.begin(), outflows.end(), byAmountAndDate);
+  std::sort(inflows.begin(), inflows.end(), byAmountAndDate);
+
+  QList<Match> matches;
+  QList<bool> inflowMatched(inflows.size(), false);
+  qsizetype out = 0;
+  qsizetype in = 0;
+  while (out < outflows.size() && in < inflows.size()) {
+    const qint64 amount = outflows[out].absoluteCents;
+    if (amount < inflows[in].absoluteCents) {
+      ++out;
+      continue;
+    }
+    if (amount > inflows[in].absoluteCents) {
+      ++in;
+      continue;
+    }
+
+    qsizetype outEnd = out;
+    while (outEnd < outflows.size() && outflows[outEnd].absoluteCents == amount) {
+      ++outEnd;
+    }
+    qsizetype inEnd = in;
+    while (inEnd < inflows.size() && inflows[inEnd].absoluteCents == amount) {
+      ++inEnd;
+    }
+
+    // Both groups are sorted by date: slide the window of candidate inflows along the outflows
+    qsizetype windowStart = in;
+    for (; out < outEnd; ++out) {
+      const Entry& outflow = outflows[out];
+      while (windowStart < inEnd && (inflowMatched[windowStart] || inflows[windowStart].day < outflow.day - maxDays)) {
+        ++windowStart;
+      }
+      qsizetype best = -1;
+      for (qsizetype candidate = windowStart; candidate < inEnd && inflows[candidate].day <= outflow.day + maxDays; ++candidate) {
+        if (inflowMatched[candidate] || inflows[candidate].account == outflow.account || !canPair(outflow, inflows[candidate]))
+          continue;
+        if (best < 0 || std::abs(inflows[candidate].day - outflow.day) < std::abs(inflows[best].day - outflow.day)) {
+          best = candidate;
+        }
+      }
+      if (best >= 0) {
+        inflowMatched[best] = true;
+        matches.append({ outflow.operation, inflows[best].operation });
+      }
+    }
+    in = inEnd;
+  }
+  return matches;
+}
+
+TransferMatchModel::TransferMatchModel(BudgetData& budgetData, QUndoStack& undoStack, QObject* parent) :
+    QAbstractListModel(parent),
+    _budgetData(budgetData),
+    _undoStack(undoStack) {
+}
+
+int TransferMatchModel::rowCount(const QModelIndex& parent) const {
+  if (parent.isValid())
+    return 0;
+  return _rows.size();
+}
+
+QVariant TransferMatchModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= _rows.size()) {
+    return QVariant();
+  }
+
+  const Row& row = _rows[index.row()];
+  const Operation* source = row.source;
+  const Operation* target = row.target;
+  if (!source || !target) {
+    return QVariant();
+  }
+
+  switch (static_cast<Roles>(role)) {
+    case SourceRole:
+      return QVariant::fromValue(row.source.data());
+    case TargetRole:
+      return QVariant::fromValue(row.target.data());
+    case SourceAccountNameRole:
+      return source->account() ? source->account()->name() : QString();
+    case TargetAccountNameRole:
+      return target->account() ? target->account()->name() : QString();
+    case SourceDateRole:
+      return source->date();
+    case TargetDateRole:
+      return target->date();
+    case SourceLabelRole:
+      return source->label();
+    case TargetLabelRole:
+      return target->label();
+    case AmountRole:
+      return source->amount();
+    case DayGapRole:
+      return int(std::abs(target->date().toJulianDay() - source->date().toJulianDay()));
+    case AcceptedRole:
+      return row.accepted;
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> TransferMatchModel::roleNames() const {
+  return {
+    { SourceRole, "source" },
+    { TargetRole, "target" },
+    { SourceAccountNameRole, "sourceAccountName" },
+    { TargetAccountNameRole, "targetAccountName" },
+    { SourceDateRole, "sourceDate" },
+    { TargetDateRole, "targetDate" },
+    { SourceLabelRole, "sourceLabel" },
+    { TargetLabelRole, "targetLabel" },
+    { AmountRole, "amount" },
+    { DayGapRole, "dayGap" },
+    { AcceptedRole, "accepted" },
+  };
+}
+
+int TransferMatchModel::acceptedCount() const {
+  return int(std::count_if(_rows.cbegin(), _rows.cend(), [](const Row& row) { return row.accepted; }));
+}
+
+void TransferMatchModel::refresh() {
+  _budgetData.requireAllAccounts();
+
+  QList<Row> rows;
+  for (const Match& match : findMatches(_budgetData.accounts(), _maxDays)) {
+    if (canReceiveAllocations(match.inflow, match.outflow)) {
+      rows.append({ match.outflow, match.inflow, true });
+    } else if (canReceiveAllocations(match.outflow, match.inflow)) {
+      rows.append({ match.inflow, match.outflow, true });
+    }
+  }
+  setRows(rows);
+}
+
+void TransferMatchModel::setAccepted(int index, bool accepted) {
+  if (index < 0 || index >= _rows.size() || _rows[index].accepted == accepted)
+    return;
+  _rows[index].accepted = accepted;
+  const QModelIndex modelIndex = this->index(index);
+  emit dataChanged(modelIndex, modelIndex, { AcceptedRole });
+  emit acceptedCountChanged();
+}
+
+int TransferMatchModel::apply() {
+  // Operations deleted since the refresh may still be alive in the undo stack
+  QSet<const Operation*> operations;
+  for (const Account* account : _budgetData.accounts()) {
+    for (const Operation* operation : account->operations()) {
+      operations.insert(operation);
+    }
+  }
+
+  QUndoCommand* macroCommand = new BatchCommand(_budgetData);
+  int count = 0;
+  for (const Row& row : std::as_const(_rows)) {
+    if (!row.accepted || !row.source || !row.target || !operations.contains(row.source) || !operations.contains(row.target)
+        || !canReceiveAllocations(row.target, row.source))
+      continue;
+
+    QList<Allocation*> newAllocations;
+    for (const Allocation* allocation : row.source->allocations()) {
+      newAllocations.append(new Allocation(allocation->category(), -allocation->amountMoney()));
+    }
+    new SplitOperationCommand(*row.target, newAllocations, macroCommand);
+    count++;
+  }
+
+  if (count > 0) {
+    macroCommand->setText(tr("Match %n transfer(s)", "", count));
+    _undoStack.push(macroCommand);
+  } else {
+    delete macroCommand;
+  }
+
+  refresh();
+  return count;
+}
+
+void TransferMatchModel::clear() {
+  setRows({});
+}
+
+void TransferMatchModel::setRows(QList<Row> rows) {
+  const int previousCount = _rows.size();
+  const int previousAcceptedCount = acceptedCount();
+
+  beginResetModel();
+  _rows = std::move(rows);
+  endResetModel();
+
+  if (_rows.size() != previousCount) {
+    emit countChanged();
+  }
+  if (acceptedCount() != previousAcceptedCount) {
+    emit acceptedCountChanged();
+  }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QQmlEngine>
+#include <QUndoStack>
+
+#include "PropertyMacros.h"
+
+class Account;
+class BudgetData;
+class Operation;
+
+// Proposed transfers between accounts: operations of opposite amounts in two accounts,
+// dated within a few days of each other. A match is proposed when one side is categorized
+// and the other is not; applying it makes the uncategorized side a counterpart of the
+// other (see BudgetData::createCounterPart), in a single undo step.
+class TransferMatchModel : public QAbstractListModel {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_UNCREATABLE("Owned by BudgetData")
+
+  Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+  Q_PROPERTY(int acceptedCount READ acceptedCount NOTIFY acceptedCountChanged)
+  PROPERTY_RW(int, maxDays, 3)  // Largest date gap between both sides of a transfer
+
+public:
+  enum Roles {
+    SourceRole = Qt::UserRole + 1,  // Categorized side
+    TargetRole,                     // Uncategorized side, receiving the allocations
+    SourceAccountNameRole,
+    TargetAccountNameRole,
+    SourceDateRole,
+    TargetDateRole,
+    SourceLabelRole,
+    TargetLabelRole,
+    AmountRole,  // Amount of the source
+    DayGapRole,
+    AcceptedRole,
+  };
+  Q_ENUM(Roles)
+
+  // Pair of operations of opposite amounts in different accounts, one categorized and the
+  // other without allocations
+  struct Match {
+    Operation* outflow = nullptr;
+    Operation* inflow = nullptr;
+  };
+
+  // Each operation is part of at most one match, paired with the closest date first. Pairs
+  // that could not be applied are never joined, so they do not take the place of one that could.
+  // Outflows and inflows are sorted by (absolute amount, date) and merge-joined on the amount,
+  // with a window of maxDays on the date: O(n log n) plus the size of the windows.
+  static QList<Match> findMatches(const QList<Account*>& accounts, int maxDays);
+
+  TransferMatchModel(BudgetData& budgetData, QUndoStack& undoStack, QObject* parent = nullptr);
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+  int acceptedCount() const;
+
+  Q_INVOKABLE void refresh();  // Match the operations of every account
+  Q_INVOKABLE void setAccepted(int index, bool accepted);
+  Q_INVOKABLE int apply();  // Apply the accepted matches, returns how many were applied
+  Q_INVOKABLE void clear();
+
+signals:
+  void countChanged();
+  void acceptedCountChanged();
+
+private:
+  struct Row {
+    QPointer<Operation> source;
+    QPointer<Operation> target;
+    bool accepted = true;
+  };
+
+  void setRows(QList<Row> rows);
+
+  BudgetData& _budgetData;
+  QUndoStack& _undoStack;
+  QList<Row> _rows;
+};
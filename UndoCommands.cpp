@@ -1,12 +1,29 @@
 #include "UndoCommands.h"
 #include "Account.h"
+#include "BatchScope.h"
 #include "BudgetData.h"
 #include "Category.h"
 #include "CategoryController.h"
 #include "Operation.h"
 #include "Rule.h"
 #include "RuleController.h"
-#include "RuleListModel.h"
+
+// BatchCommand implementation
+
+BatchCommand::BatchCommand(BudgetData& budgetData, QUndoCommand* parent) :
+    QUndoCommand(parent),
+    _budgetData(budgetData) {
+}
+
+void BatchCommand::undo() {
+  BatchScope batch(_budgetData);
+  QUndoCommand::undo();
+}
+
+void BatchCommand::redo() {
+  BatchScope batch(_budgetData);
+  QUndoCommand::redo();
+}
 
 // AddAccountCommand implementation
 
@@ -65,14 +82,14 @@ void RenameAccountCommand::redo() {
 
 EditCategoryCommand::EditCategoryCommand(Category& category,
                                          const QString& newName,
-                                         double newBudgetLimit,
+                                         Money newBudgetLimit,
                                          const QDate& budgetDate,
                                          QUndoCommand* parent) :
     QUndoCommand(parent),
     _category(category),
     _oldName(category.name()),
     _newName(newName),
-    _oldBudgetLimit(category.budgetLimitForMonth(budgetDate)),
+    _oldBudgetLimit(category.budgetLimitMoneyForMonth(budgetDate)),
     _newBudgetLimit(newBudgetLimit),
     _budgetDate(budgetDate),
     _historyDate(budgetDate.addMonths(-1)) {
@@ -117,6 +134,37 @@ void EditCategoryCommand::redo() {
   }
 }
 
+int EditCategoryCommand::id() const {
+  return EditCategoryId;
+}
+
+bool EditCategoryCommand::mergeWith(const QUndoCommand* other) {
+  const EditCategoryCommand* cmd = dynamic_cast<const EditCategoryCommand*>(other);
+  if (!cmd || &cmd->_category != &_category || cmd->_budgetDate != _budgetDate)
+    return false;
+
+  const bool limitChanged = _oldBudgetLimit != _newBudgetLimit;
+  const bool otherLimitChanged = cmd->_oldBudgetLimit != cmd->_newBudgetLimit;
+  if ((limitChanged || otherLimitChanged) && cmd->_newBudgetLimit == _oldBudgetLimit) {
+    // The limit went back to its original value but month_history was written: keep both steps
+    return false;
+  }
+  if (!limitChanged) {
+    _previousHistoryBudgetLimit = cmd->_previousHistoryBudgetLimit;
+  }
+
+  // Keep our old values (for undo), take their new values (for redo)
+  _newName = cmd->_newName;
+  _newBudgetLimit = cmd->_newBudgetLimit;
+  if (limitChanged && otherLimitChanged) {
+    // The second edit recorded our intermediate limit as history, put the original one back
+    _category.setBudgetLimitForMonth(_historyDate.year(), _historyDate.month(), _oldBudgetLimit);
+  }
+  setText(cmd->text());
+  setObsolete(_newName == _oldName && _newBudgetLimit == _oldBudgetLimit);
+  return true;
+}
+
 // AddCategoryCommand implementation
 
 AddCategoryCommand::AddCategoryCommand(CategoryController* categoryController, Category* category,
@@ -277,6 +325,22 @@ void SetOperationBudgetDateCommand::redo() {
   _operation.set_budgetDate(_newBudgetDate);
 }
 
+int SetOperationBudgetDateCommand::id() const {
+  return SetOperationBudgetDateId;
+}
+
+bool SetOperationBudgetDateCommand::mergeWith(const QUndoCommand* other) {
+  const SetOperationBudgetDateCommand* cmd = dynamic_cast<const SetOperationBudgetDateCommand*>(other);
+  if (!cmd || &cmd->_operation != &_operation)
+    return false;
+
+  // Keep our old value (for undo), take their new value (for redo)
+  _newBudgetDate = cmd->_newBudgetDate;
+  setText(cmd->text());
+  setObsolete(_newBudgetDate == _oldBudgetDate);  // Edited back to where it started: drop the step
+  return true;
+}
+
 SplitOperationCommand::SplitOperationCommand(Operation& operation,
                                              const QList<Allocation*>& newAllocations,
                                              QUndoCommand* parent) :
@@ -304,14 +368,14 @@ void SplitOperationCommand::redo() {
 }
 
 SetOperationAmountCommand::SetOperationAmountCommand(Operation& operation,
-                                                     double oldAmount,
-                                                     double newAmount,
+                                                     Money oldAmount,
+                                                     Money newAmount,
                                                      QUndoCommand* parent) :
     QUndoCommand(parent),
     _operation(operation),
     _oldAmount(oldAmount),
     _newAmount(newAmount) {
-  setText(QObject::tr("Set operation amount to %1").arg(newAmount, 0, 'f', 2));
+  setText(QObject::tr("Set operation amount to %1").arg(newAmount.toString()));
 }
 
 void SetOperationAmountCommand::undo() {
@@ -322,6 +386,22 @@ void SetOperationAmountCommand::redo() {
   _operation.set_amount(_newAmount);
 }
 
+int SetOperationAmountCommand::id() const {
+  return SetOperationAmountId;
+}
+
+bool SetOperationAmountCommand::mergeWith(const QUndoCommand* other) {
+  const SetOperationAmountCommand* cmd = dynamic_cast<const SetOperationAmountCommand*>(other);
+  if (!cmd || &cmd->_operation != &_operation)
+    return false;
+
+  // Keep our old value (for undo), take their new value (for redo)
+  _newAmount = cmd->_newAmount;
+  setText(cmd->text());
+  setObsolete(_newAmount == _oldAmount);  // Edited back to where it started: drop the step
+  return true;
+}
+
 SetOperationDateCommand::SetOperationDateCommand(Operation& operation,
                                                  const QDate& oldDate,
                                                  const QDate& newDate,
@@ -341,6 +421,22 @@ void SetOperationDateCommand::redo() {
   _operation.set_date(_newDate);
 }
 
+int SetOperationDateCommand::id() const {
+  return SetOperationDateId;
+}
+
+bool SetOperationDateCommand::mergeWith(const QUndoCommand* other) {
+  const SetOperationDateCommand* cmd = dynamic_cast<const SetOperationDateCommand*>(other);
+  if (!cmd || &cmd->_operation != &_operation)
+    return false;
+
+  // Keep our old value (for undo), take their new value (for redo)
+  _newDate = cmd->_newDate;
+  setText(cmd->text());
+  setObsolete(_newDate == _oldDate);  // Edited back to where it started: drop the step
+  return true;
+}
+
 SetOperationLabelCommand::SetOperationLabelCommand(Operation& operation,
                                                    const QString& oldLabel,
                                                    const QString& newLabel,
@@ -360,6 +456,22 @@ void SetOperationLabelCommand::redo() {
   _operation.set_label(_newLabel);
 }
 
+int SetOperationLabelCommand::id() const {
+  return SetOperationLabelId;
+}
+
+bool SetOperationLabelCommand::mergeWith(const QUndoCommand* other) {
+  const SetOperationLabelCommand* cmd = dynamic_cast<const SetOperationLabelCommand*>(other);
+  if (!cmd || &cmd->_operation != &_operation)
+    return false;
+
+  // Keep our old value (for undo), take their new value (for redo)
+  _newLabel = cmd->_newLabel;
+  setText(cmd->text());
+  setObsolete(_newLabel == _oldLabel);  // Edited back to where it started: drop the step
+  return true;
+}
+
 SetOperationDetailsCommand::SetOperationDetailsCommand(Operation& operation,
                                                        const QString& oldDetails,
                                                        const QString& newDetails,
@@ -379,6 +491,22 @@ void SetOperationDetailsCommand::redo() {
   _operation.set_details(_newDetails);
 }
 
+int SetOperationDetailsCommand::id() const {
+  return SetOperationDetailsId;
+}
+
+bool SetOperationDetailsCommand::mergeWith(const QUndoCommand* other) {
+  const SetOperationDetailsCommand* cmd = dynamic_cast<const SetOperationDetailsCommand*>(other);
+  if (!cmd || &cmd->_operation != &_operation)
+    return false;
+
+  // Keep our old value (for undo), take their new value (for redo)
+  _newDetails = cmd->_newDetails;
+  setText(cmd->text());
+  setObsolete(_newDetails == _oldDetails);  // Edited back to where it started: drop the step
+  return true;
+}
+
 // SetLeftoverDecisionCommand implementation
 
 SetLeftoverDecisionCommand::SetLeftoverDecisionCommand(Category& category,
@@ -396,12 +524,12 @@ SetLeftoverDecisionCommand::SetLeftoverDecisionCommand(Category& category,
   QString actionStr;
   if (newDecision.saveAmount > 0 && newDecision.reportAmount > 0) {
     actionStr = QObject::tr("save %1 and report %2")
-                    .arg(newDecision.saveAmount, 0, 'f', 2)
-                    .arg(newDecision.reportAmount, 0, 'f', 2);
+                    .arg(newDecision.saveAmount.toString())
+                    .arg(newDecision.reportAmount.toString());
   } else if (newDecision.saveAmount > 0) {
-    actionStr = QObject::tr("save %1").arg(newDecision.saveAmount, 0, 'f', 2);
+    actionStr = QObject::tr("save %1").arg(newDecision.saveAmount.toString());
   } else if (newDecision.reportAmount != 0) {
-    actionStr = QObject::tr("report %1").arg(newDecision.reportAmount, 0, 'f', 2);
+    actionStr = QObject::tr("report %1").arg(newDecision.reportAmount.toString());
   } else {
     actionStr = QObject::tr("clear");
   }
@@ -415,7 +543,7 @@ void SetLeftoverDecisionCommand::undo() {
     _category.setLeftoverDecision(_date.year(), _date.month(), _oldDecision);
   }
   if (_categoryController) {
-    emit _categoryController->budgetDataChanged();
+    _categoryController->notifyBudgetDataChanged();
   }
 }
 
@@ -426,13 +554,12 @@ void SetLeftoverDecisionCommand::redo() {
     _category.setLeftoverDecision(_date.year(), _date.month(), _newDecision);
   }
   if (_categoryController) {
-    emit _categoryController->budgetDataChanged();
+    _categoryController->notifyBudgetDataChanged();
   }
 }
 
 int SetLeftoverDecisionCommand::id() const {
-  // Unique ID for leftover decision commands to enable merging
-  return 1001;
+  return SetLeftoverDecisionId;
 }
 
 bool SetLeftoverDecisionCommand::mergeWith(const QUndoCommand* other) {
@@ -451,12 +578,12 @@ bool SetLeftoverDecisionCommand::mergeWith(const QUndoCommand* other) {
   QString actionStr;
   if (_newDecision.saveAmount > 0 && _newDecision.reportAmount > 0) {
     actionStr = QObject::tr("save %1 and report %2")
-                    .arg(_newDecision.saveAmount, 0, 'f', 2)
-                    .arg(_newDecision.reportAmount, 0, 'f', 2);
+                    .arg(_newDecision.saveAmount.toString())
+                    .arg(_newDecision.reportAmount.toString());
   } else if (_newDecision.saveAmount > 0) {
-    actionStr = QObject::tr("save %1").arg(_newDecision.saveAmount, 0, 'f', 2);
+    actionStr = QObject::tr("save %1").arg(_newDecision.saveAmount.toString());
   } else if (_newDecision.reportAmount != 0) {
-    actionStr = QObject::tr("report %1").arg(_newDecision.reportAmount, 0, 'f', 2);
+    actionStr = QObject::tr("report %1").arg(_newDecision.reportAmount.toString());
   } else {
     actionStr = QObject::tr("clear");
   }
@@ -524,12 +651,7 @@ RemoveRuleCommand::~RemoveRuleCommand() {
 void RemoveRuleCommand::undo() {
   if (_ruleController && _rule) {
     // Re-insert the rule at the original index
-    _ruleController->addRule(_rule);
-    // Move it to the original position if needed
-    int currentIndex = _ruleController->rules().indexOf(_rule);
-    if (currentIndex != _index && currentIndex >= 0) {
-      _ruleController->moveRule(currentIndex, _index);
-    }
+    _ruleController->insertRule(_index, _rule);
     _ownsRule = false;
   }
 }
@@ -549,7 +671,8 @@ void RemoveRuleCommand::redo() {
 EditRuleCommand::EditRuleCommand(RuleController* ruleController, int index,
                                  const Category* oldCategory, const Category* newCategory,
                                  const QString& oldLabelMatch, const QString& newLabelMatch,
-                                 double oldAmountFilter, double newAmountFilter,
+                                 Money oldAmountFilter, Money newAmountFilter,
+                                 Rule::MatchMode oldMatchMode, Rule::MatchMode newMatchMode,
                                  QUndoCommand* parent) :
     QUndoCommand(parent),
     _ruleController(ruleController),
@@ -559,7 +682,9 @@ EditRuleCommand::EditRuleCommand(RuleController* ruleController, int index,
     _oldLabelMatch(oldLabelMatch),
     _newLabelMatch(newLabelMatch),
     _oldAmountFilter(oldAmountFilter),
-    _newAmountFilter(newAmountFilter) {
+    _newAmountFilter(newAmountFilter),
+    _oldMatchMode(oldMatchMode),
+    _newMatchMode(newMatchMode) {
   setText(QObject::tr("Edit rule for \"%1\"").arg(newLabelMatch));
 }
 
@@ -570,7 +695,7 @@ void EditRuleCommand::undo() {
       rule->set_category(_oldCategory);
       rule->set_labelMatch(_oldLabelMatch);
       rule->set_amountFilter(_oldAmountFilter);
-      _ruleController->ruleModel()->refresh();
+      rule->set_matchMode(_oldMatchMode);
       emit _ruleController->rulesChanged();
     }
   }
@@ -583,7 +708,7 @@ void EditRuleCommand::redo() {
       rule->set_category(_newCategory);
       rule->set_labelMatch(_newLabelMatch);
       rule->set_amountFilter(_newAmountFilter);
-      _ruleController->ruleModel()->refresh();
+      rule->set_matchMode(_newMatchMode);
       emit _ruleController->rulesChanged();
     }
   }
@@ -9,20 +9,44 @@
 
 #include "Category.h"   // For MonthRecord
 #include "Operation.h"  // For Allocation
+#include "Rule.h"       // For Rule::MatchMode
 
 class Account;
 class AccountListModel;
 class BudgetData;
 class Category;
-class Rule;
 class CategoryController;
 class RuleController;
 
+// Ids of commands that merge with a consecutive command of the same kind (see QUndoCommand::id)
+enum UndoCommandId {
+  SetLeftoverDecisionId = 1001,
+  EditCategoryId,
+  SetOperationBudgetDateId,
+  SetOperationAmountId,
+  SetOperationDateId,
+  SetOperationLabelId,
+  SetOperationDetailsId,
+};
+
 class UndoStack : public QUndoStack {
   Q_OBJECT
   QML_ELEMENT
 };
 
+// Macro command whose children are undone and redone inside a BudgetData batch,
+// so that bulk edits trigger a single balance and category recompute
+class BatchCommand : public QUndoCommand {
+public:
+  explicit BatchCommand(BudgetData& budgetData, QUndoCommand* parent = nullptr);
+
+  void undo() override;
+  void redo() override;
+
+private:
+  BudgetData& _budgetData;
+};
+
 // Command for adding a new account
 // Note: This command manages account lifecycle in BudgetData
 class AddAccountCommand : public QUndoCommand {
@@ -66,22 +90,24 @@ class EditCategoryCommand : public QUndoCommand {
 public:
   EditCategoryCommand(Category& category,
                       const QString& newName,
-                      double newBudgetLimit,
+                      Money newBudgetLimit,
                       const QDate& budgetDate,
                       QUndoCommand* parent = nullptr);
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Category& _category;
   QString _oldName;
   QString _newName;
-  double _oldBudgetLimit;
-  double _newBudgetLimit;
+  Money _oldBudgetLimit;
+  Money _newBudgetLimit;
   QDate _budgetDate;                                  // The budget month when the change was made
   QDate _historyDate;                                 // The month before budgetDate (where old limit is stored)
-  std::optional<double> _previousHistoryBudgetLimit;  // What was in month_history before (to restore on undo)
+  std::optional<Money> _previousHistoryBudgetLimit;  // What was in month_history before (to restore on undo)
 };
 
 // Command for adding a single category
@@ -177,6 +203,8 @@ public:
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Operation& _operation;
@@ -203,16 +231,18 @@ private:
 class SetOperationAmountCommand : public QUndoCommand {
 public:
   SetOperationAmountCommand(Operation& operation,
-                            double oldAmount, double newAmount,
+                            Money oldAmount, Money newAmount,
                             QUndoCommand* parent = nullptr);
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Operation& _operation;
-  double _oldAmount;
-  double _newAmount;
+  Money _oldAmount;
+  Money _newAmount;
 };
 
 // Command for setting an operation's date
@@ -224,6 +254,8 @@ public:
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Operation& _operation;
@@ -241,6 +273,8 @@ public:
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Operation& _operation;
@@ -258,6 +292,8 @@ public:
 
   void undo() override;
   void redo() override;
+  int id() const override;
+  bool mergeWith(const QUndoCommand* other) override;
 
 private:
   Operation& _operation;
@@ -327,7 +363,8 @@ public:
   EditRuleCommand(RuleController* ruleController, int index,
                   const Category* oldCategory, const Category* newCategory,
                   const QString& oldLabelMatch, const QString& newLabelMatch,
-                  double oldAmountFilter, double newAmountFilter,
+                  Money oldAmountFilter, Money newAmountFilter,
+                  Rule::MatchMode oldMatchMode, Rule::MatchMode newMatchMode,
                   QUndoCommand* parent = nullptr);
 
   void undo() override;
@@ -340,8 +377,10 @@ private:
   const Category* _newCategory;
   QString _oldLabelMatch;
   QString _newLabelMatch;
-  double _oldAmountFilter;
-  double _newAmountFilter;
+  Money _oldAmountFilter;
+  Money _newAmountFilter;
+  Rule::MatchMode _oldMatchMode;
+  Rule::MatchMode _newMatchMode;
 };
 
 // Command for moving a categorization rule (reordering priority)
@@ -0,0 +1,52 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+import commonui
+import Comptine
+
+BaseDialog {
+    id: root
+    title: qsTr("Archive Closed Years")
+    acceptButtonText: qsTr("Archive")
+    width: 450
+
+    okEnabled: FileController.currentFilePath.length > 0
+
+    onOpened: yearSpinBox.value = BudgetData.budgetDate.getFullYear()
+    onAccepted: FileController.archiveYearsBefore(yearSpinBox.value)
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: Theme.spacingNormal
+
+        RowLayout {
+            spacing: Theme.spacingNormal
+
+            Label {
+                text: qsTr("Archive operations before:")
+            }
+
+            SpinBox {
+                id: yearSpinBox
+                from: 1900
+                to: new Date().getFullYear()
+                editable: true
+                textFromValue: (value, locale) => value.toString()
+                valueFromText: (text, locale) => parseInt(text)
+            }
+        }
+
+        Label {
+            text: FileController.currentFilePath.length > 0 ? qsTr("Archived operations move to read-only files next to the budget. Their months can still be browsed, but they can no longer be edited, and archiving cannot be undone.") : qsTr("Save the budget before archiving years.")
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        Label {
+            text: qsTr("Archived years: %1").arg(CategoryController.archive.years.join(", "))
+            visible: CategoryController.archive.years.length > 0
+            color: Theme.textSecondary
+        }
+    }
+}
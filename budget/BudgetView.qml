@@ -10,7 +10,7 @@ import Comptine
 FocusScope {
     id: root
 
-    property bool dialogOpen: categoryEditDialog.visible
+    property bool dialogOpen: categoryEditDialog.visible || archiveYearsDialog.visible
 
     function editCurrentCategory() {
         let category = CategoryController.current;
@@ -23,6 +23,10 @@ FocusScope {
         categoryEditDialog.edit();
     }
 
+    function archiveYears() {
+        archiveYearsDialog.open();
+    }
+
     CategoryEditDialog {
         id: categoryEditDialog
         date: BudgetData.budgetDate
@@ -31,13 +35,18 @@ FocusScope {
         }
     }
 
+    ArchiveYearsDialog {
+        id: archiveYearsDialog
+    }
+
     CategoryDetailView {
         id: categoryDetailView
         category: CategoryController.current
         date: BudgetData.budgetDate
+        model: CategoryController.detailModel
 
         onOpened: {
-            operations = CategoryController.operationsForCategory(category, date);
+            model.load(category, date);
         }
 
         onNavigateToOperation: function (operation) {
@@ -82,8 +91,8 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 Label {
-                    property real _balance: CategoryController.totalIncome - CategoryController.totalExpense
-                    text: `${Theme.formatAmountWithoutCurrency(CategoryController.totalIncome)} - ${Theme.formatAmountWithoutCurrency(CategoryController.totalExpense)} = ${Theme.formatAmount(_balance)}`
+                    property real _balance: CategoryController.summary.totalIncome - CategoryController.summary.totalExpense
+                    text: `${Theme.formatAmountWithoutCurrency(CategoryController.summary.totalIncome)} - ${Theme.formatAmountWithoutCurrency(CategoryController.summary.totalExpense)} = ${Theme.formatAmount(_balance)}`
                     font.pixelSize: Theme.fontSizeSmall
                     font.bold: true
                     color: _balance == 0 ? Theme.textMuted : Theme.negative
@@ -99,7 +108,7 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 AmountLabel {
-                    amount: CategoryController.totalToSave
+                    amount: CategoryController.summary.totalToSave
                     font.pixelSize: Theme.fontSizeSmall
                 }
             }
@@ -113,7 +122,7 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 AmountLabel {
-                    amount: CategoryController.totalToReport
+                    amount: CategoryController.summary.totalToReport
                     color: Theme.accent
                     font.pixelSize: Theme.fontSizeSmall
                 }
@@ -121,7 +130,7 @@ FocusScope {
 
             RowLayout {
                 spacing: Theme.spacingSmall
-                visible: CategoryController.totalFromReport > 0
+                visible: CategoryController.summary.totalFromReport > 0
 
                 Label {
                     text: qsTr("From Leftover:")
@@ -129,7 +138,7 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 AmountLabel {
-                    amount: CategoryController.totalFromReport
+                    amount: CategoryController.summary.totalFromReport
                     font.pixelSize: Theme.fontSizeSmall
                     color: Theme.warning
                 }
@@ -144,7 +153,7 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 AmountLabel {
-                    amount: CategoryController.netReport
+                    amount: CategoryController.summary.netReport
                     font.pixelSize: Theme.fontSizeSmall
                 }
             }
@@ -158,7 +167,7 @@ FocusScope {
                     color: Theme.textSecondary
                 }
                 Label {
-                    text: `${CategoryController.balancedCount} / ${CategoryController.count}`
+                    text: `${CategoryController.summary.balancedCount} / ${CategoryController.count}`
                     font.pixelSize: Theme.fontSizeSmall
                     font.bold: true
                 }
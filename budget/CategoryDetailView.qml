@@ -11,8 +11,7 @@ BaseDialog {
 
     required property var category
     required property date date
-    property var operations: []
-    property real totalAmount: operations.reduce((sum, op) => sum + op.amount, 0)
+    required property var model
 
     signal navigateToOperation(var operation)
 
@@ -41,16 +40,16 @@ BaseDialog {
             }
 
             Label {
-                text: qsTr("Total: %1").arg(Theme.formatAmount(Math.abs(root.totalAmount)))
+                text: qsTr("Total: %1").arg(Theme.formatAmount(Math.abs(root.model.totalAmount)))
                 font.pixelSize: Theme.fontSizeNormal
                 font.bold: true
-                color: root.totalAmount >= 0 ? Theme.positive : Theme.negative
+                color: root.model.totalAmount >= 0 ? Theme.positive : Theme.negative
             }
         }
 
         // Operations count
         Label {
-            text: qsTr("%n operation(s)", "", root.operations.length)
+            text: qsTr("%n operation(s)", "", root.model.count)
             font.pixelSize: Theme.fontSizeSmall
             color: Theme.textMuted
         }
@@ -59,13 +58,17 @@ BaseDialog {
         ListView {
             Layout.fillWidth: true
             Layout.fillHeight: true
-            model: root.operations
+            model: root.model
             clip: true
             spacing: Theme.spacingSmall
 
             delegate: Rectangle {
                 id: operationDelegate
                 required property var operation
+                required property date date
+                required property string label
+                required property string accountName
+                required property real amount
                 required property int index
 
                 width: ListView.view.width
@@ -93,14 +96,14 @@ BaseDialog {
 
                     // Date
                     Label {
-                        text: operationDelegate.operation.date.toLocaleDateString(Qt.locale(), "dd/MM")
+                        text: operationDelegate.date.toLocaleDateString(Qt.locale(), "dd/MM")
                         font.pixelSize: Theme.fontSizeSmall
                         color: Theme.textMuted
                         Layout.preferredWidth: 50
                     }
 
                     Label {
-                        text: operationDelegate.operation.label
+                        text: operationDelegate.label
                         font.pixelSize: Theme.fontSizeNormal
                         color: Theme.textPrimary
                         elide: Text.ElideRight
@@ -109,7 +112,7 @@ BaseDialog {
 
                     // Account name
                     Label {
-                        text: operationDelegate.operation.account.name
+                        text: operationDelegate.accountName
                         font.pixelSize: Theme.fontSizeSmall
                         color: Theme.textMuted
                         Layout.preferredWidth: 80
@@ -118,7 +121,7 @@ BaseDialog {
 
                     // Amount
                     AmountLabel {
-                        amount: operationDelegate.operation.amountForCategory(root.category)
+                        amount: operationDelegate.amount
                         horizontalAlignment: Text.AlignRight
                         Layout.preferredWidth: 100
                     }
@@ -130,7 +133,7 @@ BaseDialog {
         Label {
             Layout.fillWidth: true
             Layout.fillHeight: true
-            visible: root.operations.length === 0
+            visible: root.model.count === 0
             text: qsTr("No operations for this category")
             horizontalAlignment: Text.AlignHCenter
             verticalAlignment: Text.AlignVCenter
@@ -55,6 +55,15 @@ int main(int argc, char* argv[]) {
 
   QUndoStack undoStack;
   AppSettings settings;
+  // Bounds the memory held by old commands, if the user asked for it
+  auto applyUndoLimit = [&undoStack, &settings] {
+    if (undoStack.count() == 0 && undoStack.undoLimit() != settings.undoLimit()) {
+      undoStack.setUndoLimit(settings.undoLimit());
+    }
+  };
+  applyUndoLimit();
+  QObject::connect(&settings, &AppSettings::undoLimitChanged, &undoStack, applyUndoLimit);
+  QObject::connect(&undoStack, &QUndoStack::indexChanged, &undoStack, applyUndoLimit);  // Cleared on open
   UpdateController updateController(settings);
   BudgetData budgetData(undoStack);
   CategoryController categories(budgetData, undoStack);
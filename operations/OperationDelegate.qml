@@ -7,8 +7,14 @@ import commonui
 Rectangle {
     id: root
 
-    required property var operation
+    // Display texts come pre-formatted from the account model roles
+    required property string dateText
+    required property string label
+    required property string categoryDisplay
+    required property double amount
+    required property string amountText
     required property double balance
+    required property string balanceText
     required property bool selected
     required property bool focused
     required property bool alternate
@@ -33,7 +39,7 @@ Rectangle {
         spacing: Theme.spacingNormal
 
         Label {
-            text: root.operation?.date ? root.operation.date.toLocaleDateString(Qt.locale(), Locale.ShortFormat) : ""
+            text: root.dateText
             verticalAlignment: Text.AlignVCenter
             font.pixelSize: Theme.fontSizeNormal
             color: Theme.textPrimary
@@ -42,7 +48,7 @@ Rectangle {
 
         Label {
             Layout.fillWidth: true
-            text: root.operation?.label ?? ""
+            text: root.label
             verticalAlignment: Text.AlignVCenter
             elide: Text.ElideRight
             font.pixelSize: Theme.fontSizeNormal
@@ -50,7 +56,7 @@ Rectangle {
         }
 
         Label {
-            text: root.operation?.categoryDisplay || ""
+            text: root.categoryDisplay
             verticalAlignment: Text.AlignVCenter
             horizontalAlignment: Text.AlignLeft
             elide: Text.ElideRight
@@ -60,7 +66,8 @@ Rectangle {
         }
 
         AmountLabel {
-            amount: root.operation?.amount ?? 0
+            amount: root.amount
+            text: root.amountText
             verticalAlignment: Text.AlignVCenter
             horizontalAlignment: Text.AlignRight
             font.pixelSize: Theme.fontSizeNormal
@@ -69,6 +76,7 @@ Rectangle {
 
         AmountLabel {
             amount: root.balance
+            text: root.balanceText
             verticalAlignment: Text.AlignVCenter
             horizontalAlignment: Text.AlignRight
             font.pixelSize: Theme.fontSizeNormal
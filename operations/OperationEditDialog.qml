@@ -41,6 +41,9 @@ BaseDialog {
     }
     readonly property double remainingAmount: editedAmount - allocatedAmount
 
+    // Categories of past operations with similar labels, while the operation is uncategorized
+    readonly property var suggestedCategories: allocationModel.count === 1 && allocationModel.get(0).category === "" ? RuleController.suggester.suggestedCategoryNames(labelField.text) : []
+
     okEnabled: labelField.text.trim() !== "" && (amountField.value != 0 || allocationModel.count > 0)
 
     onOpened: {
@@ -381,6 +384,30 @@ BaseDialog {
             }
         }
 
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.spacingSmall
+            visible: root.suggestedCategories.length > 0
+
+            Label {
+                text: qsTr("Suggested:")
+                font.pixelSize: Theme.fontSizeSmall
+                color: Theme.textSecondary
+            }
+
+            Repeater {
+                model: root.suggestedCategories
+
+                Button {
+                    required property string modelData
+                    text: modelData
+                    flat: true
+                    focusPolicy: Qt.NoFocus
+                    onClicked: allocationModel.setProperty(0, "category", modelData)
+                }
+            }
+        }
+
         // Allocations list
         ListView {
             id: allocationListView
@@ -37,8 +37,13 @@ ListView {
         required property int index
         required property var model
         width: root.width - scrollBar.width
-        operation: model.operation
+        dateText: model.dateText
+        label: model.label
+        categoryDisplay: model.categoryDisplay
+        amount: model.amount
+        amountText: model.amountText
         balance: model.balance
+        balanceText: model.balanceText
         selected: model.selected
         focused: root.currentIndex === index
         alternate: index % 2 === 0
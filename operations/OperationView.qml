@@ -23,10 +23,19 @@ FocusScope {
         operationEditDialog.initialize(BudgetData.currentAccount.currentOperation, advanced);
     }
 
+    function matchTransfers() {
+        transferMatchDialog.open();
+    }
+
     RenameAccountDialog {
         id: renameDialog
     }
 
+    TransferMatchDialog {
+        id: transferMatchDialog
+        onClosed: operationList.forceActiveFocus()
+    }
+
     OperationEditDialog {
         id: operationEditDialog
         onClosed: operationList.forceActiveFocus()
@@ -0,0 +1,95 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+import commonui
+import Comptine
+
+BaseDialog {
+    id: root
+    title: qsTr("Match Transfers")
+    acceptButtonText: qsTr("Apply")
+
+    readonly property var matches: BudgetData.transferMatches
+    okEnabled: matches.acceptedCount > 0
+
+    onOpened: matches.refresh()
+    onAccepted: matches.apply()
+    onClosed: matches.clear()
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: Theme.spacingNormal
+
+        RowLayout {
+            spacing: Theme.spacingNormal
+
+            Label {
+                text: qsTr("Maximum gap in days:")
+            }
+
+            SpinBox {
+                from: 0
+                to: 31
+                value: root.matches.maxDays
+                onValueModified: {
+                    root.matches.maxDays = value;
+                    root.matches.refresh();
+                }
+            }
+        }
+
+        Label {
+            text: root.matches.count > 0 ? qsTr("The uncategorized side of each transfer receives the categories of the other side.") : qsTr("No transfer to match.")
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        ListView {
+            id: matchList
+            Layout.fillWidth: true
+            Layout.preferredWidth: 600
+            Layout.preferredHeight: 300
+            clip: true
+            model: root.matches
+
+            delegate: RowLayout {
+                id: matchDelegate
+                required property int index
+                required property string sourceAccountName
+                required property string targetAccountName
+                required property date sourceDate
+                required property string sourceLabel
+                required property real amount
+                required property int dayGap
+                required property bool accepted
+
+                width: matchList.width
+                spacing: Theme.spacingNormal
+
+                CheckBox {
+                    checked: matchDelegate.accepted
+                    onToggled: root.matches.setAccepted(matchDelegate.index, checked)
+                }
+                Label {
+                    text: matchDelegate.sourceDate.toLocaleDateString(Qt.locale(), Locale.ShortFormat)
+                }
+                Label {
+                    text: matchDelegate.sourceLabel
+                    elide: Text.ElideRight
+                    Layout.fillWidth: true
+                }
+                Label {
+                    text: matchDelegate.sourceAccountName + " → " + matchDelegate.targetAccountName
+                }
+                Label {
+                    text: qsTr("%n day(s)", "", matchDelegate.dayGap)
+                    visible: matchDelegate.dayGap > 0
+                }
+                AmountLabel {
+                    amount: matchDelegate.amount
+                }
+            }
+        }
+    }
+}
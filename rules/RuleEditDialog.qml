@@ -15,6 +15,7 @@ BaseDialog {
     property string originalCategory: ""
     property string originalLabelMatch: ""
     property double originalAmountFilter: 0
+    property int originalMatchMode: Rule.Contains
 
     // For use when creating rule from OperationEditDialog
     property string suggestedMatch: ""
@@ -24,7 +25,12 @@ BaseDialog {
     // Category list - refreshed on open
     property var categoryList: []
 
-    okEnabled: categoryCombo.currentText.length > 0 && descriptionMatchField.text.length > 0 && (!amountCheckBox.checked || amountFilterField.value !== 0)
+    // Regular expression errors, empty for a valid match
+    readonly property string matchError: Rule.matchError(descriptionMatchField.text.trim(), matchModeCombo.currentIndex)
+
+    readonly property var preview: RuleController.preview
+
+    okEnabled: categoryCombo.currentText.length > 0 && descriptionMatchField.text.length > 0 && matchError.length === 0 && (!amountCheckBox.checked || amountFilterField.value !== 0)
 
     onOpened: {
         // Refresh category list when dialog opens
@@ -32,6 +38,7 @@ BaseDialog {
 
         if (isNewRule) {
             categoryCombo.currentIndex = -1;
+            matchModeCombo.currentIndex = Rule.Contains;
             descriptionMatchField.text = suggestedMatch;
             if (suggestedCategory.length > 0) {
                 let catIndex = categoryModel.findCategoryIndex(suggestedCategory);
@@ -46,6 +53,7 @@ BaseDialog {
             let catIndex = categoryModel.findCategoryIndex(originalCategory);
             categoryCombo.currentIndex = catIndex;
             descriptionMatchField.text = originalLabelMatch;
+            matchModeCombo.currentIndex = originalMatchMode;
             // Restore amount filter state
             if (originalAmountFilter !== 0) {
                 amountCheckBox.checked = true;
@@ -56,23 +64,41 @@ BaseDialog {
             }
         }
         descriptionMatchField.forceActiveFocus();
+        updatePreview();
+    }
+
+    onClosed: preview.cancel()
+
+    // Operations whose category would change, recomputed in the background as the rule is typed
+    function updatePreview() {
+        if (!visible)
+            return;
+        let category = CategoryController.getCategoryByName(categoryCombo.currentText);
+        let match = descriptionMatchField.text.trim();
+        let amount = amountCheckBox.checked ? amountFilterField.value : 0;
+        if (isNewRule) {
+            preview.previewAdd(category, match, amount, matchModeCombo.currentIndex);
+        } else {
+            preview.previewEdit(ruleIndex, category, match, amount, matchModeCombo.currentIndex);
+        }
     }
 
     onAccepted: {
         let category = CategoryController.getCategoryByName(categoryCombo.currentText);
         let match = descriptionMatchField.text.trim();
         let amount = amountCheckBox.checked ? amountFilterField.value : 0;
+        let mode = matchModeCombo.currentIndex;
 
         if (isNewRule) {
-            RuleController.addRule(category, match, amount);
+            RuleController.addRule(category, match, amount, mode);
             if (applyToExistingCheckBox.checked) {
-                let count = RuleController.applyRuleToUncategorized(category, match, amount);
+                let count = RuleController.applyRuleToUncategorized(category, match, amount, mode);
                 if (count > 0) {
                     console.log("Applied rule to", count, "uncategorized operation(s)");
                 }
             }
         } else {
-            RuleController.editRule(ruleIndex, category, match, amount);
+            RuleController.editRule(ruleIndex, category, match, amount, mode);
         }
     }
 
@@ -100,13 +126,36 @@ BaseDialog {
             color: Theme.textPrimary
         }
 
-        TextField {
-            id: descriptionMatchField
+        RowLayout {
             Layout.fillWidth: true
-            placeholderText: qsTr("Operations starting with this text will match")
-            font.pixelSize: Theme.fontSizeNormal
-            onActiveFocusChanged: if (activeFocus)
-                selectAll()
+            spacing: Theme.spacingNormal
+
+            // Same order as Rule.MatchMode
+            ComboBox {
+                id: matchModeCombo
+                model: [qsTr("Contains"), qsTr("Starts with"), qsTr("Is exactly"), qsTr("Contains word"), qsTr("Regular expression")]
+                font.pixelSize: Theme.fontSizeNormal
+                onCurrentIndexChanged: root.updatePreview()
+            }
+
+            TextField {
+                id: descriptionMatchField
+                Layout.fillWidth: true
+                placeholderText: qsTr("Operations with this text in their label will match")
+                font.pixelSize: Theme.fontSizeNormal
+                onActiveFocusChanged: if (activeFocus)
+                    selectAll()
+                onTextChanged: root.updatePreview()
+            }
+        }
+
+        Label {
+            Layout.fillWidth: true
+            visible: root.matchError.length > 0
+            text: root.matchError
+            font.pixelSize: Theme.fontSizeSmall
+            color: Theme.negative
+            wrapMode: Text.WordWrap
         }
 
         Label {
@@ -120,6 +169,7 @@ BaseDialog {
             Layout.fillWidth: true
             model: root.categoryList
             font.pixelSize: Theme.fontSizeNormal
+            onCurrentIndexChanged: root.updatePreview()
         }
 
         // Optional amount filter
@@ -127,6 +177,7 @@ BaseDialog {
             id: amountCheckBox
             text: qsTr("Match specific amount")
             font.pixelSize: Theme.fontSizeNormal
+            onToggled: root.updatePreview()
         }
 
         AmountField {
@@ -134,6 +185,55 @@ BaseDialog {
             enabled: amountCheckBox.checked
             Layout.fillWidth: true
             value: 0
+            onValueChanged: root.updatePreview()
+        }
+
+        // Impact of the rule on the existing operations
+        Label {
+            Layout.fillWidth: true
+            text: root.preview.running ? qsTr("Checking operations...") : qsTr("%n operation(s) would change category, %1 of them uncategorized.", "", root.preview.count).arg(root.preview.uncategorizedCount)
+            font.pixelSize: Theme.fontSizeSmall
+            color: Theme.textSecondary
+            wrapMode: Text.WordWrap
+        }
+
+        ListView {
+            id: previewList
+            Layout.fillWidth: true
+            Layout.preferredHeight: 120
+            visible: root.preview.count > 0
+            clip: true
+            model: root.preview
+
+            delegate: RowLayout {
+                id: previewDelegate
+                required property date date
+                required property string label
+                required property string currentCategory
+                required property string proposedCategory
+                required property bool uncategorized
+
+                width: previewList.width
+                spacing: Theme.spacingNormal
+
+                Label {
+                    text: previewDelegate.date.toLocaleDateString(Qt.locale(), Locale.ShortFormat)
+                    font.pixelSize: Theme.fontSizeSmall
+                    color: Theme.textSecondary
+                }
+                Label {
+                    text: previewDelegate.label
+                    font.pixelSize: Theme.fontSizeSmall
+                    font.bold: previewDelegate.uncategorized
+                    elide: Text.ElideRight
+                    Layout.fillWidth: true
+                }
+                Label {
+                    text: qsTr("%1 \u2192 %2").arg(previewDelegate.currentCategory || qsTr("None")).arg(previewDelegate.proposedCategory || qsTr("None"))
+                    font.pixelSize: Theme.fontSizeSmall
+                    color: Theme.textSecondary
+                }
+            }
         }
 
         // Show a hint about how rules work
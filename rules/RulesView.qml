@@ -71,6 +71,11 @@ BaseDialog {
                     required property string category
                     required property string labelMatch
                     required property double amountFilter
+                    required property int matchMode
+                    required property int matchCount
+                    required property int evaluationCount
+                    required property date lastMatchDate
+                    required property int shadowedBy
 
                     width: ListView.view.width
                     height: contentRow.implicitHeight + Theme.spacingNormal * 2
@@ -90,6 +95,7 @@ BaseDialog {
                             ruleEditDialog.originalCategory = ruleDelegate.category;
                             ruleEditDialog.originalLabelMatch = ruleDelegate.labelMatch;
                             ruleEditDialog.originalAmountFilter = ruleDelegate.amountFilter;
+                            ruleEditDialog.originalMatchMode = ruleDelegate.matchMode;
                             ruleEditDialog.open();
                         }
                     }
@@ -115,7 +121,20 @@ BaseDialog {
                             spacing: 2
 
                             Label {
-                                text: qsTr("Prefix: \"%1\"").arg(ruleDelegate.labelMatch)
+                                text: {
+                                    switch (ruleDelegate.matchMode) {
+                                    case Rule.Prefix:
+                                        return qsTr("Starts with: \"%1\"").arg(ruleDelegate.labelMatch);
+                                    case Rule.Exact:
+                                        return qsTr("Is exactly: \"%1\"").arg(ruleDelegate.labelMatch);
+                                    case Rule.WholeWord:
+                                        return qsTr("Contains word: \"%1\"").arg(ruleDelegate.labelMatch);
+                                    case Rule.Regex:
+                                        return qsTr("Matches: /%1/").arg(ruleDelegate.labelMatch);
+                                    default:
+                                        return qsTr("Contains: \"%1\"").arg(ruleDelegate.labelMatch);
+                                    }
+                                }
                                 font.pixelSize: Theme.fontSizeNormal
                                 color: Theme.textPrimary
                                 elide: Text.ElideRight
@@ -127,6 +146,20 @@ BaseDialog {
                                 font.pixelSize: Theme.fontSizeSmall
                                 color: Theme.textSecondary
                             }
+
+                            Label {
+                                visible: ruleDelegate.evaluationCount > 0
+                                text: ruleDelegate.matchCount > 0 ? qsTr("Matched %1 of %2 tested operation(s), last on %3").arg(ruleDelegate.matchCount).arg(ruleDelegate.evaluationCount).arg(ruleDelegate.lastMatchDate.toLocaleDateString(Qt.locale(), Locale.ShortFormat)) : qsTr("Matched none of %1 tested operation(s)").arg(ruleDelegate.evaluationCount)
+                                font.pixelSize: Theme.fontSizeSmall
+                                color: Theme.textMuted
+                            }
+
+                            Label {
+                                visible: ruleDelegate.shadowedBy >= 0
+                                text: qsTr("Never used: rule %1 matches everything this rule does").arg(ruleDelegate.shadowedBy + 1)
+                                font.pixelSize: Theme.fontSizeSmall
+                                color: Theme.negative
+                            }
                         }
 
                         // Move up button
@@ -165,6 +198,7 @@ BaseDialog {
                                 ruleEditDialog.originalCategory = ruleDelegate.category;
                                 ruleEditDialog.originalLabelMatch = ruleDelegate.labelMatch;
                                 ruleEditDialog.originalAmountFilter = ruleDelegate.amountFilter;
+                                ruleEditDialog.originalMatchMode = ruleDelegate.matchMode;
                                 ruleEditDialog.open();
                             }
                             ToolTip.visible: hovered
@@ -206,6 +240,22 @@ BaseDialog {
                 font.pixelSize: Theme.fontSizeSmall
                 color: Theme.textSecondary
             }
+
+            Label {
+                Layout.fillWidth: true
+                visible: RuleController.matchingTime > 0
+                text: qsTr("Matching took %1 ms").arg(RuleController.matchingTime.toFixed(1))
+                font.pixelSize: Theme.fontSizeSmall
+                color: Theme.textSecondary
+            }
+
+            Button {
+                text: qsTr("Sort by Use")
+                enabled: RuleController.ruleCount > 1
+                onClicked: RuleController.reorderByFrequency()
+                ToolTip.visible: hovered
+                ToolTip.text: qsTr("Move the most used rules first, without changing the category of any operation")
+            }
         }
     }
 }
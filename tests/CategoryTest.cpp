@@ -3,6 +3,8 @@
 #include <QSignalSpy>
 #include <QTest>
 
+#include "../BatchScope.h"
+#include "../Account.h"
 #include "../BudgetData.h"
 #include "../Category.h"
 #include "../CategoryController.h"
@@ -95,7 +97,7 @@ private slots:
     MonthRecord record;
     record.saveAmount = 100.0;
     record.reportAmount = 50.0;
-    QCOMPARE(record.leftoverTotal(), 150.0);
+    QCOMPARE(record.leftoverTotal(), Money(150.0));
   }
 
   // Category constructor tests
@@ -124,10 +126,10 @@ private slots:
     cat.setMonthRecord(2025, 6, record);
 
     MonthRecord retrieved = cat.monthRecord(2025, 6);
-    QCOMPARE(retrieved.saveAmount, 50.0);
-    QCOMPARE(retrieved.reportAmount, 25.0);
+    QCOMPARE(retrieved.saveAmount, Money(50.0));
+    QCOMPARE(retrieved.reportAmount, Money(25.0));
     QVERIFY(retrieved.budgetLimit.has_value());
-    QCOMPARE(retrieved.budgetLimit.value(), 200.0);
+    QCOMPARE(retrieved.budgetLimit.value(), Money(200.0));
   }
 
   void testGetNonExistentMonthRecord() {
@@ -135,8 +137,8 @@ private slots:
 
     MonthRecord record = cat.monthRecord(2025, 1);
     QVERIFY(record.isEmpty());
-    QCOMPARE(record.saveAmount, 0.0);
-    QCOMPARE(record.reportAmount, 0.0);
+    QCOMPARE(record.saveAmount, Money(0.0));
+    QCOMPARE(record.reportAmount, Money(0.0));
     QVERIFY(!record.budgetLimit.has_value());
   }
 
@@ -194,10 +196,10 @@ private slots:
     cat.setLeftoverDecision(2025, 6, { 50.0, 25.0 });
 
     MonthRecord record = cat.monthRecord(2025, 6);
-    QCOMPARE(record.saveAmount, 50.0);
-    QCOMPARE(record.reportAmount, 25.0);
+    QCOMPARE(record.saveAmount, Money(50.0));
+    QCOMPARE(record.reportAmount, Money(25.0));
     QVERIFY(record.budgetLimit.has_value());
-    QCOMPARE(record.budgetLimit.value(), 200.0);
+    QCOMPARE(record.budgetLimit.value(), Money(200.0));
   }
 
   void testClearLeftoverDecisionPreservesBudgetLimit() {
@@ -214,10 +216,10 @@ private slots:
     cat.clearLeftoverDecision(2025, 6);
 
     MonthRecord result = cat.monthRecord(2025, 6);
-    QCOMPARE(result.saveAmount, 0.0);
-    QCOMPARE(result.reportAmount, 0.0);
+    QCOMPARE(result.saveAmount, Money(0.0));
+    QCOMPARE(result.reportAmount, Money(0.0));
     QVERIFY(result.budgetLimit.has_value());
-    QCOMPARE(result.budgetLimit.value(), 200.0);
+    QCOMPARE(result.budgetLimit.value(), Money(200.0));
   }
 
   void testClearLeftoverDecisionRemovesEntryWhenNoBudgetLimit() {
@@ -319,7 +321,7 @@ private slots:
     QCOMPARE(spy.count(), 1);
     MonthRecord record = cat.monthRecord(2025, 6);
     QVERIFY(record.budgetLimit.has_value());
-    QCOMPARE(record.budgetLimit.value(), 200.0);
+    QCOMPARE(record.budgetLimit.value(), Money(200.0));
   }
 
   void testClearBudgetLimitForMonth() {
@@ -347,7 +349,7 @@ private slots:
 
     // Leftover data should remain
     MonthRecord result = cat.monthRecord(2025, 6);
-    QCOMPARE(result.saveAmount, 50.0);
+    QCOMPARE(result.saveAmount, Money(50.0));
     QVERIFY(!result.budgetLimit.has_value());
   }
 
@@ -361,16 +363,16 @@ private slots:
     cat.setLeftoverDecision(2025, 3, { 0.0, 10.0 });   // report 10
 
     // Before January: nothing
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2024, 12, 31)), 0.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2024, 12, 31)), Money(0.0));
 
     // Before February: only January's report
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 1, 31)), 30.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 1, 31)), Money(30.0));
 
     // Before March: January + February reports
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 28)), 50.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 28)), Money(50.0));
 
     // Before April: all three
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 3, 31)), 60.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 3, 31)), Money(60.0));
   }
 
   void testAccumulatedLeftoverBeforeIgnoresSaveAmounts() {
@@ -379,7 +381,7 @@ private slots:
     // Only save, no report
     cat.setLeftoverDecision(2025, 1, { 100.0, 0.0 });
 
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 1)), 0.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 1)), Money(0.0));
   }
 
   void testAccumulatedLeftoverBeforeCrossYear() {
@@ -390,10 +392,10 @@ private slots:
     cat.setLeftoverDecision(2025, 1, { 0.0, 15.0 });
 
     // Before Feb 2025: all three
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 1)), 80.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2025, 2, 1)), Money(80.0));
 
     // Before December 2024: only 2024 entries
-    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2024, 12, 1)), 65.0);
+    QCOMPARE(cat.accumulatedLeftoverBefore(QDate(2024, 12, 1)), Money(65.0));
   }
 
   // allMonthHistory
@@ -476,7 +478,7 @@ private slots:
     QCOMPARE(cat->budgetLimit(), -250.0);
     MonthRecord record = cat->monthRecord(2025, 5);
     QVERIFY(record.budgetLimit.has_value());
-    QCOMPARE(record.budgetLimit.value(), -200.0);
+    QCOMPARE(record.budgetLimit.value(), Money(-200.0));
   }
 
   void testEditCategoryNameOnlyNoHistoryChange() {
@@ -498,6 +500,54 @@ private slots:
     QCOMPARE(cat->name(), QString("Food"));
   }
 
+  void testEditCategoryCommandMergesConsecutiveEdits() {
+    Category* cat = new Category("Food", -250.0);
+    categoryController->addCategory(cat);
+
+    QDate budgetDate(2025, 6, 1);
+    undoStack->push(new EditCategoryCommand(*cat, "Food", -300.0, budgetDate));
+    undoStack->push(new EditCategoryCommand(*cat, "Food", -350.0, budgetDate));
+
+    QCOMPARE(undoStack->count(), 1);
+    QCOMPARE(cat->budgetLimit(), -350.0);
+    // May keeps the limit from before the first edit
+    QCOMPARE(cat->budgetLimitForMonth(QDate(2025, 5, 1)), -250.0);
+
+    undoStack->undo();
+    QCOMPARE(cat->budgetLimit(), -250.0);
+    QVERIFY(cat->allMonthHistory().isEmpty());
+
+    undoStack->redo();
+    QCOMPARE(cat->budgetLimit(), -350.0);
+    QCOMPARE(cat->budgetLimitForMonth(QDate(2025, 5, 1)), -250.0);
+  }
+
+  void testSetOperationAmountCommandMerges() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread"));
+    auto cheese = account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Cheese"));
+
+    budgetData->setOperationAmount(bread, 3.);
+    budgetData->setOperationAmount(bread, 4.);
+    QCOMPARE(undoStack->count(), 1);
+    QCOMPARE(bread->amountMoney(), Money(4.0));
+
+    // A different operation starts a new step
+    budgetData->setOperationAmount(cheese, 5.);
+    QCOMPARE(undoStack->count(), 2);
+
+    undoStack->undo();
+    undoStack->undo();
+    QCOMPARE(bread->amountMoney(), Money(1.0));
+    QCOMPARE(cheese->amountMoney(), Money(2.0));
+
+    // Editing back to the original value leaves no step behind
+    undoStack->clear();
+    budgetData->setOperationAmount(bread, 7.);
+    budgetData->setOperationAmount(bread, 1.);
+    QCOMPARE(undoStack->count(), 0);
+  }
+
   void testCountOperationsWithCategory() {
     auto food = categoryController->addCategory(new Category("Food", -250));
     auto transport = categoryController->addCategory(new Category("Transport", -50));
@@ -506,6 +556,471 @@ private slots:
     QCOMPARE(budgetData->countOperationsWithCategory(food), 1);
     QCOMPARE(budgetData->countOperationsWithCategory(transport), 0);
   }
+
+  void testCountOperationsWithCategoryFollowsSplit() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto transport = categoryController->addCategory(new Category("Transport", -50));
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread", "", { new Allocation(food, 1) }));
+
+    undoStack->push(new SplitOperationCommand(*bread, { new Allocation(transport, 1) }));
+    QCOMPARE(budgetData->countOperationsWithCategory(food), 0);
+    QCOMPARE(budgetData->countOperationsWithCategory(transport), 1);
+    QCOMPARE(account->operationsWithCategory(transport), QList<Operation*>({ bread }));
+
+    undoStack->undo();
+    QCOMPARE(budgetData->countOperationsWithCategory(food), 1);
+    QCOMPARE(budgetData->countOperationsWithCategory(transport), 0);
+
+    account->removeOperation(bread);
+    QCOMPARE(budgetData->countOperationsWithCategory(food), 0);
+    QVERIFY(account->operationsWithCategory(food).isEmpty());
+    delete bread;
+  }
+
+  void testDeleteCategoryClearsAllocations() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread", "", { new Allocation(food, 1) }));
+    account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Bus"));
+
+    categoryController->deleteCategory(food);
+    QVERIFY(bread->allocations().isEmpty());
+  }
+
+  void testCategoryDetailModel() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto transport = categoryController->addCategory(new Category("Transport", -50));
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), -3., "Bread", "", { new Allocation(food, -3) }));
+    auto market = account->addOperation(new Operation(account, QDate(2026, 8, 20), -10., "Market", "", { new Allocation(food, -6), new Allocation(transport, -4) }));
+    account->addOperation(new Operation(account, QDate(2026, 9, 1), -5., "Cheese", "", { new Allocation(food, -5) }));
+
+    CategoryDetailModel* model = categoryController->detailModel();
+    model->load(food, QDate(2026, 8, 1));
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->operationAt(0), market);
+    QCOMPARE(model->operationAt(1), bread);
+    QCOMPARE(model->totalAmountMoney(), Money(-9.0));
+    QCOMPARE(model->data(model->index(0, 0), CategoryDetailModel::AmountRole).toDouble(), -6.0);
+    QCOMPARE(model->data(model->index(0, 0), CategoryDetailModel::AccountNameRole).toString(), QString("Account"));
+  }
+
+  void testBudgetCubeFollowsOperations() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto transport = categoryController->addCategory(new Category("Transport", -50));
+    auto account = budgetData->addAccount(new Account("Account"));
+    BudgetCube* cube = categoryController->cube();
+    const QDate august(2026, 8, 1);
+
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), -3., "Bread", "", { new Allocation(food, -3) }));
+    QCOMPARE(cube->spentMoney(food, august), Money(-3.0));
+
+    undoStack->push(new SplitOperationCommand(*bread, { new Allocation(food, -1), new Allocation(transport, -2) }));
+    QCOMPARE(cube->spentMoney(food, august), Money(-1.0));
+    QCOMPARE(cube->spentMoney(transport, august), Money(-2.0));
+
+    bread->set_budgetDate(QDate(2026, 9, 1));
+    QCOMPARE(cube->spentMoney(food, august), Money());
+    QCOMPARE(cube->spentMoney(food, QDate(2026, 9, 1)), Money(-1.0));
+    QCOMPARE(categoryController->spentMoneyInCategory(transport, QDate(2026, 9, 1)), Money(-2.0));
+
+    account->removeOperation(bread);
+    QCOMPARE(cube->spentMoney(food, QDate(2026, 9, 1)), Money());
+    delete bread;
+
+    account->addOperation(new Operation(account, QDate(2026, 8, 2), -4., "Cheese", "", { new Allocation(food, -4) }));
+    budgetData->clearAccounts();
+    QCOMPARE(cube->spentMoney(food, august), Money());
+  }
+
+  void testBudgetCubeTrends() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto account = budgetData->addAccount(new Account("Account"));
+    BudgetCube* cube = categoryController->cube();
+    for (int month = 1; month <= 12; ++month) {
+      account->addOperation(new Operation(account, QDate(2025, month, 10), -10. * month, "Market", "", { new Allocation(food, -10. * month) }));
+    }
+    account->addOperation(new Operation(account, QDate(2026, 1, 10), -130., "Market", "", { new Allocation(food, -130.) }));
+
+    QCOMPARE(cube->yearToDateMoney(food, QDate(2025, 3, 1)), Money(-60.0));
+    QCOMPARE(cube->yearToDateMoney(food, QDate(2026, 3, 1)), Money(-130.0));
+    // February 2025 to January 2026: 20 + 30 + ... + 120 + 130
+    QCOMPARE(cube->rollingAverageMoney(food, QDate(2026, 1, 1)), Money(-75.0));
+    QCOMPARE(cube->trend(food, QDate(2025, 11, 1), QDate(2026, 2, 1)), QList<double>({ -110., -120., -130., 0. }));
+
+    cube->set_firstMonth(QDate(2025, 1, 1));
+    cube->set_lastMonth(QDate(2025, 12, 1));
+    QCOMPARE(cube->rowCount(), 1);
+    QCOMPARE(cube->columnCount(), 12);
+    QCOMPARE(cube->data(cube->index(0, 2), BudgetCube::SpentRole).toDouble(), -30.0);
+
+    // Only the cells and rows that changed are notified
+    QSignalSpy dataSpy(cube, &BudgetCube::dataChanged);
+    account->addOperation(new Operation(account, QDate(2025, 4, 12), -5., "Bakery", "", { new Allocation(food, -5.) }));
+    QCOMPARE(dataSpy.count(), 1);
+    QCOMPARE(dataSpy.first().at(0).toModelIndex(), cube->index(0, 3));
+    QCOMPARE(dataSpy.first().at(1).toModelIndex(), cube->index(0, 3));
+    account->addOperation(new Operation(account, QDate(2024, 4, 12), -5., "Bakery", "", { new Allocation(food, -5.) }));
+    QCOMPARE(dataSpy.count(), 1);
+    dataSpy.clear();
+    food->setBudgetLimitForMonth(2025, 6, -100);
+    QCOMPARE(dataSpy.count(), 1);
+    QCOMPARE(dataSpy.first().at(0).toModelIndex(), cube->index(0, 0));
+    QCOMPARE(dataSpy.first().at(1).toModelIndex(), cube->index(0, 11));
+
+    // Rows are inserted and removed as the categories are, the count changing in between
+    QSignalSpy resetSpy(cube, &BudgetCube::modelReset);
+    QSignalSpy insertSpy(cube, &BudgetCube::rowsInserted);
+    QSignalSpy removeSpy(cube, &BudgetCube::rowsRemoved);
+    QList<int> countsBefore;
+    connect(cube, &BudgetCube::rowsAboutToBeInserted, this, [&] { countsBefore << cube->rowCount(); });
+    connect(cube, &BudgetCube::rowsAboutToBeRemoved, this, [&] { countsBefore << cube->rowCount(); });
+    auto cars = categoryController->addCategory(new Category("Cars", -80));
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy.first().at(1).toInt(), 0);
+    QCOMPARE(cube->rowCount(), 2);
+    QCOMPARE(cube->data(cube->index(1, 2), BudgetCube::SpentRole).toDouble(), -30.0);
+    delete categoryController->takeCategoryByName(cars->name());
+    QCOMPARE(removeSpy.count(), 1);
+    QCOMPARE(removeSpy.first().at(1).toInt(), 0);
+    QCOMPARE(cube->rowCount(), 1);
+    QCOMPARE(countsBefore, QList<int>({ 1, 2 }));
+    QCOMPARE(resetSpy.count(), 0);
+  }
+
+  void testCategoryFiguresFollowChanges() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto account = budgetData->addAccount(new Account("Account"));
+    const QDate august(2026, 8, 1);
+
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), -30., "Bread", "", { new Allocation(food, -30) }));
+    QCOMPARE(categoryController->figures(food, august).spent, Money(-30.0));
+    QCOMPARE(categoryController->figures(food, august).leftover, Money(220.0));
+
+    // Cached figures are dropped when the month's spent amount changes
+    undoStack->push(new SplitOperationCommand(*bread, { new Allocation(food, -10) }));
+    QCOMPARE(categoryController->figures(food, august).spent, Money(-10.0));
+    QCOMPARE(categoryController->figures(food, august).leftover, Money(240.0));
+
+    // ... and when the category history or limit changes
+    food->setBudgetLimitForMonth(2026, 8, -100);
+    QCOMPARE(categoryController->figures(food, august).budgetLimit, Money(-100.0));
+    food->set_budgetLimit(-300.0);
+    QCOMPARE(categoryController->figures(food, QDate(2026, 9, 1)).budgetLimit, Money(-300.0));
+  }
+
+  void testMonthSummary() {
+    auto salary = categoryController->addCategory(new Category("Salary", 2000));
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto account = budgetData->addAccount(new Account("Account"));
+    budgetData->set_budgetDate(QDate(2026, 8, 1));
+
+    account->addOperation(new Operation(account, QDate(2026, 8, 1), 2000., "Pay", "", { new Allocation(salary, 2000) }));
+    MonthSummary summary = categoryController->summary();
+    QCOMPARE(summary.income, Money(2000.0));
+    QCOMPARE(summary.expense, Money(250.0));
+    QCOMPARE(summary.balancedCount(), 1);
+    QCOMPARE(categoryController->totalIncome(), 2000.0);
+
+    // The cached summary follows spent amounts and limits
+    account->addOperation(new Operation(account, QDate(2026, 8, 15), -250., "Food", "", { new Allocation(food, -250) }));
+    QCOMPARE(categoryController->summary().balancedCount(), 2);
+    food->set_budgetLimit(-300.0);
+    QCOMPARE(categoryController->summary().expense, Money(300.0));
+    QCOMPARE(categoryController->summary().balancedCount(), 1);
+  }
+
+  void testBatchCoalescesNotifications() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    QSignalSpy balanceSpy(account, &Account::balanceChanged);
+    QSignalSpy countSpy(account, &Account::countChanged);
+    QSignalSpy refreshSpy(categoryController, &CategoryController::dataChanged);
+
+    {
+      BatchScope batch(*budgetData);
+      account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread"));
+      account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Cheese"));
+      categoryController->refresh();
+      categoryController->refresh();
+      QCOMPARE(balanceSpy.count(), 0);
+      QCOMPARE(countSpy.count(), 0);
+      QCOMPARE(refreshSpy.count(), 0);
+    }
+
+    QCOMPARE(balanceSpy.count(), 1);
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(refreshSpy.count(), 1);
+    QCOMPARE(account->currentBalance(), 3.0);
+  }
+
+  void testBatchCommandRecomputesOnce() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread"));
+    auto cheese = account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Cheese"));
+    account->addOperation(new Operation(account, QDate(2026, 8, 17), 4., "Wine"));
+    QSignalSpy balanceSpy(account, &Account::balanceChanged);
+
+    auto macro = new BatchCommand(*budgetData);
+    new DeleteOperationCommand(bread, *account, macro);
+    new DeleteOperationCommand(cheese, *account, macro);
+    undoStack->push(macro);
+    QCOMPARE(balanceSpy.count(), 1);
+    QCOMPARE(account->rowCount(), 1);
+    QCOMPARE(account->currentBalance(), 4.0);
+
+    undoStack->undo();
+    QCOMPARE(balanceSpy.count(), 2);
+    QCOMPARE(account->currentBalance(), 7.0);
+  }
+
+  void testAccountDisplayRoles() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto food = categoryController->editCategory("Food", 100.);
+    auto op = account->addOperation(new Operation(account, QDate(2026, 8, 15), -12.5, "Bread"));
+    op->setAllocations({ new Allocation{ food, -10. }, new Allocation{ food, -2.5 } });
+    const QModelIndex row = account->index(0);
+    QCOMPARE(account->data(row, Account::AmountTextRole).toString(), QString("-12,50 €"));
+    QCOMPARE(account->data(row, Account::BalanceTextRole).toString(), QString("-12,50 €"));
+    QCOMPARE(account->data(row, Account::CategoryDisplayRole).toString(), QString("Food"));
+
+    // Cached texts follow the operation and its categories
+    QSignalSpy dataSpy(account, &Account::dataChanged);
+    food->set_name("Groceries");
+    QCOMPARE(dataSpy.count(), 1);
+    QCOMPARE(account->data(row, Account::CategoryDisplayRole).toString(), QString("Groceries"));
+    op->set_amount(-20.);
+    QCOMPARE(account->data(row, Account::AmountTextRole).toString(), QString("-20,00 €"));
+    QCOMPARE(account->data(row, Account::BalanceTextRole).toString(), QString("-20,00 €"));
+  }
+
+  void testCategoryNameIndex() {
+    auto food = categoryController->addCategory(new Category("Food", -250));
+    auto transport = categoryController->addCategory(new Category("Transport", -50));
+    QCOMPARE(categoryController->getCategoryByName("Food"), food);
+    QCOMPARE(categoryController->getCategoryByName("Transport"), transport);
+    QCOMPARE(categoryController->getCategoryByName("Rent"), nullptr);
+    QCOMPARE(categoryController->addCategory(new Category("Food", -100)), nullptr);
+
+    food->set_name("Groceries");
+    QCOMPARE(categoryController->getCategoryByName("Groceries"), food);
+    QCOMPARE(categoryController->getCategoryByName("Food"), nullptr);
+
+    // Renaming onto an existing name keeps both categories reachable
+    transport->set_name("Groceries");
+    QCOMPARE(categoryController->getCategoryByName("Groceries"), food);
+    QCOMPARE(categoryController->getCategoryByName("Transport"), nullptr);
+    food->set_name("Food");
+    QCOMPARE(categoryController->getCategoryByName("Groceries"), transport);
+    QCOMPARE(categoryController->getCategoryByName("Food"), food);
+
+    Category* taken = categoryController->takeCategoryByName("Food");
+    QCOMPARE(taken, food);
+    QCOMPARE(categoryController->getCategoryByName("Food"), nullptr);
+    QCOMPARE(categoryController->getCategoryByName("Groceries"), transport);
+
+    // A category renamed while out of the controller is not indexed
+    food->set_name("Rent");
+    QCOMPARE(categoryController->getCategoryByName("Rent"), nullptr);
+    QCOMPARE(categoryController->addCategory(food), food);
+    QCOMPARE(categoryController->getCategoryByName("Rent"), food);
+  }
+
+  void testAccountNameIndex() {
+    auto checking = budgetData->addAccount(new Account("Checking"));
+    auto savings = budgetData->addAccount(new Account("Savings"));
+    QCOMPARE(budgetData->accountByName("Checking"), checking);
+    QCOMPARE(budgetData->accountByName("Savings"), savings);
+    QCOMPARE(budgetData->accountByName("Cash"), nullptr);
+
+    checking->set_name("Current");
+    QCOMPARE(budgetData->accountByName("Current"), checking);
+    QCOMPARE(budgetData->accountByName("Checking"), nullptr);
+
+    // Renaming onto an existing name keeps the first account, then frees the other
+    savings->set_name("Current");
+    QCOMPARE(budgetData->accountByName("Current"), checking);
+    checking->set_name("Checking");
+    QCOMPARE(budgetData->accountByName("Current"), savings);
+    QCOMPARE(budgetData->accountByName("Checking"), checking);
+
+    QCOMPARE(budgetData->takeAccount(checking), checking);
+    QCOMPARE(budgetData->accountByName("Checking"), nullptr);
+    QCOMPARE(budgetData->accountByName("Current"), savings);
+    delete checking;
+
+    budgetData->removeAccount(0);
+    QCOMPARE(budgetData->accountByName("Current"), nullptr);
+  }
+
+  void testOperationIndexFollowsRows() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread"));
+    auto wine = account->addOperation(new Operation(account, QDate(2026, 8, 17), 4., "Wine"));
+    auto cheese = account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Cheese"));
+    QCOMPARE(account->operationIndex(wine), 0);
+    QCOMPARE(account->operationIndex(cheese), 1);
+    QCOMPARE(account->operationIndex(bread), 2);
+
+    account->removeOperation(wine);
+    QCOMPARE(account->operationIndex(wine), -1);
+    QCOMPARE(account->operationIndex(cheese), 0);
+    QCOMPARE(account->operationIndex(bread), 1);
+    delete wine;
+
+    // Unsorted appends, then a sort
+    auto milk = account->addOperation(new Operation(account, QDate(2026, 8, 20), 3., "Milk"), false);
+    QCOMPARE(account->operationIndex(milk), 2);
+    account->sortOperations();
+    QCOMPARE(account->operationIndex(milk), 0);
+    QCOMPARE(account->operationIndex(cheese), 1);
+    QCOMPARE(account->operationIndex(bread), 2);
+
+    Operation* eggs = nullptr;
+    Operation* butter = nullptr;
+    {
+      BatchScope batch(*budgetData);
+      eggs = account->addOperation(new Operation(account, QDate(2026, 8, 18), 5., "Eggs"));
+      butter = account->addOperation(new Operation(account, QDate(2026, 8, 1), 6., "Butter"));
+    }
+    QCOMPARE(account->operationIndex(milk), 0);
+    QCOMPARE(account->operationIndex(eggs), 1);
+    QCOMPARE(account->operationIndex(cheese), 2);
+    QCOMPARE(account->operationIndex(bread), 3);
+    QCOMPARE(account->operationIndex(butter), 4);
+
+    account->removeOperations({ eggs, bread });
+    QCOMPARE(account->operationIndex(eggs), -1);
+    QCOMPARE(account->operationIndex(bread), -1);
+    QCOMPARE(account->operationIndex(milk), 0);
+    QCOMPARE(account->operationIndex(cheese), 1);
+    QCOMPARE(account->operationIndex(butter), 2);
+    QCOMPARE(account->operationIndex(nullptr), -1);
+    delete eggs;
+    delete bread;
+  }
+
+  void testSortOperationsMovesPersistentIndexes() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    auto bread = account->addOperation(new Operation(account, QDate(2026, 8, 15), 1., "Bread"), false);
+    auto cheese = account->addOperation(new Operation(account, QDate(2026, 8, 16), 2., "Cheese"), false);
+    account->selectAt(0);
+    QPersistentModelIndex breadIndex(account->index(0));
+
+    account->sortOperations();
+    QCOMPARE(account->operationAt(0), cheese);
+    QCOMPARE(breadIndex.row(), 1);
+    QCOMPARE(account->operationAt(breadIndex.row()), bread);
+    QVERIFY(account->isSelected(bread));
+    QVERIFY(account->isSelectedAt(1));
+  }
+
+  void testSelectionCountAndTotal() {
+    auto account = budgetData->addAccount(new Account("Account"));
+    account->set_openingBalance(1000.);
+    account->addOperation(new Operation(account, QDate(2026, 8, 1), -10., "Bread"));
+    auto cheese = account->addOperation(new Operation(account, QDate(2026, 8, 2), -20., "Cheese"));
+    auto wine = account->addOperation(new Operation(account, QDate(2026, 8, 3), -40., "Wine"));
+    account->addOperation(new Operation(account, QDate(2026, 8, 4), 100., "Salary"));
+    QSignalSpy selectionSpy(account, &Account::selectionChanged);
+
+    // Rows are sorted most recent first
+    account->selectRange(2, 1);
+    QCOMPARE(account->selectionCount(), 2);
+    QCOMPARE(account->selectedTotal(), -60.);
+    account->toggleSelectionAt(0);
+    QCOMPARE(account->selectionCount(), 3);
+    QCOMPARE(account->selectedTotal(), 40.);
+    account->toggleSelectionAt(1);
+    QCOMPARE(account->selectionCount(), 2);
+    QCOMPARE(account->selectedTotal(), 80.);
+    QCOMPARE(selectionSpy.count(), 3);
+
+    // The opening balance is not part of any row
+    account->selectAll();
+    QCOMPARE(account->selectionCount(), 4);
+    QCOMPARE(account->selectedTotal(), 30.);
+
+    // The total follows the amount and the removal of selected rows
+    cheese->set_amount(-25.);
+    QCOMPARE(account->selectedTotal(), 25.);
+    account->removeOperation(wine);
+    delete wine;
+    QCOMPARE(account->selectionCount(), 3);
+    QCOMPARE(account->selectedTotal(), 65.);
+
+    account->clearSelection();
+    QCOMPARE(account->selectionCount(), 0);
+    QCOMPARE(account->selectedTotal(), 0.);
+    selectionSpy.clear();
+    account->clearSelection();
+    QCOMPARE(selectionSpy.count(), 0);
+  }
+
+  void testTransferMatches() {
+    auto checking = budgetData->addAccount(new Account("Checking"));
+    auto savings = budgetData->addAccount(new Account("Savings"));
+    auto food = categoryController->editCategory("Food", 100.);
+    auto saving = categoryController->editCategory("Saving", 100.);
+    auto toSavings = checking->addOperation(new Operation(checking, QDate(2026, 3, 1), -100., "To savings"));
+    toSavings->setAllocations({ new Allocation{ saving, -100. } });
+    auto fromChecking = savings->addOperation(new Operation(savings, QDate(2026, 3, 3), 100., "From checking"));
+    savings->addOperation(new Operation(savings, QDate(2026, 3, 20), 100., "Too late"));
+    checking->addOperation(new Operation(checking, QDate(2026, 3, 1), 100., "Same account"));
+    auto groceries = checking->addOperation(new Operation(checking, QDate(2026, 3, 5), -50., "Groceries"));
+    auto refund = savings->addOperation(new Operation(savings, QDate(2026, 3, 5), 50., "Refund"));
+    refund->setAllocations({ new Allocation{ food, 50. } });
+    checking->addOperation(new Operation(checking, QDate(2026, 3, 6), -30., "Uncategorized"));
+    savings->addOperation(new Operation(savings, QDate(2026, 3, 6), 30., "Uncategorized"));
+
+    // Pairs in different accounts within the window with one categorized side, closest date first
+    QCOMPARE(TransferMatchModel::findMatches(budgetData->accounts(), 3).size(), 2);
+    QCOMPARE(TransferMatchModel::findMatches(budgetData->accounts(), 1).size(), 1);
+
+    auto model = budgetData->transferMatches();
+    model->refresh();
+    QCOMPARE(model->rowCount(), 2);
+    QCOMPARE(model->data(model->index(0), TransferMatchModel::TargetRole).value<Operation*>(), groceries);
+    QCOMPARE(model->data(model->index(1), TransferMatchModel::SourceRole).value<Operation*>(), toSavings);
+    QCOMPARE(model->data(model->index(1), TransferMatchModel::TargetRole).value<Operation*>(), fromChecking);
+    QCOMPARE(model->data(model->index(1), TransferMatchModel::DayGapRole).toInt(), 2);
+
+    // Accepted matches are applied in one undo step
+    model->setAccepted(0, false);
+    QCOMPARE(model->acceptedCount(), 1);
+    QCOMPARE(model->apply(), 1);
+    QCOMPARE(fromChecking->allocations().size(), 1);
+    QCOMPARE(fromChecking->allocations().first()->category(), saving);
+    QCOMPARE(fromChecking->allocations().first()->amount(), 100.);
+    QVERIFY(groceries->allocations().isEmpty());
+    QCOMPARE(model->rowCount(), 1);
+
+    undoStack->undo();
+    QVERIFY(fromChecking->allocations().isEmpty());
+  }
+
+  void testTransferMatchesAcrossThreeAccounts() {
+    auto joint = budgetData->addAccount(new Account("Joint"));
+    auto checking = budgetData->addAccount(new Account("Checking"));
+    auto savings = budgetData->addAccount(new Account("Savings"));
+    auto saving = categoryController->editCategory("Saving", 100.);
+    joint->addOperation(new Operation(joint, QDate(2026, 3, 1), -100., "Card payment"));
+    auto toSavings = checking->addOperation(new Operation(checking, QDate(2026, 3, 1), -100., "To savings"));
+    toSavings->setAllocations({ new Allocation{ saving, -100. } });
+    auto fromChecking = savings->addOperation(new Operation(savings, QDate(2026, 3, 2), 100., "From checking"));
+
+    // The uncategorized outflow comes first but cannot take the inflow from the categorized one
+    const auto matches = TransferMatchModel::findMatches(budgetData->accounts(), 3);
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.first().outflow, toSavings);
+    QCOMPARE(matches.first().inflow, fromChecking);
+
+    auto model = budgetData->transferMatches();
+    model->refresh();
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->data(model->index(0), TransferMatchModel::SourceRole).value<Operation*>(), toSavings);
+    QCOMPARE(model->data(model->index(0), TransferMatchModel::TargetRole).value<Operation*>(), fromChecking);
+  }
 };
 
 QTEST_GUILESS_MAIN(CategoryTest)
@@ -67,6 +67,39 @@ private slots:
 
   void parseAmount_Whitespace() { QCOMPARE(parseAmount("   "), 0.0); }
 
+  // parseMoney tests (exact cents, no floating point)
+  void parseMoney_FrenchFormatWithEuro() {
+    QCOMPARE(parseMoney("-5 428,69 €"), Money::fromCents(-542869));
+  }
+
+  void parseMoney_PositiveSign() { QCOMPARE(parseMoney("+45,5"), Money::fromCents(4550)); }
+
+  void parseMoney_SumIsExact() {
+    // 0.1 + 0.2 drifts in floating point but not in cents
+    QCOMPARE(parseMoney("0,10") + parseMoney("0,20"), parseMoney("0,30"));
+  }
+
+  // Money formatting and parsing
+  void money_ToString() {
+    QCOMPARE(Money(-9.99).toString(), QString("-9.99"));
+    QCOMPARE(Money(0.05).toString(), QString("0.05"));
+    QCOMPARE(Money(-0.5).toString(), QString("-0.50"));
+    QCOMPARE(Money(2500.0).toString(), QString("2500.00"));
+  }
+
+  void money_FromStringRoundsExtraDigits() {
+    // Older files stored rule amounts with full double precision
+    QCOMPARE(Money::fromString("-9.9900000000000002"), Money::fromCents(-999));
+    QCOMPARE(Money::fromString("12.345"), Money::fromCents(1235));
+    QCOMPARE(Money::fromString("-12"), Money::fromCents(-1200));
+  }
+
+  void money_FromStringInvalid() {
+    bool ok = true;
+    QCOMPARE(Money::fromString("abc", &ok), Money());
+    QVERIFY(!ok);
+  }
+
   // parseCsvLine tests
   void parseCsvLine_Semicolon() {
     QString line =
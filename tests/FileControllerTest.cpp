@@ -1,16 +1,20 @@
 // Integration tests for FileController
 #include <QDate>
 #include <QFile>
+#include <QSaveFile>
 #include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTest>
 #include <QUrl>
+#include <QtEndian>
 
 #include "../Account.h"
 #include "../AppSettings.h"
+#include "../ArchiveStore.h"
 #include "../BudgetData.h"
 #include "../Category.h"
 #include "../CategoryController.h"
+#include "../CsvExporter.h"
 #include "../FileController.h"
 #include "../Operation.h"
 #include "../Rule.h"
@@ -19,6 +23,67 @@
 
 Q_DECLARE_METATYPE(QDate)
 
+namespace {
+
+// Reads a FlatBuffers table of an Arrow file, independently of the writer, following
+// https://flatbuffers.dev/internals/: offsets are relative to where they are stored
+struct FlatTable {
+  const QByteArray& data;
+  qint64 position;
+
+  template <typename T>
+  T read(qint64 at) const {
+    // A wrong offset fails the test instead of reading past the file
+    if (at < 0 || at + qint64(sizeof(T)) > data.size()) {
+      QTest::qFail("Offset outside the file", __FILE__, __LINE__);
+      return T();
+    }
+    return qFromLittleEndian<T>(data.constData() + at);
+  }
+
+  static FlatTable root(const QByteArray& data, qint64 base) {
+    const FlatTable buffer{ data, base };
+    return { data, base + buffer.read<quint32>(base) };
+  }
+
+  // Position of a field, -1 if absent
+  qint64 field(int id) const {
+    const qint64 vtable = position - read<qint32>(position);
+    const quint16 vtableSize = read<quint16>(vtable);
+    if (4 + 2 * id >= vtableSize)
+      return -1;
+    const quint16 offset = read<quint16>(vtable + 4 + 2 * id);
+    return offset ? position + offset : -1;
+  }
+
+  template <typename T>
+  T scalar(int id, T defaultValue = 0) const {
+    const qint64 at = field(id);
+    return at < 0 ? defaultValue : read<T>(at);
+  }
+
+  qint64 indirect(int id) const {
+    const qint64 at = field(id);
+    return at + read<quint32>(at);
+  }
+
+  FlatTable table(int id) const { return { data, indirect(id) }; }
+  QString string(int id) const {
+    const qint64 at = indirect(id);
+    const quint32 length = read<quint32>(at);
+    return read<quint8>(at + 4 + length) == 0 ? QString::fromUtf8(data.constData() + at + 4, length) : QString();
+  }
+  bool has(int id) const { return field(id) >= 0; }
+  qint64 vectorLength(int id) const { return read<quint32>(indirect(id)); }
+  qint64 vectorStart(int id) const { return indirect(id) + 4; }
+  FlatTable tableAt(int id, int index) const {
+    const qint64 at = vectorStart(id) + 4 * index;
+    return { data, at + read<quint32>(at) };
+  }
+};
+
+}  // namespace
+
 class FileControllerTest : public QObject {
   Q_OBJECT
 
@@ -341,8 +406,8 @@ private slots:
     Category* loadedCat = categoryController->getCategoryByName("Savings");
     QVERIFY(loadedCat != nullptr);
     LeftoverDecision decision = loadedCat->leftoverDecision(2025, 1);
-    QCOMPARE(decision.saveAmount, 100.0);
-    QCOMPARE(decision.reportAmount, 50.0);
+    QCOMPARE(decision.saveAmount, Money(100.0));
+    QCOMPARE(decision.reportAmount, Money(50.0));
   }
 
   void testLoadLegacyLeftoverFormat() {
@@ -367,8 +432,8 @@ private slots:
     Category* cat = categoryController->getCategoryByName("Food");
     QVERIFY(cat != nullptr);
     LeftoverDecision decision = cat->leftoverDecision(2025, 1);
-    QCOMPARE(decision.saveAmount, 50.0);
-    QCOMPARE(decision.reportAmount, 0.0);
+    QCOMPARE(decision.saveAmount, Money(50.0));
+    QCOMPARE(decision.reportAmount, Money(0.0));
   }
 
   // Save/Load with Month History and Budget Limit Overrides
@@ -396,10 +461,10 @@ private slots:
 
     // Verify month record has both leftover data and budget limit
     MonthRecord record = loaded->monthRecord(2025, 6);
-    QCOMPARE(record.saveAmount, 30.0);
-    QCOMPARE(record.reportAmount, 20.0);
+    QCOMPARE(record.saveAmount, Money(30.0));
+    QCOMPARE(record.reportAmount, Money(20.0));
     QVERIFY(record.budgetLimit.has_value());
-    QCOMPARE(record.budgetLimit.value(), -250.0);
+    QCOMPARE(record.budgetLimit.value(), Money(-250.0));
 
     // Verify budgetLimitForMonth lookup works after reload
     QCOMPARE(loaded->budgetLimitForMonth(QDate(2025, 3, 1)), -250.0);
@@ -423,10 +488,10 @@ private slots:
     QVERIFY(loaded != nullptr);
 
     MonthRecord record = loaded->monthRecord(2025, 3);
-    QCOMPARE(record.saveAmount, 0.0);
-    QCOMPARE(record.reportAmount, 0.0);
+    QCOMPARE(record.saveAmount, Money(0.0));
+    QCOMPARE(record.reportAmount, Money(0.0));
     QVERIFY(record.budgetLimit.has_value());
-    QCOMPARE(record.budgetLimit.value(), -100.0);
+    QCOMPARE(record.budgetLimit.value(), Money(-100.0));
   }
 
   void testSaveAndLoadMultipleBudgetLimitChanges() {
@@ -477,8 +542,8 @@ private slots:
     QVERIFY(cat != nullptr);
 
     LeftoverDecision decision = cat->leftoverDecision(2025, 1);
-    QCOMPARE(decision.saveAmount, 40.0);
-    QCOMPARE(decision.reportAmount, 15.0);
+    QCOMPARE(decision.saveAmount, Money(40.0));
+    QCOMPARE(decision.reportAmount, Money(15.0));
   }
 
   void testSaveUsesMonthHistoryKey() {
@@ -521,6 +586,371 @@ private slots:
     QCOMPARE(rules[0]->labelMatch(), QString("SUPERMARKET"));
   }
 
+  void testSaveAndLoadRuleMatchModes() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+    auto transport = categoryController->editCategory("Transport", 100.0);
+    auto rent = categoryController->editCategory("Rent", 800.0);
+    ruleController->addRule(groceries, "CB ", 0, Rule::MatchMode::Prefix);
+    ruleController->addRule(rent, "LOYER", -800.0, Rule::MatchMode::Exact);
+    ruleController->addRule(fuel, "total", 0, Rule::MatchMode::WholeWord);
+    ruleController->addRule(transport, "^CB (SNCF|RATP)\\b", 0, Rule::MatchMode::Regex);
+
+    // Modes are saved in both formats
+    for (const char* fileName : { "modes.comptine", "modes.comptinedb" }) {
+      QString filePath = tempDir->filePath(fileName);
+      QVERIFY(fileController->saveToYamlFile(filePath));
+      fileController->clear();
+      QVERIFY(fileController->loadFromYamlFile(filePath));
+      QList<Rule*> rules = ruleController->rules();
+      QCOMPARE(rules.size(), 4);
+      QCOMPARE(rules[0]->matchMode(), Rule::MatchMode::Prefix);
+      QCOMPARE(rules[1]->matchMode(), Rule::MatchMode::Exact);
+      QCOMPARE(rules[2]->matchMode(), Rule::MatchMode::WholeWord);
+      QCOMPARE(rules[3]->matchMode(), Rule::MatchMode::Regex);
+      QCOMPARE(rules[3]->labelMatch(), QString("^CB (SNCF|RATP)\\b"));
+    }
+  }
+
+  // SQLite storage
+
+  void testSaveAndLoadDatabase() {
+    QVERIFY(fileController->loadFromYamlUrl(QUrl("file::/tests/example.comptine")));
+    QString filePath = tempDir->filePath("example.comptinedb");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    QCOMPARE(fileController->currentFilePath(), filePath);
+    QCOMPARE(budgetData->rowCount(), 2);
+    QCOMPARE(categoryController->rowCount(), 8);
+    Account* account = budgetData->accountAt(0);
+    QCOMPARE(account->name(), QString("Compte Courant"));
+    QCOMPARE(account->operations().size(), 5);
+    auto operation = account->operations().at(0);
+    QCOMPARE(operation->date(), QDate(2025, 10, 8));
+    QCOMPARE(operation->amount(), -45.0);
+    QCOMPARE(operation->details(), QString("Carte du 06/10/2025"));
+    QCOMPARE(operation->allocations().count(), 2);
+    QCOMPARE(operation->allocations().at(0)->category()->name(), QString("Alimentation"));
+    QCOMPARE(operation->allocations().at(1)->amount(), -5.0);
+
+    // Accounts not on screen are read from the event loop
+    Account* savings = budgetData->accountAt(1);
+    QCOMPARE(savings->rowCount(), 0);
+    QTRY_COMPARE(savings->rowCount(), 1);
+
+    // Saving again only writes the changes
+    operation->set_label("Carrefour");
+    undoStack->push(new DeleteOperationCommand(account->operations().at(1), *account));
+    account->addOperation(new Operation(account, QDate(2025, 10, 9), -12., "Bakery"));
+    QVERIFY(fileController->saveToYamlFile(filePath));
+
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    account = budgetData->accountAt(0);
+    QCOMPARE(account->operations().size(), 5);
+    QCOMPARE(account->operations().at(0)->label(), QString("Bakery"));
+    QCOMPARE(account->operations().at(1)->label(), QString("Carrefour"));
+    QCOMPARE(account->operations().at(1)->allocations().count(), 2);
+  }
+
+  void testDatabaseScansReadPendingAccounts() {
+    QVERIFY(fileController->loadFromYamlUrl(QUrl("file::/tests/example.comptine")));
+    QString filePath = tempDir->filePath("scans.comptinedb");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+
+    // Deleting a category right after opening also clears the accounts not read yet
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    Account* savings = budgetData->accountAt(1);
+    QCOMPARE(savings->rowCount(), 0);
+    Category* saving = categoryController->getCategoryByName("Epargne");
+    categoryController->deleteCategory(saving);
+    QCOMPARE(savings->rowCount(), 1);
+    QVERIFY(savings->operations().first()->allocations().isEmpty());
+    undoStack->undo();
+    QCOMPARE(savings->operations().first()->allocations().size(), 1);
+
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    QCOMPARE(budgetData->accountAt(1)->rowCount(), 0);
+    QCOMPARE(budgetData->countOperationsWithCategory(categoryController->getCategoryByName("Epargne")), 1);
+  }
+
+  // Export
+
+  void testExportOperations() {
+    Account* account = new Account("Checking");
+    budgetData->addAccount(account);
+    auto food = categoryController->editCategory("Food", 200.0);
+    auto transport = categoryController->editCategory("Transport", 100.0);
+    auto op = account->addOperation(new Operation(account, QDate(2025, 2, 1), -150.0, "Shop, \"Mixed\""));
+    op->setAllocations({ new Allocation{ food, -100.0 }, new Allocation{ transport, -50.0 } });
+    account->addOperation(new Operation(account, QDate(2025, 2, 3), 20.0, "Refund"));
+
+    auto readLines = [](const QString& filePath) {
+      QFile file(filePath);
+      return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts) : QStringList();
+    };
+
+    QString csvPath = tempDir->filePath("export.csv");
+    QVERIFY(fileController->exportOperationsToUrl(QUrl::fromLocalFile(csvPath)));
+    QStringList lines = readLines(csvPath);
+    QCOMPARE(lines.size(), 4);
+    QCOMPARE(lines[0], QString("Account,Date,Budget date,Label,Details,Amount,Category,Balance"));
+    QCOMPARE(lines[1], QString("Checking,2025-02-03,2025-02-03,Refund,,20.00,,-130.00"));
+    QCOMPARE(lines[2], QString("Checking,2025-02-01,2025-02-01,\"Shop, \"\"Mixed\"\"\",,-100.00,Food,-150.00"));
+    QCOMPARE(lines[3], QString("Checking,2025-02-01,2025-02-01,\"Shop, \"\"Mixed\"\"\",,-50.00,Transport,-150.00"));
+
+    QString tsvPath = tempDir->filePath("export.tsv");
+    QVERIFY(fileController->exportOperationsToUrl(QUrl::fromLocalFile(tsvPath)));
+    lines = readLines(tsvPath);
+    QCOMPARE(lines[2], QString("Checking\t2025-02-01\t2025-02-01\tShop, \"Mixed\"\t\t-100.00\tFood\t-150.00"));
+
+    // The clipboard text uses the same engine
+    account->selectAll();
+    QCOMPARE(CsvExporter::operationsText(*account, account->selectedOperations()),
+             QString("Date,Label,Amount,Category\n2025-02-03,Refund,20.00,\n2025-02-01,\"Shop, \"\"Mixed\"\"\",-150.00,\"Food, Transport\"\n"));
+  }
+
+  void testExportAnalytics() {
+    Account* account = new Account("Checking");
+    budgetData->addAccount(account);
+    auto food = categoryController->editCategory("Food", 200.0);
+    for (int i = 0; i < 3; ++i) {
+      auto op = account->addOperation(new Operation(account, QDate(2025, 2, i + 1), -10.0, "Bakery"));
+      op->setAllocations({ new Allocation{ food, -10.0 } });
+    }
+    account->addOperation(new Operation(account, QDate(2025, 2, 4), -5.0, "Bakery"));
+    budgetData->addAccount(new Account("Empty"));
+
+    QString filePath = tempDir->filePath("export.arrow");
+    QVERIFY(fileController->exportAnalyticsToUrl(QUrl::fromLocalFile(filePath)));
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    QVERIFY(data.startsWith(QByteArray("ARROW1\0\0", 8)));
+    QVERIFY(data.endsWith("ARROW1"));
+
+    // Strings are only written once, in the dictionaries
+    QCOMPARE(data.count("Bakery"), 1);
+    QCOMPARE(data.count("Food"), 1);
+    QCOMPARE(data.count("Checking"), 1);
+
+    // Footer (File.fbs): the schema, then blocks of 24 bytes locating each message
+    const qint64 footerLength = qFromLittleEndian<qint32>(data.constData() + data.size() - 10);
+    const FlatTable footer = FlatTable::root(data, data.size() - 10 - footerLength);
+    QCOMPARE(footer.scalar<qint16>(0), qint16(4));  // Metadata version V5
+    const FlatTable schema = footer.table(1);
+    QCOMPARE(schema.vectorLength(1), qint64(8));
+    const QStringList names{ "account", "operation", "date", "budget_date", "label", "category", "amount_cents", "operation_amount_cents" };
+    const QList<quint8> typeTags{ 5, 2, 8, 8, 5, 5, 2, 2 };  // Utf8, Int and Date in the Type union
+    for (int i = 0; i < names.size(); ++i) {
+      const FlatTable field = schema.tableAt(1, i);
+      QCOMPARE(field.string(0), names[i]);
+      QCOMPARE(field.scalar<quint8>(1), quint8(names[i] == "category"));  // Nullable
+      QCOMPARE(field.scalar<quint8>(2), typeTags[i]);
+      QCOMPARE(field.has(4), typeTags[i] == 5);  // Dictionary encoding
+      QCOMPARE(field.vectorLength(5), qint64(0));  // No children
+    }
+    const FlatTable accountEncoding = schema.tableAt(1, 0).table(4);
+    QCOMPARE(accountEncoding.scalar<qint64>(0), qint64(0));
+    QCOMPARE(accountEncoding.table(1).scalar<qint32>(0), 32);  // Index bit width
+    QCOMPARE(schema.tableAt(1, 1).table(3).scalar<qint32>(0), 64);
+    QCOMPARE(schema.tableAt(1, 1).table(3).scalar<quint8>(1), quint8(true));  // Signed
+    QCOMPARE(footer.vectorLength(2), qint64(3));  // Dictionaries
+    QCOMPARE(footer.vectorLength(3), qint64(1));  // Record batches, none for the empty account
+
+    // Each block points to an encapsulated message (Message.fbs) followed by its body
+    struct Message {
+      FlatTable table;
+      quint32 continuation;
+      qint32 metadataSize;         // Written before the metadata
+      qint32 blockMetadataLength;  // From the footer, with the 8 bytes before the metadata
+      qint64 blockBodyLength;
+      qint64 bodyStart;
+    };
+    auto message = [&](int vectorId, int index) {
+      const qint64 block = footer.vectorStart(vectorId) + 24 * index;
+      const qint64 offset = footer.read<qint64>(block);
+      const qint32 metadataLength = footer.read<qint32>(block + 8);
+      return Message{ FlatTable::root(data, offset + 8), footer.read<quint32>(offset), footer.read<qint32>(offset + 4),
+                      metadataLength, footer.read<qint64>(block + 16), offset + metadataLength };
+    };
+    auto checkMessage = [](const Message& message, quint8 headerType) {
+      QCOMPARE(message.continuation, 0xFFFFFFFFu);
+      QCOMPARE(message.metadataSize + 8, message.blockMetadataLength);
+      QCOMPARE(message.table.scalar<qint16>(0), qint16(4));
+      QCOMPARE(message.table.scalar<quint8>(1), headerType);
+      QCOMPARE(message.table.scalar<qint64>(3), message.blockBodyLength);
+    };
+
+    for (int i = 0; i < 3; ++i) {
+      checkMessage(message(2, i), 2);  // DictionaryBatch
+      if (QTest::currentTestFailed())
+        return;
+      QCOMPARE(message(2, i).table.table(2).scalar<qint64>(0), qint64(i));
+    }
+    QCOMPARE(message(2, 0).table.table(2).table(1).scalar<qint64>(0), qint64(2));  // Checking and Empty
+
+    // One row per allocation, and one for the uncategorized operation, with a null category
+    const Message batch = message(3, 0);
+    checkMessage(batch, 3);  // RecordBatch
+    if (QTest::currentTestFailed())
+      return;
+    const FlatTable recordBatch = batch.table.table(2);
+    QCOMPARE(recordBatch.scalar<qint64>(0), qint64(4));
+    QCOMPARE(recordBatch.vectorLength(1), qint64(8));   // Field nodes of 16 bytes
+    QCOMPARE(recordBatch.vectorLength(2), qint64(16));  // Validity and values buffers of 16 bytes
+    for (int column = 0; column < 8; ++column) {
+      const qint64 node = recordBatch.vectorStart(1) + 16 * column;
+      QCOMPARE(recordBatch.read<qint64>(node), qint64(4));
+      QCOMPARE(recordBatch.read<qint64>(node + 8), qint64(column == 5));  // Null count
+    }
+
+    // Most recent operation first, dates as days since the Unix epoch
+    const qint64 dateValues = recordBatch.vectorStart(2) + 16 * 5;
+    const qint64 dateOffset = recordBatch.read<qint64>(dateValues);
+    QCOMPARE(recordBatch.read<qint64>(dateValues + 8), qint64(16));
+    QCOMPARE(recordBatch.read<qint32>(batch.bodyStart + dateOffset), qint32(QDate(1970, 1, 1).daysTo(QDate(2025, 2, 4))));
+  }
+
+  // Autosave
+
+  void testAutosave() {
+    Account* account = new Account("Checking");
+    budgetData->addAccount(account);
+    QString filePath = tempDir->filePath("autosave.comptine");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+
+    // Edited while the snapshot is written: the budget stays unsaved
+    account->addOperation(new Operation(account, QDate(2025, 3, 1), -10.0, "Bakery"));
+    undoStack->push(new QUndoCommand("Add bakery"));
+    fileController->autosave();
+    undoStack->push(new QUndoCommand("Another change"));
+    auto fileContent = [&] {
+      QFile file(filePath);
+      return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+    QTRY_VERIFY(fileContent().contains("Bakery"));
+    QVERIFY(fileController->hasUnsavedChanges());
+
+    // Saved again once the edits stop
+    QTRY_VERIFY_WITH_TIMEOUT(!fileController->hasUnsavedChanges(), 10000);
+
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    QCOMPARE(budgetData->accountAt(0)->operations().size(), 1);
+  }
+
+  // Year Archiving
+
+  void testArchiveYears() {
+    Account* account = new Account("Checking");
+    budgetData->addAccount(account);
+    auto food = categoryController->editCategory("Food", 200.0);
+    auto addOperation = [&](const QDate& date, double amount, const QString& label) {
+      auto op = new Operation(account, date, amount, label);
+      op->setAllocations({ new Allocation{ food, amount } });
+      return account->addOperation(op);
+    };
+    addOperation(QDate(2023, 5, 2), -20.0, "Old market");
+    addOperation(QDate(2024, 5, 3), -30.0, "Market");
+    addOperation(QDate(2024, 12, 30), -40.0, "New year dinner")->set_budgetDate(QDate(2025, 1, 1));
+    addOperation(QDate(2025, 1, 10), -50.0, "Bakery");
+    double balance = account->currentBalance();
+
+    QString filePath = tempDir->filePath("archived.comptine");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+    QVERIFY(fileController->archiveYearsBefore(2025));
+
+    // Operations budgeted in an open year stay in the budget
+    QCOMPARE(account->operations().size(), 2);
+    QCOMPARE(account->currentBalance(), balance);
+    QCOMPARE(account->openingBalance(), -50.0);
+    QCOMPARE(categoryController->spentInCategory(food, QDate(2024, 5, 1)), -30.0);
+    QCOMPARE(categoryController->spentInCategory(food, QDate(2025, 1, 1)), -90.0);
+
+    // Selecting every row sums their amounts, without the carried-over balance
+    account->selectAll();
+    QCOMPARE(account->selectionCount(), 2);
+    QCOMPARE(account->selectedTotal(), -90.0);
+    account->clearSelection();
+
+    const QString shardPath = ArchiveStore::shardPath(filePath, 2024);
+    QVERIFY(QFile::exists(shardPath));
+    QVERIFY(QFile::exists(ArchiveStore::shardPath(filePath, 2023)));
+    QVERIFY(!(QFile::permissions(shardPath) & QFileDevice::WriteOwner));
+    QCOMPARE(categoryController->archive()->years(), QList<int>({ 2023, 2024 }));
+
+    // Archived months are browsed from the shard
+    auto detailModel = categoryController->detailModel();
+    detailModel->load(food, QDate(2024, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+    QCOMPARE(detailModel->operationAt(0)->label(), QString("Market"));
+
+    // A shard is rewritten whole when more operations of its year are archived
+    addOperation(QDate(2024, 6, 1), -10.0, "Late market");
+    balance = account->currentBalance();
+    QVERIFY(fileController->archiveYearsBefore(2025));
+    QVERIFY(!(QFile::permissions(shardPath) & QFileDevice::WriteOwner));
+    detailModel->load(food, QDate(2024, 6, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+    QCOMPARE(detailModel->operationAt(0)->label(), QString("Late market"));
+    detailModel->load(food, QDate(2024, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    account = budgetData->accountAt(0);
+    food = categoryController->getCategoryByName("Food");
+    QCOMPARE(account->operations().size(), 2);
+    QCOMPARE(account->currentBalance(), balance);
+    QCOMPARE(categoryController->spentInCategory(food, QDate(2023, 5, 1)), -20.0);
+    detailModel->load(food, QDate(2023, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+    QCOMPARE(detailModel->operationAt(0)->label(), QString("Old market"));
+
+    // A renamed category keeps its archived operations, whether their shard was read before
+    // the rename or not, and the shards follow the new name once saved
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    food = categoryController->getCategoryByName("Food");
+    detailModel->load(food, QDate(2023, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+    food->set_name("Groceries");
+    detailModel->load(food, QDate(2024, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+    QCOMPARE(detailModel->operationAt(0)->label(), QString("Market"));
+    QVERIFY(fileController->saveToYamlFile(filePath));
+    fileController->clear();
+    QVERIFY(fileController->loadFromYamlFile(filePath));
+    food = categoryController->getCategoryByName("Groceries");
+    for (const QDate& month : { QDate(2023, 5, 1), QDate(2024, 6, 1) }) {
+      detailModel->load(food, month);
+      QCOMPARE(detailModel->rowCount(), 1);
+    }
+
+    // Save As takes the archived years along
+    const QString copyPath = tempDir->filePath("archived copy.comptine");
+    QVERIFY(fileController->saveToYamlFile(copyPath));
+    QCOMPARE(categoryController->archive()->years(), QList<int>({ 2023, 2024 }));
+    QVERIFY(!(QFile::permissions(ArchiveStore::shardPath(copyPath, 2023)) & QFileDevice::WriteOwner));
+    detailModel->load(food, QDate(2023, 5, 1));
+    QCOMPARE(detailModel->rowCount(), 1);
+
+    // ... but does not mix them with the shards of another budget
+    const QString otherPath = tempDir->filePath("other.comptine");
+    QFile otherShard(ArchiveStore::shardPath(otherPath, 2020));
+    QVERIFY(otherShard.open(QIODevice::WriteOnly));
+    otherShard.close();
+    QVERIFY(!fileController->saveToYamlFile(otherPath));
+    QVERIFY(!QFile::exists(otherPath));
+    QVERIFY(!QFile::exists(ArchiveStore::shardPath(otherPath, 2023)));
+    QCOMPARE(fileController->currentFilePath(), copyPath);
+  }
+
   // Error Handling
 
   void testSaveToInvalidPath() {
@@ -604,6 +1034,38 @@ private slots:
     QCOMPARE(spy.count(), 1);
   }
 
+  void testFileWatcherIgnoresOwnWrites() {
+    QVERIFY(fileController->loadFromYamlUrl(QUrl("file::/tests/example.comptine")));
+    QString filePath = tempDir->filePath("watched.comptine");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+    QSignalSpy loadedSpy(fileController, &FileController::yamlFileLoaded);
+
+    // Our own saves, even replacing the file, are not read back
+    budgetData->accountAt(0)->operations().at(0)->set_label("Carrefour");
+    QVERIFY(fileController->saveToYamlFile(filePath));
+    QVERIFY(fileController->saveToYamlFile(filePath));
+    QTest::qWait(300);
+    QCOMPARE(loadedSpy.count(), 0);
+
+    // A sync tool replacing the file by a rename is reloaded, and still watched afterwards
+    auto replaceFile = [&filePath](const QByteArray& from, const QByteArray& to) {
+      QFile file(filePath);
+      QVERIFY(file.open(QIODevice::ReadOnly));
+      const QByteArray content = file.readAll().replace(from, to);
+      file.close();
+      QSaveFile newFile(filePath);
+      QVERIFY(newFile.open(QIODevice::WriteOnly));
+      newFile.write(content);
+      QVERIFY(newFile.commit());
+    };
+    replaceFile("Carrefour", "Leclerc");
+    QTRY_COMPARE(loadedSpy.count(), 1);
+    QCOMPARE(budgetData->accountAt(0)->operations().at(0)->label(), QString("Leclerc"));
+    replaceFile("Leclerc", "Auchan");
+    QTRY_COMPARE(loadedSpy.count(), 2);
+    QCOMPARE(budgetData->accountAt(0)->operations().at(0)->label(), QString("Auchan"));
+  }
+
   void testFileExample() {
     QVERIFY(fileController->loadFromYamlUrl(QUrl("file::/tests/example.comptine")));
 
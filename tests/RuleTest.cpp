@@ -0,0 +1,301 @@
+// Unit tests for categorization rules and suggestions
+#include <QDate>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "../Account.h"
+#include "../BudgetData.h"
+#include "../Category.h"
+#include "../CategoryController.h"
+#include "../Operation.h"
+#include "../Rule.h"
+#include "../RuleController.h"
+#include "../RuleListModel.h"
+#include "../RulePreviewModel.h"
+#include "../UndoCommands.h"
+
+class RuleTest : public QObject {
+  Q_OBJECT
+
+  QUndoStack* undoStack;
+  BudgetData* budgetData;
+  CategoryController* categoryController;
+  RuleController* ruleController;
+
+private slots:
+  void init() {
+    // Create fresh instances before each test
+    undoStack = new QUndoStack();  // No parent - we'll delete manually
+    budgetData = new BudgetData(*undoStack);
+    categoryController = new CategoryController(*budgetData, *undoStack);
+    ruleController = new RuleController(*budgetData, *undoStack);
+  }
+
+  void cleanup() {
+    delete ruleController;
+    delete categoryController;
+    delete budgetData;
+    delete undoStack;
+  }
+
+  void testRuleMatchModes() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+    auto transport = categoryController->editCategory("Transport", 100.0);
+    auto rent = categoryController->editCategory("Rent", 800.0);
+
+    QVERIFY(!Rule::matchError("(", Rule::MatchMode::Regex).isEmpty());
+    QVERIFY(Rule::matchError("(", Rule::MatchMode::Contains).isEmpty());
+    ruleController->addRule(rent, "LOYER", -800.0, Rule::MatchMode::Exact);
+    ruleController->addRule(fuel, "total", 0, Rule::MatchMode::WholeWord);
+    ruleController->addRule(transport, "^CB (SNCF|RATP)\\b", 0, Rule::MatchMode::Regex);
+    ruleController->addRule(groceries, "CB ", 0, Rule::MatchMode::Prefix);
+    ruleController->addRule(groceries, "(", 0, Rule::MatchMode::Regex);
+    QCOMPARE(ruleController->ruleCount(), 4);
+
+    auto category = [this](const QString& label, double amount) {
+      Operation operation(nullptr, QDate(2025, 3, 1), amount, label);
+      return ruleController->matchingCategory(&operation);
+    };
+    QCOMPARE(category("loyer", -800.0), rent);
+    QCOMPARE(category("LOYER MARS", -800.0), nullptr);
+    QCOMPARE(category("LOYER", -700.0), nullptr);
+    QCOMPARE(category("CB Total Energies", -50.0), fuel);  // Before the prefix rule
+    QCOMPARE(category("CB TOTALLY", -50.0), groceries);
+    QCOMPARE(category("CB SNCF PARIS", -80.0), transport);
+    QCOMPARE(category("CB SNCFX", -80.0), groceries);
+    QCOMPARE(category("PRLV CB ", -10.0), nullptr);
+
+    // Rules follow edits, undo and reordering
+    ruleController->editRule(1, fuel, "TOTAL", 0, Rule::MatchMode::Contains);
+    QCOMPARE(category("CB TOTALLY", -50.0), fuel);
+    undoStack->undo();
+    QCOMPARE(ruleController->rules()[1]->matchMode(), Rule::MatchMode::WholeWord);
+    QCOMPARE(category("CB TOTALLY", -50.0), groceries);
+    ruleController->moveRule(3, 0);
+    QCOMPARE(category("CB Total Energies", -50.0), groceries);
+  }
+
+  void testRulePreview() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+    ruleController->addRule(groceries, "CB ", 0, Rule::MatchMode::Prefix);
+    Account* checking = budgetData->addAccount(new Account("Checking"));
+    Account* card = budgetData->addAccount(new Account("Card"));
+    auto total = checking->addOperation(new Operation(checking, QDate(2025, 3, 1), -50.0, "CB TOTAL"));
+    checking->addOperation(new Operation(checking, QDate(2025, 3, 2), -20.0, "CB CARREFOUR"));
+    auto esso = card->addOperation(new Operation(card, QDate(2025, 3, 3), -40.0, "ESSO STATION"));
+    auto categorized = card->addOperation(new Operation(card, QDate(2025, 3, 4), -60.0, "TOTAL ACCESS"));
+    categorized->setAllocations({ new Allocation(fuel, -60.0) });
+
+    // A new rule after the prefix rule only changes what the prefix rule leaves
+    auto preview = ruleController->preview();
+    QSignalSpy runningSpy(preview, &RulePreviewModel::runningChanged);
+    preview->previewAdd(fuel, "TOTAL|ESSO", 0, Rule::MatchMode::Regex);
+    QVERIFY(preview->running());
+    QTRY_VERIFY(!preview->running());
+    QCOMPARE(runningSpy.count(), 2);
+    QCOMPARE(preview->rowCount(), 2);
+    QCOMPARE(preview->uncategorizedCount(), 1);
+    QModelIndex first = preview->index(0);
+    QCOMPARE(first.data(RulePreviewModel::OperationRole).value<Operation*>(), esso);
+    QCOMPARE(first.data(RulePreviewModel::CurrentCategoryRole).toString(), QString());
+    QCOMPARE(first.data(RulePreviewModel::ProposedCategoryRole).toString(), QString("Fuel"));
+    QCOMPARE(preview->index(1).data(RulePreviewModel::UncategorizedRole).toBool(), false);
+
+    // Moving it first takes CB TOTAL from the prefix rule
+    ruleController->addRule(fuel, "TOTAL|ESSO", 0, Rule::MatchMode::Regex);
+    preview->previewMove(1, 0);
+    QTRY_VERIFY(!preview->running());
+    QCOMPARE(preview->rowCount(), 1);
+    QCOMPARE(preview->index(0).data(RulePreviewModel::OperationRole).value<Operation*>(), total);
+    QCOMPARE(preview->index(0).data(RulePreviewModel::CurrentCategoryRole).toString(), QString("Groceries"));
+
+    // A newer preview replaces the running one, and cancel clears the rows
+    preview->previewEdit(1, fuel, "(", 0, Rule::MatchMode::Regex);
+    QVERIFY(!preview->running());
+    QCOMPARE(preview->rowCount(), 0);
+    preview->previewEdit(0, groceries, "CB CARREFOUR", 0, Rule::MatchMode::Exact);
+    preview->previewEdit(0, groceries, "CB", 0, Rule::MatchMode::WholeWord);
+    QTRY_VERIFY(!preview->running());
+    QCOMPARE(preview->rowCount(), 0);
+    preview->previewEdit(0, groceries, "CB CARREFOUR", 0, Rule::MatchMode::Exact);
+    preview->cancel();
+    QVERIFY(!preview->running());
+    QCOMPARE(preview->rowCount(), 0);
+    QTest::qWait(10);
+    QCOMPARE(preview->rowCount(), 0);
+  }
+
+  void testRuleStatistics() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+    auto transport = categoryController->editCategory("Transport", 100.0);
+    ruleController->addRule(groceries, "CARREFOUR");
+    ruleController->addRule(groceries, "CB CARREFOUR", 0, Rule::MatchMode::Prefix);
+    ruleController->addRule(transport, "SNCF", 0, Rule::MatchMode::Exact);
+    ruleController->addRule(fuel, "TOTAL", 0, Rule::MatchMode::WholeWord);
+
+    QSignalSpy statisticsSpy(ruleController, &RuleController::statisticsChanged);
+    Account* account = budgetData->addAccount(new Account("Account"));
+    for (const char* label : { "CB CARREFOUR 1", "CB CARREFOUR 2", "TOTAL ACCESS", "TOTAL", "SNCF", "SNCF PARIS" }) {
+      auto operation = account->addOperation(new Operation(account, QDate(2025, 3, statisticsSpy.count() + 1), -10.0, label));
+      ruleController->applyRulesToOperation(operation);
+    }
+    QCOMPARE(statisticsSpy.count(), 6);
+    QVERIFY(ruleController->matchingTime() >= 0);
+
+    // Rules found in the index are the only ones tested
+    QList<Rule*> rules = ruleController->rules();
+    QCOMPARE(rules[0]->statistics().matches, 2);
+    QCOMPARE(rules[0]->statistics().evaluations, 2);
+    QCOMPARE(rules[0]->statistics().lastMatchDate, QDate(2025, 3, 2));
+    QCOMPARE(rules[1]->statistics().evaluations, 0);
+    QCOMPARE(rules[2]->statistics().matches, 1);
+    QCOMPARE(rules[3]->statistics().matches, 2);
+    auto model = ruleController->ruleModel();
+    QCOMPARE(model->index(0).data(RuleListModel::MatchCountRole).toInt(), 2);
+    QCOMPARE(model->index(3).data(RuleListModel::EvaluationCountRole).toInt(), 2);
+    QCOMPARE(ruleController->shadowingRules(), QList<int>({ -1, 0, -1, -1 }));
+    QCOMPARE(model->index(1).data(RuleListModel::ShadowedByRole).toInt(), 0);
+
+    // The whole word rule may match what the prefix rule does, it must stay after it
+    QCOMPARE(ruleController->frequencyOrder(), QList<int>({ 0, 2, 1, 3 }));
+    QVERIFY(ruleController->reorderByFrequency());
+    QCOMPARE(ruleController->rules(), QList<Rule*>({ rules[0], rules[2], rules[1], rules[3] }));
+    QVERIFY(!ruleController->reorderByFrequency());
+    undoStack->undo();
+    QCOMPARE(ruleController->rules(), rules);
+
+    // Applying a new rule counts for it
+    ruleController->addRule(transport, "SNCF");
+    QCOMPARE(ruleController->applyRuleToUncategorized(transport, "SNCF"), 1);
+    QCOMPARE(ruleController->rules()[4]->statistics().evaluations, 1);
+    QCOMPARE(ruleController->rules()[4]->statistics().matches, 1);
+
+    ruleController->resetStatistics();
+    QCOMPARE(rules[0]->statistics().matches, 0);
+    QCOMPARE(ruleController->matchingTime(), 0.0);
+  }
+
+  void testRuleListModelUpdates() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+    auto model = ruleController->ruleModel();
+    QSignalSpy resetSpy(model, &QAbstractItemModel::modelReset);
+    QSignalSpy insertSpy(model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removeSpy(model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy moveSpy(model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy dataSpy(model, &QAbstractItemModel::dataChanged);
+
+    ruleController->addRule(groceries, "CARREFOUR");
+    ruleController->addRule(groceries, "CB CARREFOUR", 0, Rule::MatchMode::Prefix);
+    ruleController->addRule(fuel, "TOTAL");
+    QCOMPARE(insertSpy.count(), 3);
+    QCOMPARE(insertSpy.last().at(1).toInt(), 2);
+    QCOMPARE(model->index(1).data(RuleListModel::ShadowedByRole).toInt(), 0);
+
+    // Duplicates are found ignoring case, whatever the position of the rule
+    ruleController->addRule(groceries, "carrefour");
+    QCOMPARE(ruleController->ruleCount(), 3);
+    ruleController->editRule(2, fuel, "Carrefour", 0, Rule::MatchMode::Contains);
+    QCOMPARE(ruleController->rules()[2]->labelMatch(), QString("TOTAL"));
+
+    dataSpy.clear();
+    ruleController->editRule(0, groceries, "LECLERC", 0, Rule::MatchMode::Contains);
+    QVERIFY(!dataSpy.isEmpty());
+    QCOMPARE(dataSpy.first().at(0).value<QModelIndex>().row(), 0);
+    QCOMPARE(model->index(0).data(RuleListModel::LabelMatchRole).toString(), QString("LECLERC"));
+    QCOMPARE(model->index(1).data(RuleListModel::ShadowedByRole).toInt(), -1);
+    // The old match is free again, the new one is taken
+    ruleController->addRule(fuel, "carrefour");
+    QCOMPARE(ruleController->ruleCount(), 4);
+    ruleController->addRule(fuel, "Leclerc");
+    QCOMPARE(ruleController->ruleCount(), 4);
+
+    ruleController->moveRule(3, 0);
+    QCOMPARE(moveSpy.count(), 1);
+    QCOMPARE(model->index(0).data(RuleListModel::LabelMatchRole).toString(), QString("carrefour"));
+    ruleController->removeRule(1);
+    QCOMPARE(removeSpy.count(), 1);
+    undoStack->undo();
+    QCOMPARE(insertSpy.count(), 5);
+    QCOMPARE(ruleController->rules()[1]->labelMatch(), QString("LECLERC"));
+    QCOMPARE(resetSpy.count(), 0);
+
+    // Shadowing is only notified from the changed rule on
+    QCOMPARE(model->index(2).data(RuleListModel::ShadowedByRole).toInt(), 0);
+    dataSpy.clear();
+    ruleController->editRule(3, fuel, "ESSO", 0, Rule::MatchMode::Contains);
+    QVERIFY(!dataSpy.isEmpty());
+    for (const QList<QVariant>& arguments : std::as_const(dataSpy)) {
+      QCOMPARE(arguments.at(0).value<QModelIndex>().row(), 3);
+    }
+    QCOMPARE(model->index(2).data(RuleListModel::ShadowedByRole).toInt(), 0);
+    ruleController->removeRule(0);
+    QCOMPARE(model->index(1).data(RuleListModel::ShadowedByRole).toInt(), -1);
+  }
+
+  void testRegexRulesKeepTheirCase() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto fuel = categoryController->editCategory("Fuel", 150.0);
+
+    // Case matters in a regular expression: \d and \D are opposites
+    ruleController->addRule(fuel, "\\d+", 0, Rule::MatchMode::Regex);
+    ruleController->addRule(groceries, "\\D+", 0, Rule::MatchMode::Regex);
+    QCOMPARE(ruleController->ruleCount(), 2);
+    ruleController->addRule(groceries, "\\D+", 0, Rule::MatchMode::Regex);
+    QCOMPARE(ruleController->ruleCount(), 2);
+
+    // Statistics go to the rule with the same pattern
+    Account* account = budgetData->addAccount(new Account("Account"));
+    account->addOperation(new Operation(account, QDate(2025, 3, 1), -10.0, "MARKET"));
+    QCOMPARE(ruleController->applyRuleToUncategorized(groceries, "\\D+", 0, Rule::MatchMode::Regex), 1);
+    QCOMPARE(ruleController->rules()[1]->statistics().matches, 1);
+    QCOMPARE(ruleController->rules()[0]->statistics().evaluations, 0);
+  }
+
+  void testCategorySuggestions() {
+    auto groceries = categoryController->editCategory("Groceries", 300.0);
+    auto transport = categoryController->editCategory("Transport", 100.0);
+    Account* account = budgetData->addAccount(new Account("Account"));
+    for (const char* label : { "CB CARREFOUR 12/03", "CB CARREFOUR 19/03" }) {
+      auto op = account->addOperation(new Operation(account, QDate(2025, 3, 1), -30.0, label));
+      op->setAllocations({ new Allocation(groceries, -30.0) });
+    }
+    auto train = account->addOperation(new Operation(account, QDate(2025, 3, 2), -80.0, "CB SNCF PARIS"));
+    train->setAllocations({ new Allocation(transport, -80.0) });
+    auto shopping = account->addOperation(new Operation(account, QDate(2025, 3, 26), -42.0, "CB CARREFOUR 26/03"));
+    auto unknown = account->addOperation(new Operation(account, QDate(2025, 3, 27), -10.0, "VIR MYSTERY"));
+
+    QCOMPARE(CategorySuggester::tokens("CB CARREFOUR 12/03"), QStringList({ "cb", "carrefour" }));
+    auto suggester = ruleController->suggester();
+    auto suggestions = suggester->suggestions(shopping->label());
+    QCOMPARE(suggestions.size(), 2);
+    QCOMPARE(suggestions[0].category, groceries);
+    QVERIFY(suggestions[0].confidence > CategorySuggester::DefaultMinimumConfidence);
+    QVERIFY(suggester->suggestions(unknown->label()).isEmpty());
+
+    // The index follows relabeled, recategorized and removed operations
+    QCOMPARE(suggester->suggestedCategoryNames("SNCF"), QStringList({ "Transport" }));
+    train->set_label("CB RATP");
+    QVERIFY(suggester->suggestedCategoryNames("SNCF").isEmpty());
+    train->setAllocations({ new Allocation(groceries, -80.0) });
+    QCOMPARE(suggester->suggestedCategoryNames("RATP"), QStringList({ "Groceries" }));
+    account->removeOperation(train);
+    delete train;
+    QVERIFY(suggester->suggestedCategoryNames("RATP").isEmpty());
+
+    // Top suggestions are accepted in one undo step
+    QCOMPARE(suggester->acceptTopSuggestions(), 1);
+    QCOMPARE(shopping->allocations().size(), 1);
+    QCOMPARE(shopping->allocations().first()->category(), groceries);
+    QCOMPARE(shopping->allocations().first()->amount(), -42.0);
+    QVERIFY(unknown->allocations().isEmpty());
+    undoStack->undo();
+    QVERIFY(shopping->allocations().isEmpty());
+  }
+};
+
+QTEST_GUILESS_MAIN(RuleTest)
+#include "RuleTest.moc"
@@ -24,6 +24,44 @@ Importez et gérez vos données bancaires.</translation>
         <translation>Commit : %1</translation>
     </message>
 </context>
+<context>
+    <name>ArchiveStore</name>
+    <message>
+        <source>The budget has no file</source>
+        <translation>Le budget n&apos;a pas de fichier</translation>
+    </message>
+    <message>
+        <source>Archived years of another budget already exist next to %1</source>
+        <translation>Des années archivées d&apos;un autre budget existent déjà à côté de %1</translation>
+    </message>
+</context>
+<context>
+    <name>ArchiveYearsDialog</name>
+    <message>
+        <source>Archive Closed Years</source>
+        <translation>Archiver les années closes</translation>
+    </message>
+    <message>
+        <source>Archive</source>
+        <translation>Archiver</translation>
+    </message>
+    <message>
+        <source>Archive operations before:</source>
+        <translation>Archiver les opérations antérieures à :</translation>
+    </message>
+    <message>
+        <source>Archived operations move to read-only files next to the budget. Their months can still be browsed, but they can no longer be edited, and archiving cannot be undone.</source>
+        <translation>Les opérations archivées sont déplacées dans des fichiers en lecture seule à côté du budget. Leurs mois restent consultables, mais elles ne sont plus modifiables et l&apos;archivage ne peut pas être annulé.</translation>
+    </message>
+    <message>
+        <source>Save the budget before archiving years.</source>
+        <translation>Enregistrez le budget avant d&apos;archiver des années.</translation>
+    </message>
+    <message>
+        <source>Archived years: %1</source>
+        <translation>Années archivées : %1</translation>
+    </message>
+</context>
 <context>
     <name>BalanceHeader</name>
     <message>
@@ -122,6 +160,16 @@ Importez et gérez vos données bancaires.</translation>
         <translation>Limite de budget</translation>
     </message>
 </context>
+<context>
+    <name>CategorySuggester</name>
+    <message numerus="yes">
+        <source>Categorize %n operation(s) from suggestions</source>
+        <translation>
+            <numerusform>Catégoriser %n opération selon les suggestions</numerusform>
+            <numerusform>Catégoriser %n opérations selon les suggestions</numerusform>
+        </translation>
+    </message>
+</context>
 <context>
     <name>CreateCounterPartDialog</name>
     <message>
@@ -188,6 +236,17 @@ Importez et gérez vos données bancaires.</translation>
         <translation>Décembre</translation>
     </message>
 </context>
+<context>
+    <name>EditMenu</name>
+    <message>
+        <source>Match &amp;Transfers...</source>
+        <translation>Rapprocher les &amp;virements...</translation>
+    </message>
+    <message>
+        <source>Categorize from &amp;Suggestions</source>
+        <translation>Catégoriser selon les &amp;suggestions</translation>
+    </message>
+</context>
 <context>
     <name>FileController</name>
     <message>
@@ -214,6 +273,41 @@ Importez et gérez vos données bancaires.</translation>
         <source>Invalid CSV format: missing required columns (date, label, and debit/credit/amount)</source>
         <translation>Format CSV invalide : colonnes requises manquantes (date, libellé et débit/crédit/montant)</translation>
     </message>
+    <message>
+        <source>Save the budget before archiving years</source>
+        <translation>Enregistrez le budget avant d&apos;archiver des années</translation>
+    </message>
+    <message>
+        <source>Could not archive years: %1</source>
+        <translation>Impossible d&apos;archiver les années : %1</translation>
+    </message>
+    <message>
+        <source>Could not write archive: %1</source>
+        <translation>Impossible d&apos;écrire l&apos;archive : %1</translation>
+    </message>
+    <message>
+        <source>Could not export file: %1</source>
+        <translation>Impossible d&apos;exporter le fichier : %1</translation>
+    </message>
+</context>
+<context>
+    <name>FileMenu</name>
+    <message>
+        <source>Archive Closed &amp;Years...</source>
+        <translation>Archiver les &amp;années closes...</translation>
+    </message>
+    <message>
+        <source>&amp;Export Operations...</source>
+        <translation>&amp;Exporter les opérations...</translation>
+    </message>
+    <message>
+        <source>Export &amp;Budget Report...</source>
+        <translation>Exporter le rapport de &amp;budget...</translation>
+    </message>
+    <message>
+        <source>Export for &amp;Analysis...</source>
+        <translation>Exporter pour l&apos;&amp;analyse...</translation>
+    </message>
 </context>
 <context>
     <name>ImportDialog</name>
@@ -428,6 +522,18 @@ Importez et gérez vos données bancaires.</translation>
         <source>Update Check Failed</source>
         <translation>Échec de la vérification des mises à jour</translation>
     </message>
+    <message>
+        <source>Export Operations</source>
+        <translation>Exporter les opérations</translation>
+    </message>
+    <message>
+        <source>Export Budget Report</source>
+        <translation>Exporter le rapport de budget</translation>
+    </message>
+    <message>
+        <source>Export for Analysis</source>
+        <translation>Exporter pour l&apos;analyse</translation>
+    </message>
 </context>
 <context>
     <name>MonthCategoryItem</name>
@@ -624,6 +730,10 @@ Importez et gérez vos données bancaires.</translation>
         <source>Remove category</source>
         <translation>Supprimer la catégorie</translation>
     </message>
+    <message>
+        <source>Suggested:</source>
+        <translation>Suggestions :</translation>
+    </message>
 </context>
 <context>
     <name>OperationView</name>
@@ -666,6 +776,26 @@ Importez et gérez vos données bancaires.</translation>
         <source>Check for updates on startup</source>
         <translation>Vérifier les mises à jour au démarrage</translation>
     </message>
+    <message>
+        <source>Saving:</source>
+        <translation>Enregistrement :</translation>
+    </message>
+    <message>
+        <source>Save automatically after each change</source>
+        <translation>Enregistrer automatiquement après chaque modification</translation>
+    </message>
+    <message>
+        <source>Undo:</source>
+        <translation>Annulation :</translation>
+    </message>
+    <message>
+        <source>Limit the number of undo steps</source>
+        <translation>Limiter le nombre d&apos;étapes d&apos;annulation</translation>
+    </message>
+    <message>
+        <source>Applies from the next opened file</source>
+        <translation>S&apos;applique à partir du prochain fichier ouvert</translation>
+    </message>
 </context>
 <context>
     <name>QObject</name>
@@ -813,6 +943,13 @@ Importez et gérez vos données bancaires.</translation>
         <translation>Entrez le nom du compte</translation>
     </message>
 </context>
+<context>
+    <name>RuleController</name>
+    <message>
+        <source>Reorder rules by frequency</source>
+        <translation>Réordonner les règles par fréquence</translation>
+    </message>
+</context>
 <context>
     <name>RuleEditDialog</name>
     <message>
@@ -847,6 +984,53 @@ Importez et gérez vos données bancaires.</translation>
         <source>Match specific amount</source>
         <translation>Correspondre à un montant spécifique</translation>
     </message>
+    <message>
+        <source>Label Match</source>
+        <translation>Correspondance de libellé</translation>
+    </message>
+    <message>
+        <source>Contains</source>
+        <translation>Contient</translation>
+    </message>
+    <message>
+        <source>Starts with</source>
+        <translation>Commence par</translation>
+    </message>
+    <message>
+        <source>Is exactly</source>
+        <translation>Est exactement</translation>
+    </message>
+    <message>
+        <source>Contains word</source>
+        <translation>Contient le mot</translation>
+    </message>
+    <message>
+        <source>Regular expression</source>
+        <translation>Expression régulière</translation>
+    </message>
+    <message>
+        <source>Operations with this text in their label will match</source>
+        <translation>Les opérations dont le libellé contient ce texte seront associées</translation>
+    </message>
+    <message>
+        <source>Checking operations...</source>
+        <translation>Vérification des opérations...</translation>
+    </message>
+    <message numerus="yes">
+        <source>%n operation(s) would change category, %1 of them uncategorized.</source>
+        <translation>
+            <numerusform>%n opération changerait de catégorie, dont %1 non catégorisée.</numerusform>
+            <numerusform>%n opérations changeraient de catégorie, dont %1 non catégorisées.</numerusform>
+        </translation>
+    </message>
+    <message>
+        <source>%1 → %2</source>
+        <translation>%1 → %2</translation>
+    </message>
+    <message>
+        <source>None</source>
+        <translation>Aucune</translation>
+    </message>
 </context>
 <context>
     <name>RulesView</name>
@@ -900,6 +1084,101 @@ Cliquez sur « Ajouter une règle... » pour en créer une.</translation>
         <source>%1 rule(s)</source>
         <translation>%1 règle(s)</translation>
     </message>
+    <message>
+        <source>Contains: &quot;%1&quot;</source>
+        <translation>Contient : « %1 »</translation>
+    </message>
+    <message>
+        <source>Starts with: &quot;%1&quot;</source>
+        <translation>Commence par : « %1 »</translation>
+    </message>
+    <message>
+        <source>Is exactly: &quot;%1&quot;</source>
+        <translation>Est exactement : « %1 »</translation>
+    </message>
+    <message>
+        <source>Contains word: &quot;%1&quot;</source>
+        <translation>Contient le mot : « %1 »</translation>
+    </message>
+    <message>
+        <source>Matches: /%1/</source>
+        <translation>Correspond à : /%1/</translation>
+    </message>
+    <message>
+        <source>Matched %1 of %2 tested operation(s), last on %3</source>
+        <translation>Associée à %1 des %2 opération(s) testée(s), dernière le %3</translation>
+    </message>
+    <message>
+        <source>Matched none of %1 tested operation(s)</source>
+        <translation>Associée à aucune des %1 opération(s) testée(s)</translation>
+    </message>
+    <message>
+        <source>Never used: rule %1 matches everything this rule does</source>
+        <translation>Jamais utilisée : la règle %1 associe tout ce que cette règle associe</translation>
+    </message>
+    <message>
+        <source>Matching took %1 ms</source>
+        <translation>Association en %1 ms</translation>
+    </message>
+    <message>
+        <source>Sort by Use</source>
+        <translation>Trier par utilisation</translation>
+    </message>
+    <message>
+        <source>Move the most used rules first, without changing the category of any operation</source>
+        <translation>Placer les règles les plus utilisées en premier, sans changer la catégorie d&apos;aucune opération</translation>
+    </message>
+</context>
+<context>
+    <name>SqliteStorage</name>
+    <message>
+        <source>File not found: %1</source>
+        <translation>Fichier introuvable : %1</translation>
+    </message>
+    <message>
+        <source>The file was written by a newer version of Comptine</source>
+        <translation>Le fichier a été écrit par une version plus récente de Comptine</translation>
+    </message>
+</context>
+<context>
+    <name>TransferMatchDialog</name>
+    <message>
+        <source>Match Transfers</source>
+        <translation>Rapprocher les virements</translation>
+    </message>
+    <message>
+        <source>Apply</source>
+        <translation>Appliquer</translation>
+    </message>
+    <message>
+        <source>Maximum gap in days:</source>
+        <translation>Écart maximal en jours :</translation>
+    </message>
+    <message>
+        <source>The uncategorized side of each transfer receives the categories of the other side.</source>
+        <translation>Le côté non catégorisé de chaque virement reçoit les catégories de l&apos;autre côté.</translation>
+    </message>
+    <message>
+        <source>No transfer to match.</source>
+        <translation>Aucun virement à rapprocher.</translation>
+    </message>
+    <message numerus="yes">
+        <source>%n day(s)</source>
+        <translation>
+            <numerusform>%n jour</numerusform>
+            <numerusform>%n jours</numerusform>
+        </translation>
+    </message>
+</context>
+<context>
+    <name>TransferMatchModel</name>
+    <message numerus="yes">
+        <source>Match %n transfer(s)</source>
+        <translation>
+            <numerusform>Rapprocher %n virement</numerusform>
+            <numerusform>Rapprocher %n virements</numerusform>
+        </translation>
+    </message>
 </context>
 <context>
     <name>UpdateController</name>